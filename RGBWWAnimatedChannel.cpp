@@ -1,190 +1,271 @@
-/*
- * RGBWWAnimatedChannel.cpp
- *
- *  Created on: 02.04.2017
- *      Author: Robin
- */
-// clang-format off
-#include "RGBWWAnimatedChannel.h"
-
-#include "RGBWWLed.h"
-#include "RGBWWLedAnimation.h"
-#include "RGBWWLedAnimationQ.h"
-// clang-format on
-
-RGBWWAnimatedChannel::RGBWWAnimatedChannel(RGBWWLed* rgbled)
-    : _rgbled(rgbled), _animationQ(new RGBWWLedAnimationQ(RGBWW_ANIMATIONQSIZE)) {}
-
-RGBWWAnimatedChannel::~RGBWWAnimatedChannel() {
-    delete _animationQ;
-    if (_currentAnimation != NULL) {
-        delete _currentAnimation;
-    }
-}
-
-int RGBWWAnimatedChannel::getValue() const {
-    return _value;
-}
-
-void RGBWWAnimatedChannel::setValue(const AbsOrRelValue& val) {
-    _value = val.getFinalValue(_value);
-}
-
-bool RGBWWAnimatedChannel::pushAnimation(RGBWWLedAnimation* pAnim, QueuePolicy queuePolicy) {
-    // do not blink while blinking
-    if (_currentAnimation != nullptr &&
-        (queuePolicy == QueuePolicy::Single || queuePolicy == QueuePolicy::Front ||
-         queuePolicy == QueuePolicy::FrontReset) &&
-        (pAnim->getAnimType() == RGBWWLedAnimation::Type::Blink &&
-         _currentAnimation->getAnimType() == RGBWWLedAnimation::Type::Blink)) {
-        debug_w("Ignored blink commmand cause already blink running!");
-        return false;
-    }
-
-    if (queuePolicy == QueuePolicy::Single) {
-        cleanupAnimationQ();
-        cleanupCurrentAnimation();
-    }
-
-    if (queuePolicy != QueuePolicy::Back)
-        continueAnimation();
-
-    if (_animationQ->isFull())
-        return false;
-
-    switch (queuePolicy) {
-    case QueuePolicy::Back:
-    case QueuePolicy::Single:
-        _animationQ->push(pAnim);
-        break;
-    case QueuePolicy::Front:
-    case QueuePolicy::FrontReset:
-        if (_currentAnimation != nullptr) {
-            if (queuePolicy == QueuePolicy::FrontReset)
-                _currentAnimation->reset();
-            _animationQ->pushFront(_currentAnimation);
-            _currentAnimation = NULL;
-        }
-        _animationQ->pushFront(pAnim);
-        _isAnimationActive = false;
-        _cancelAnimation = false;
-        break;
-    default:
-        debug_w("RGBWWAnimatedChannel::pushAnimation: Unknown queue policy: %d\n", queuePolicy);
-    }
-
-    return true;
-}
-
-void RGBWWAnimatedChannel::notifyAnimationFinished(bool requeued) {
-    _rgbled->onAnimationFinished(_currentAnimation->getName(), requeued);
-}
-
-bool RGBWWAnimatedChannel::process() {
-    if (_isAnimationPaused) {
-        return false;
-    }
-
-    // check if we need to cancel effect
-    if (_cancelAnimation) {
-        cleanupCurrentAnimation();
-    }
-
-    // cleanup Q if we cancel all effects
-    if (_clearAnimationQueue) {
-        cleanupAnimationQ();
-    }
-
-    // Interval has passed
-    // check if we need to animate or there is any new animation
-    if (!_isAnimationActive) {
-        // check if animation otherwise return true
-        if (_animationQ->isEmpty()) {
-            return false;
-        }
-
-        _currentAnimation = _animationQ->pop();
-        _isAnimationActive = true;
-    }
-
-    const bool finished = _currentAnimation->run();
-    _value = _currentAnimation->getAnimValue();
-    if (finished) {
-        if (_currentAnimation->shouldRequeue()) {
-            notifyAnimationFinished(true);
-            requeueCurrentAnimation();
-        } else
-            cleanupCurrentAnimation();
-    }
-
-    return finished;
-}
-
-void RGBWWAnimatedChannel::pauseAnimation() {
-    _isAnimationPaused = true;
-}
-
-void RGBWWAnimatedChannel::continueAnimation() {
-    _isAnimationPaused = false;
-}
-
-bool RGBWWAnimatedChannel::isAnimationQFull() {
-    return _animationQ->isFull();
-}
-
-bool RGBWWAnimatedChannel::isAnimationActive() {
-    return _isAnimationActive;
-}
-
-void RGBWWAnimatedChannel::skipAnimation() {
-    if (_isAnimationActive) {
-        _cancelAnimation = true;
-    }
-}
-
-void RGBWWAnimatedChannel::clearAnimationQueue() {
-    _clearAnimationQueue = true;
-}
-
-void RGBWWAnimatedChannel::setAnimationSpeed(int speed) {
-    if (_currentAnimation != NULL) {
-        _currentAnimation->setSpeed(speed);
-    }
-}
-
-void RGBWWAnimatedChannel::setAnimationBrightness(int brightness) {
-    if (_currentAnimation != NULL) {
-        _currentAnimation->setBrightness(brightness);
-    }
-}
-
-void RGBWWAnimatedChannel::cleanupCurrentAnimation() {
-    if (_currentAnimation == nullptr)
-        return;
-
-    notifyAnimationFinished(false);
-
-    _isAnimationActive = false;
-    delete _currentAnimation;
-    _currentAnimation = NULL;
-    _cancelAnimation = false;
-}
-
-void RGBWWAnimatedChannel::cleanupAnimationQ() {
-    _animationQ->clear();
-    _clearAnimationQueue = false;
-}
-
-void RGBWWAnimatedChannel::requeueCurrentAnimation() {
-    if (_currentAnimation == nullptr)
-        return;
-
-    debug_d("Requeuing...\n");
-
-    _currentAnimation->reset();
-    _animationQ->push(_currentAnimation);
-
-    _currentAnimation = NULL;
-    _isAnimationActive = false;
-    _cancelAnimation = false;
-}
+/*
+ * RGBWWAnimatedChannel.cpp
+ *
+ *  Created on: 02.04.2017
+ *      Author: Robin
+ */
+// clang-format off
+#include "RGBWWAnimatedChannel.h"
+
+#include "RGBWWLed.h"
+#include "RGBWWLedAnimation.h"
+#include "RGBWWLedAnimationQ.h"
+// clang-format on
+
+RGBWWAnimatedChannel::RGBWWAnimatedChannel() : _animationQ(RGBWW_ANIMATIONQSIZE) {}
+
+RGBWWAnimatedChannel::RGBWWAnimatedChannel(RGBWWLed* rgbled) : RGBWWAnimatedChannel() {
+    init(rgbled);
+}
+
+RGBWWAnimatedChannel::~RGBWWAnimatedChannel() {
+    if (_currentAnimation != NULL) {
+        delete _currentAnimation;
+    }
+}
+
+void RGBWWAnimatedChannel::init(RGBWWLed* rgbled, RGBWWLedAnimationQ::Budget* queueBudget) {
+    _rgbled = rgbled;
+    _animationQ.setBudget(queueBudget);
+}
+
+int RGBWWAnimatedChannel::getValue() const {
+    return _value;
+}
+
+void RGBWWAnimatedChannel::setValue(const AbsOrRelValue& val) {
+    const int value = val.getFinalValue(_value);
+    _valueChanged |= (value != _value);
+    _value = value;
+}
+
+bool RGBWWAnimatedChannel::takeValueChanged() {
+    const bool changed = _valueChanged;
+    _valueChanged = false;
+    return changed;
+}
+
+bool RGBWWAnimatedChannel::pushAnimation(RGBWWLedAnimation* pAnim, QueuePolicy queuePolicy) {
+    // animation could not be allocated (i.e. animation pool exhausted)
+    if (pAnim == nullptr)
+        return false;
+
+    // apply a pending clear/skip first, otherwise it would also drop this animation
+    // when the channel is processed the next time
+    if (_clearAnimationQueue)
+        cleanupAnimationQ();
+    if (_cancelAnimation)
+        cleanupCurrentAnimation();
+
+    // do not blink while blinking
+    if (_currentAnimation != nullptr &&
+        (queuePolicy == QueuePolicy::Single || queuePolicy == QueuePolicy::Front ||
+         queuePolicy == QueuePolicy::FrontReset) &&
+        (pAnim->getAnimType() == RGBWWLedAnimation::Type::Blink &&
+         _currentAnimation->getAnimType() == RGBWWLedAnimation::Type::Blink)) {
+        debug_w("Ignored blink commmand cause already blink running!");
+        delete pAnim;
+        return false;
+    }
+
+    if (queuePolicy == QueuePolicy::Single) {
+        cleanupAnimationQ();
+        cleanupCurrentAnimation();
+    }
+
+    if (queuePolicy != QueuePolicy::Back)
+        continueAnimation();
+
+    if (_animationQ.isFull()) {
+        delete pAnim;
+        return false;
+    }
+
+    switch (queuePolicy) {
+    case QueuePolicy::Back:
+    case QueuePolicy::Single:
+        _animationQ.push(pAnim);
+        break;
+    case QueuePolicy::Front:
+    case QueuePolicy::FrontReset:
+        if (_currentAnimation != nullptr) {
+            if (queuePolicy == QueuePolicy::FrontReset)
+                _currentAnimation->reset();
+            _animationQ.pushFront(_currentAnimation);
+            _currentAnimation = NULL;
+        }
+        _isAnimationActive = false;
+        _cancelAnimation = false;
+        // the interrupted animation might have used up the last entry
+        if (!_animationQ.pushFront(pAnim)) {
+            delete pAnim;
+            return false;
+        }
+        break;
+    default:
+        debug_w("RGBWWAnimatedChannel::pushAnimation: Unknown queue policy: %d\n", queuePolicy);
+        delete pAnim;
+        return false;
+    }
+
+    return true;
+}
+
+void RGBWWAnimatedChannel::notifyAnimationFinished(bool requeued) {
+    _rgbled->onAnimationFinished(_currentAnimation->getName(), requeued);
+}
+
+bool RGBWWAnimatedChannel::process(int steps /* = 1 */) {
+    if (_isAnimationPaused) {
+        return false;
+    }
+
+    // check if we need to cancel effect
+    if (_cancelAnimation) {
+        cleanupCurrentAnimation();
+    }
+
+    // cleanup Q if we cancel all effects
+    if (_clearAnimationQueue) {
+        cleanupAnimationQ();
+    }
+
+    bool anyFinished = false;
+    while (steps > 0) {
+        // Interval has passed
+        // check if we need to animate or there is any new animation
+        if (!_isAnimationActive) {
+            // check if animation otherwise return true
+            if (_animationQ.isEmpty()) {
+                break;
+            }
+
+            _currentAnimation = _animationQ.pop();
+            _isAnimationActive = true;
+            // the controller has not shown the end value of the previous animation yet
+            _currentAnimation->overrideBaseValue(anyFinished, _value);
+        }
+
+        const bool finished = _currentAnimation->advance(steps);
+        const int value = _currentAnimation->getAnimValue();
+        _valueChanged |= (value != _value);
+        _value = value;
+        if (!finished)
+            break;
+
+        anyFinished = true;
+        if (_currentAnimation->shouldRequeue()) {
+            notifyAnimationFinished(true);
+            requeueCurrentAnimation();
+        } else
+            cleanupCurrentAnimation();
+    }
+
+    return anyFinished;
+}
+
+int RGBWWAnimatedChannel::stepsToNextChange() {
+    if (_isAnimationPaused)
+        return 0;
+
+    if (_cancelAnimation || _clearAnimationQueue)
+        return 1;
+
+    if (_isAnimationActive)
+        return _currentAnimation->stepsToNextChange();
+
+    return _animationQ.isEmpty() ? 0 : 1;
+}
+
+void RGBWWAnimatedChannel::pauseAnimation() {
+    _isAnimationPaused = true;
+}
+
+void RGBWWAnimatedChannel::continueAnimation() {
+    _isAnimationPaused = false;
+}
+
+bool RGBWWAnimatedChannel::isAnimationQFull() {
+    return _animationQ.isFull();
+}
+
+bool RGBWWAnimatedChannel::isAnimationActive() {
+    return _isAnimationActive;
+}
+
+void RGBWWAnimatedChannel::skipAnimation() {
+    if (_isAnimationActive) {
+        _cancelAnimation = true;
+    }
+}
+
+void RGBWWAnimatedChannel::clearAnimationQueue() {
+    _clearAnimationQueue = true;
+}
+
+void RGBWWAnimatedChannel::setAnimationSpeed(int speed) {
+    if (_currentAnimation != NULL) {
+        _currentAnimation->setSpeed(speed);
+    }
+}
+
+void RGBWWAnimatedChannel::setAnimationBrightness(int brightness) {
+    if (_currentAnimation != NULL) {
+        _currentAnimation->setBrightness(brightness);
+    }
+}
+
+bool RGBWWAnimatedChannel::hasRequest(uint16_t id, uint8_t cycle) {
+    if (_currentAnimation != nullptr && _currentAnimation->getRequest().id == id &&
+        _currentAnimation->getRequest().cycle == cycle)
+        return true;
+
+    for (RGBWWLedAnimation* anim = _animationQ.peek(); anim != nullptr; anim = RGBWWLedAnimationQ::next(anim)) {
+        if (anim->getRequest().id == id && anim->getRequest().cycle == cycle)
+            return true;
+    }
+    return false;
+}
+
+void RGBWWAnimatedChannel::cleanupCurrentAnimation() {
+    if (_currentAnimation == nullptr)
+        return;
+
+    notifyAnimationFinished(false);
+
+    RGBWWLedAnimation* anim = _currentAnimation;
+    _isAnimationActive = false;
+    _currentAnimation = NULL;
+    _cancelAnimation = false;
+
+    // the animation is no longer part of the channel, but keeps its name for the event
+    _rgbled->checkRequestFinished(anim->getRequest(), anim->getName(), false);
+    delete anim;
+}
+
+void RGBWWAnimatedChannel::cleanupAnimationQ() {
+    _animationQ.clear();
+    _clearAnimationQueue = false;
+}
+
+void RGBWWAnimatedChannel::requeueCurrentAnimation() {
+    if (_currentAnimation == nullptr)
+        return;
+
+    debug_d("Requeuing...\n");
+
+    RGBWWLedAnimation* anim = _currentAnimation;
+    _currentAnimation = NULL;
+    _isAnimationActive = false;
+    _cancelAnimation = false;
+
+    const RGBWWLedAnimation::Request request = anim->getRequest();
+    anim->reset();
+    anim->nextRequestCycle();
+    const bool queued = _animationQ.push(anim);
+    _rgbled->checkRequestFinished(request, anim->getName(), true);
+    if (!queued) {
+        debug_w("RGBWWAnimatedChannel::requeueCurrentAnimation: Queue full, dropping animation\n");
+        delete anim;
+    }
+}
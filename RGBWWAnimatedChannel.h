@@ -1,96 +1,181 @@
-/*
- * RGBWWAnimatedChannel.h
- *
- *  Created on: 02.04.2017
- *      Author: Robin
- */
-
-#pragma once
-
-// clang-format off
-#include "RGBWWTypes.h"
-#include "RGBWWconst.h"
-// clang-format on
-
-class RGBWWLed;
-class RGBWWLedAnimation;
-class RGBWWLedAnimationQ;
-
-class RGBWWAnimatedChannel {
-  public:
-    RGBWWAnimatedChannel(RGBWWLed* rgbled);
-    virtual ~RGBWWAnimatedChannel();
-
-    /**
-     * @retval true animation finished
-     * @retval false
-     */
-    bool process();
-
-    /**
-     * Check if an animation is currently active
-     *
-     * @retval true if an animation is currently active
-     * @retval false if no animation is active
-     */
-    bool isAnimationActive();
-
-    /**
-     * Check if the AnimationQueue is full
-     *
-     * @retval true queue is full
-     * @retval false queue is not full
-     */
-    bool isAnimationQFull();
-
-    /**
-     * skip the current animation
-     *
-     */
-    void skipAnimation();
-
-    /**
-     * Cancel all animations in the queue
-     *
-     */
-    void clearAnimationQueue();
-
-    /**
-     * Change the speed of the current running animation
-     *
-     * @param speed
-     */
-    void setAnimationSpeed(int speed);
-
-    /**
-     * Change the brightness of the current animation
-     *
-     * @param brightness
-     */
-    void setAnimationBrightness(int brightness);
-
-    int getValue() const;
-    void setValue(const AbsOrRelValue& val);
-
-    bool pushAnimation(RGBWWLedAnimation* pAnim, QueuePolicy queuePolicy);
-
-    void pauseAnimation();
-    void continueAnimation();
-
-  private:
-    RGBWWLed* _rgbled;
-    int _value = 0;
-    bool _cancelAnimation = false;
-    bool _clearAnimationQueue = false;
-    bool _isAnimationActive = false;
-    bool _isAnimationPaused = false;
-
-    RGBWWLedAnimation* _currentAnimation = nullptr;
-    RGBWWLedAnimationQ* _animationQ = nullptr;
-
-    // helpers
-    void notifyAnimationFinished(bool requeued);
-    void cleanupCurrentAnimation();
-    void cleanupAnimationQ();
-    void requeueCurrentAnimation();
-};
+/*
+ * RGBWWAnimatedChannel.h
+ *
+ *  Created on: 02.04.2017
+ *      Author: Robin
+ */
+
+#pragma once
+
+// clang-format off
+#include "RGBWWTypes.h"
+#include "RGBWWconst.h"
+#include "RGBWWLedAnimationQ.h"
+// clang-format on
+
+class RGBWWLed;
+class RGBWWLedAnimation;
+class RGBWWLedSnapshotWriter;
+class RGBWWLedSnapshotReader;
+
+class RGBWWAnimatedChannel {
+  public:
+    RGBWWAnimatedChannel();
+    RGBWWAnimatedChannel(RGBWWLed* rgbled);
+    RGBWWAnimatedChannel(const RGBWWAnimatedChannel&) = delete;
+    RGBWWAnimatedChannel& operator=(const RGBWWAnimatedChannel&) = delete;
+    virtual ~RGBWWAnimatedChannel();
+
+    /**
+     * Attach the channel to its controller. Needed when the channel
+     * was default constructed (i.e. as part of a channel bank)
+     *
+     * @param rgbled controller that is notified about finished animations
+     * @param queueBudget budget of queue entries shared with the other channels of the controller
+     */
+    void init(RGBWWLed* rgbled, RGBWWLedAnimationQ::Budget* queueBudget = nullptr);
+
+    /**
+     * @param steps steps to advance the animations (one step per RGBWW_STEPTIME).
+     *              With more than one step, finished animations pass the
+     *              remaining steps on to the next animation in the queue
+     * @retval true animation finished
+     * @retval false
+     */
+    bool process(int steps = 1);
+
+    /**
+     * Steps until the value of the channel changes next
+     *
+     * @return int steps, 0 if no animation is running or queued
+     */
+    int stepsToNextChange();
+
+    /**
+     * Check if an animation is currently active
+     *
+     * @retval true if an animation is currently active
+     * @retval false if no animation is active
+     */
+    bool isAnimationActive();
+
+    /**
+     * Check if the AnimationQueue is full
+     *
+     * @retval true queue is full
+     * @retval false queue is not full
+     */
+    bool isAnimationQFull();
+
+#ifdef RGBWW_ENABLE_PROFILING
+    /**
+     * Maximum number of queued animations, see RGBWWLedAnimationQ::getHighWater()
+     */
+    int getQueueHighWater() const {
+        return _animationQ.getHighWater();
+    }
+
+    void resetQueueHighWater() {
+        _animationQ.resetHighWater();
+    }
+#endif
+
+    /**
+     * skip the current animation
+     *
+     */
+    void skipAnimation();
+
+    /**
+     * Cancel all animations in the queue
+     *
+     */
+    void clearAnimationQueue();
+
+    /**
+     * Change the speed of the current running animation
+     *
+     * @param speed
+     */
+    void setAnimationSpeed(int speed);
+
+    /**
+     * Change the brightness of the current animation
+     *
+     * @param brightness
+     */
+    void setAnimationBrightness(int brightness);
+
+    int getValue() const;
+    void setValue(const AbsOrRelValue& val);
+
+    /**
+     * Check if the value changed since the last call and reset the flag
+     *
+     * @retval true value changed
+     * @retval false value unchanged
+     */
+    bool takeValueChanged();
+
+    /**
+     * Queue an animation. The channel takes ownership of the animation,
+     * it is deleted if it can not be queued.
+     *
+     * @retval true animation was queued
+     * @retval false animation was rejected or pAnim is nullptr
+     */
+    bool pushAnimation(RGBWWLedAnimation* pAnim, QueuePolicy queuePolicy);
+
+    void pauseAnimation();
+    void continueAnimation();
+
+    /**
+     * Running animation or nullptr
+     */
+    RGBWWLedAnimation* getCurrentAnimation() const {
+        return _isAnimationActive ? _currentAnimation : nullptr;
+    }
+
+    /**
+     * Check if the current or a queued animation belongs to the given cycle of a request
+     */
+    bool hasRequest(uint16_t id, uint8_t cycle);
+
+    /**
+     * Save the value, the state and the animations, see RGBWWLed::saveSnapshot().
+     * Animations not supporting snapshots are left out
+     */
+    void saveSnapshot(RGBWWLedSnapshotWriter& writer) const;
+
+    /**
+     * Replace the state and the animations by a snapshot of saveSnapshot(), without notifications
+     *
+     * @param ch        channel, first channel of the color mode for the joint animations
+     * @param channels  channels the joint animations are attached to, nullptr for a single channel
+     * @retval false    snapshot invalid or animations could not be allocated, the channel has no animations then
+     */
+    bool restoreSnapshot(RGBWWLedSnapshotReader& reader, CtrlChannel ch, RGBWWAnimatedChannel* channels);
+
+    /**
+     * Remove the current and all queued animations without notifications
+     */
+    void removeAnimations();
+
+  private:
+    RGBWWLed* _rgbled = nullptr;
+    int _value = 0;
+    bool _valueChanged = true;
+    bool _cancelAnimation = false;
+    bool _clearAnimationQueue = false;
+    bool _isAnimationActive = false;
+    bool _isAnimationPaused = false;
+
+    RGBWWLedAnimation* _currentAnimation = nullptr;
+    RGBWWLedAnimationQ _animationQ;
+
+    // helpers
+    void notifyAnimationFinished(bool requeued);
+    void cleanupCurrentAnimation();
+    void cleanupAnimationQ();
+    void requeueCurrentAnimation();
+};
@@ -12,8 +12,12 @@
 #include "RGBWWLedAnimation.h"
 #include "RGBWWLedAnimationQ.h"
 #include "RGBWWLedOutput.h"
+#include "RGBWWLedScene.h"
 // clang-format on
 
+// frame based mode advances a whole number of steps per show()
+static_assert(RGBWW_MINTIMEDIFF % RGBWW_STEPTIME == 0, "RGBWW_MINTIMEDIFF has to be a multiple of RGBWW_STEPTIME");
+
 /**************************************************************
  *                setup, init and settings
  **************************************************************/
@@ -24,61 +28,214 @@ RGBWWLed::RGBWWLed() {
 
     _pwm_output = nullptr;
 
-    _animChannelsHsv[CtrlChannel::Hue] = new RGBWWAnimatedChannel(this);
-    _animChannelsHsv[CtrlChannel::Sat] = new RGBWWAnimatedChannel(this);
-    _animChannelsHsv[CtrlChannel::Val] = new RGBWWAnimatedChannel(this);
-    _animChannelsHsv[CtrlChannel::ColorTemp] = new RGBWWAnimatedChannel(this);
-
-    _animChannelsRaw[CtrlChannel::Red] = new RGBWWAnimatedChannel(this);
-    _animChannelsRaw[CtrlChannel::Green] = new RGBWWAnimatedChannel(this);
-    _animChannelsRaw[CtrlChannel::Blue] = new RGBWWAnimatedChannel(this);
-    _animChannelsRaw[CtrlChannel::WarmWhite] = new RGBWWAnimatedChannel(this);
-    _animChannelsRaw[CtrlChannel::ColdWhite] = new RGBWWAnimatedChannel(this);
+    for (RGBWWAnimatedChannel& ch : _animChannels) {
+        ch.init(this, &_animQueueBudget);
+    }
+    for (RGBWWAnimatedChannel& ch : _jointChannels) {
+        ch.init(this, &_animQueueBudget);
+    }
 }
 
 RGBWWLed::~RGBWWLed() {
+    freeDutyTables();
     delete _pwm_output;
     _pwm_output = nullptr;
 }
 
 void RGBWWLed::init(int redPIN, int greenPIN, int bluePIN, int wwPIN, int cwPIN, int pwmFrequency /* =200 */) {
     _pwm_output = new PWMOutput(redPIN, greenPIN, bluePIN, wwPIN, cwPIN, pwmFrequency);
+    _outputInvalid = true;
+    _dutyLutValid = false;
+
+    if (!RGBWWLedAnimation::getPool().isInitialized())
+        RGBWWLedAnimation::initPool(RGBWW_ANIMATIONPOOLSIZE, RGBWW_ANIMATIONPOOLLARGE);
+}
+
+void RGBWWLed::setPwmFrequency(int pwmFrequency) {
+    if (_pwm_output == NULL)
+        return;
+
+    _pwm_output->setFrequency(pwmFrequency);
+    _outputInvalid = true;
+    _dutyLutValid = false;
+}
+
+const AnimationPoolStats& RGBWWLed::getAnimationPoolStats() {
+    return RGBWWLedAnimation::getPool().getStats();
+}
+
+const RGBWWLedAnimationNames& RGBWWLed::getAnimationNames() {
+    return RGBWWLedAnimation::getNames();
 }
 
 void RGBWWLed::getAnimChannelHsvColor(HSVCT& c) {
-    c.hue = _animChannelsHsv[CtrlChannel::Hue]->getValue();
-    c.sat = _animChannelsHsv[CtrlChannel::Sat]->getValue();
-    c.val = _animChannelsHsv[CtrlChannel::Val]->getValue();
-    c.ct = _animChannelsHsv[CtrlChannel::ColorTemp]->getValue();
+    c.hue = getAnimChannel(CtrlChannel::Hue).getValue();
+    c.sat = getAnimChannel(CtrlChannel::Sat).getValue();
+    c.val = getAnimChannel(CtrlChannel::Val).getValue();
+    c.ct = getAnimChannel(CtrlChannel::ColorTemp).getValue();
 }
 
 void RGBWWLed::getAnimChannelRawOutput(ChannelOutput& o) {
-    o.r = _animChannelsRaw[CtrlChannel::Red]->getValue();
-    o.g = _animChannelsRaw[CtrlChannel::Green]->getValue();
-    o.b = _animChannelsRaw[CtrlChannel::Blue]->getValue();
-    o.ww = _animChannelsRaw[CtrlChannel::WarmWhite]->getValue();
-    o.cw = _animChannelsRaw[CtrlChannel::ColdWhite]->getValue();
+    o.r = getAnimChannel(CtrlChannel::Red).getValue();
+    o.g = getAnimChannel(CtrlChannel::Green).getValue();
+    o.b = getAnimChannel(CtrlChannel::Blue).getValue();
+    o.ww = getAnimChannel(CtrlChannel::WarmWhite).getValue();
+    o.cw = getAnimChannel(CtrlChannel::ColdWhite).getValue();
 }
 
 /**************************************************************
  *                     OUTPUT
  **************************************************************/
 
-bool RGBWWLed::processChannelGroup(const ChannelGroup& cg) {
-    bool animFinished = false;
-    for (unsigned i = 0; i < cg.count(); ++i) {
-        CtrlChannel ch = cg.keyAt(i);
-        RGBWWAnimatedChannel* pCh = cg.valueAt(i);
-        animFinished |= pCh->process();
+bool RGBWWLed::processChannelGroup(const ChannelGroup& cg, int steps, bool& changed) {
+    // joint animations first, they write the channel values directly
+    bool animFinished = getJointChannel(cg.first).process(steps);
+    for (int i = static_cast<int>(cg.first); i <= static_cast<int>(cg.last); ++i) {
+        RGBWWAnimatedChannel& ch = getAnimChannel(static_cast<CtrlChannel>(i));
+        animFinished |= ch.process(steps);
+        changed |= ch.takeValueChanged();
     }
     return animFinished;
 }
 
-bool RGBWWLed::show() {
-    bool animFinished = false;
+void RGBWWLed::setTimeBased(bool enabled, Clock clock /* = nullptr */) {
+    _timeBased = enabled;
+    _clock = clock;
+    _stepTimeValid = false;
+}
+
+bool RGBWWLed::setFrameInterval(int interval) {
+    if (interval <= 0 || interval % RGBWW_STEPTIME != 0)
+        return false;
+
+    _frameSteps = interval / RGBWW_STEPTIME;
+    return true;
+}
+
+void RGBWWLed::setFrameIntervalLimits(int minInterval, int maxInterval) {
+    _minFrameInterval = max(minInterval, RGBWW_STEPTIME);
+    _maxFrameInterval = max(maxInterval, _minFrameInterval);
+}
+
+void RGBWWLed::setFrameMonitoring(bool enabled) {
+    _frameMonitoring = enabled;
+    _frameTimeValid = false;
+    _frameDeadline = 0;
+}
+
+int RGBWWLed::getJitterBucketLimit(int bucket) {
+    static const int limits[JitterBuckets - 1] = {0, 1, 2, 5, 10, 20, 50, 100, 200};
+    return (bucket >= 0 && bucket < JitterBuckets - 1) ? limits[bucket] : -1;
+}
+
+RGBWWLed::FrameResult RGBWWLed::show() {
+    if (_timeBased)
+        return show((_clock != nullptr) ? _clock() : millis());
+
+    if (!_frameMonitoring)
+        return showSteps(_frameSteps);
+
+    checkFrameTime((_clock != nullptr) ? _clock() : millis());
+    const FrameResult result = showSteps(_frameSteps);
+    setFrameDeadline(result);
+    return result;
+}
+
+RGBWWLed::FrameResult RGBWWLed::show(uint32_t now) {
+    if (_frameMonitoring)
+        checkFrameTime(now);
+
+    // the first frame takes one step
+    if (!_stepTimeValid) {
+        _stepTime = now - RGBWW_STEPTIME;
+        _stepTimeValid = true;
+    }
+
+    // the remainder below RGBWW_STEPTIME is kept for the next frame
+    const int steps = int((now - _stepTime) / RGBWW_STEPTIME);
+    _stepTime += uint32_t(steps) * RGBWW_STEPTIME;
+    const FrameResult result = showSteps(steps);
+    if (_frameMonitoring)
+        setFrameDeadline(result);
+    return result;
+}
+
+void RGBWWLed::checkFrameTime(uint32_t now) {
+    const uint32_t interval = now - _frameTime;
+    const bool checked = _frameTimeValid && _frameDeadline > 0;
+    _frameTime = now;
+    _frameTimeValid = true;
+    if (!checked)
+        return;
+
+    FrameStats& stats = _frameStats;
+    if (stats.frames == 0 || interval < stats.minInterval)
+        stats.minInterval = interval;
+    if (interval > stats.maxInterval)
+        stats.maxInterval = interval;
+    ++stats.frames;
+    stats.totalInterval += interval;
+
+    const uint32_t deadline = _frameDeadline;
+    const uint32_t lateness = (interval > deadline) ? interval - deadline : 0;
+    int bucket = 0;
+    while (bucket < JitterBuckets - 1 && lateness > uint32_t(getJitterBucketLimit(bucket)))
+        ++bucket;
+    ++stats.jitter[bucket];
+
+    if (lateness <= RGBWW_FRAMELATETOLERANCE)
+        return;
+
+    ++stats.late;
+    // frames which would have fit into the gap
+    stats.dropped += lateness / deadline;
+    stats.lastLateTime = now;
+    onFrameOverrun(now, interval, deadline);
+}
+
+void RGBWWLed::setFrameDeadline(const FrameResult& result) {
+    // idle: the application may wait for the next request before calling show() again
+    if (result.nextFrame == 0)
+        _frameDeadline = 0;
+    else if (_timeBased)
+        _frameDeadline = max(getFrameInterval(), result.nextFrame);
+    else
+        _frameDeadline = getFrameInterval();
+}
+
+int RGBWWLed::calcNextFrame(const ChannelGroup& cg) {
+    int steps = getJointChannel(cg.first).stepsToNextChange();
+    for (int i = static_cast<int>(cg.first); i <= static_cast<int>(cg.last); ++i) {
+        const int s = getAnimChannel(static_cast<CtrlChannel>(i)).stepsToNextChange();
+        if (s > 0 && (steps == 0 || s < steps))
+            steps = s;
+    }
+
+    if (steps == 0) {
+        // idle: the next animation starts with one step, no matter how long ago the last frame was
+        _stepTimeValid = false;
+        return 0;
+    }
+
+    return constrain(steps * RGBWW_STEPTIME, _minFrameInterval, _maxFrameInterval);
+}
+
+RGBWWLed::FrameResult RGBWWLed::showSteps(int steps) {
+    RGBWW_PROFILE_BEGIN();
+    FrameResult result;
+
+    // anything invalidating the last output independent of the channel values
+    bool dirty = _outputInvalid || _mode != _shownMode || colorutils.getRevision() != _shownRevision;
+
     switch (_mode) {
     case ColorMode::Hsv: {
-        animFinished |= processChannelGroup(_animChannelsHsv);
+        result.animFinished = processChannelGroup(_animChannelsHsv, steps, dirty);
+        result.nextFrame = calcNextFrame(_animChannelsHsv);
+        RGBWW_PROFILE_LAP(Channels);
+        if (!dirty) {
+            RGBWW_PROFILE_END();
+            return result;
+        }
 
         HSVCT c;
         getAnimChannelHsvColor(c);
@@ -87,24 +244,43 @@ bool RGBWWLed::show() {
         debug_d("NEW: h:%d, s:%d, v:%d, ct: %d", c.h, c.s, c.v, c.ct);
 #endif
 
-        this->setOutput(c);
-
+        _current_color = c;
+        RGBWCT rgbwk;
+        colorutils.HSVtoRGB(c, rgbwk);
+        RGBWW_PROFILE_LAP(HsvToRgb);
+        ChannelOutput o;
+        colorutils.whiteBalance(rgbwk, o);
+        RGBWW_PROFILE_LAP(WhiteBalance);
+        result.outputChanged = applyOutput(o, _outputInvalid);
         break;
     }
     case ColorMode::Raw: {
-        animFinished |= processChannelGroup(_animChannelsRaw);
+        result.animFinished = processChannelGroup(_animChannelsRaw, steps, dirty);
+        result.nextFrame = calcNextFrame(_animChannelsRaw);
+        RGBWW_PROFILE_LAP(Channels);
+        if (!dirty) {
+            RGBWW_PROFILE_END();
+            return result;
+        }
 
         ChannelOutput o;
         getAnimChannelRawOutput(o);
+        RGBWW_PROFILE_LAP(WhiteBalance);
 
         debug_d("NEWRAW: r:%d, g:%d, b:%d, cw: %d, ww: %d", o.r, o.g, o.b, o.cw, o.ww);
 
-        this->setOutput(o);
+        result.outputChanged = applyOutput(o, _outputInvalid);
         break;
     }
     }
 
-    return animFinished;
+    // init() invalidates the output again once there is a PWM output
+    _outputInvalid = false;
+    _shownMode = _mode;
+    _shownRevision = colorutils.getRevision();
+
+    RGBWW_PROFILE_END();
+    return result;
 }
 
 void RGBWWLed::refresh() {
@@ -119,6 +295,16 @@ const HSVCT& RGBWWLed::getCurrentColor() const {
     return _current_color;
 }
 
+#ifdef RGBWW_ENABLE_PROFILING
+void RGBWWLed::resetProfiling() {
+    _profiler.reset();
+    for (RGBWWAnimatedChannel& ch : _animChannels)
+        ch.resetQueueHighWater();
+    for (RGBWWAnimatedChannel& ch : _jointChannels)
+        ch.resetQueueHighWater();
+}
+#endif
+
 void RGBWWLed::setOutput(HSVCT& outputcolor) {
     RGBWCT rgbwk;
     _current_color = outputcolor;
@@ -133,18 +319,110 @@ void RGBWWLed::setOutput(RGBWCT& outputcolor) {
 }
 
 void RGBWWLed::setOutput(ChannelOutput& output) {
-    if (_pwm_output != NULL) {
+    applyOutput(output, true);
+    // output no longer reflects the channels, the next show() has to write it again
+    _outputInvalid = true;
+};
+
+bool RGBWWLed::applyOutput(ChannelOutput& output, bool force) {
+    // without PWM output (i.e. offline rendering) the output is calculated only
+    if (_pwm_output == NULL) {
         colorutils.correctBrightness(output);
+        RGBWW_PROFILE_LAP(Brightness);
+        const bool changed = !(output == _current_output);
         _current_output = output;
+        return changed;
+    }
+
+    // the duties change with the tables even if the channel values do not
+    if (updateDutyTables())
+        force = true;
+
+    const ChannelOutput calculated = output;
+    colorutils.correctBrightness(output);
+    RGBWW_PROFILE_LAP(Brightness);
+    if (!force && output == _current_output)
+        return false;
+
+    _current_output = output;
 #ifdef RGBWW_DEBUG
-        debug_d("R:%i | G:%i | B:%i | WW:%i | CW:%i", output.r, output.g, output.b, output.ww, output.cw);
+    debug_d("R:%i | G:%i | B:%i | WW:%i | CW:%i", output.r, output.g, output.b, output.ww, output.cw);
 #endif
+    if (_dutyLut[RGBWW_CHANNELS::RED] != nullptr) {
+        _pwm_output->setOutputDuty(_dutyLut[RGBWW_CHANNELS::RED][calculated.r],
+                                   _dutyLut[RGBWW_CHANNELS::GREEN][calculated.g],
+                                   _dutyLut[RGBWW_CHANNELS::BLUE][calculated.b],
+                                   _dutyLut[RGBWW_CHANNELS::WW][calculated.ww],
+                                   _dutyLut[RGBWW_CHANNELS::CW][calculated.cw]);
+    } else {
         _pwm_output->setOutput(RGBWW_dim_curve[output.r], RGBWW_dim_curve[output.g], RGBWW_dim_curve[output.b],
                                RGBWW_dim_curve[output.ww], RGBWW_dim_curve[output.cw]);
     }
-};
+    RGBWW_PROFILE_LAP(Output);
+    return true;
+}
+
+bool RGBWWLed::updateDutyTables() {
+    if (_dutyLutValid && _dutyLutRevision == colorutils.getRevision())
+        return false;
+
+    _dutyLutRevision = colorutils.getRevision();
+
+    // only the brightness correction of the color settings goes into the tables
+    int brightness[RGBWW_CHANNELS::NUM_CHANNELS];
+    colorutils.getBrightnessCorrection(brightness[RGBWW_CHANNELS::RED], brightness[RGBWW_CHANNELS::GREEN],
+                                       brightness[RGBWW_CHANNELS::BLUE], brightness[RGBWW_CHANNELS::WW],
+                                       brightness[RGBWW_CHANNELS::CW]);
+    if (_dutyLutValid && memcmp(brightness, _dutyLutBrightness, sizeof(brightness)) == 0)
+        return false;
+
+    memcpy(_dutyLutBrightness, brightness, sizeof(brightness));
+    _dutyLutValid = true;
+    freeDutyTables();
+
+    for (int ch = 0; ch < RGBWW_CHANNELS::NUM_CHANNELS; ++ch) {
+        for (int other = 0; other < ch; ++other) {
+            if (brightness[other] == brightness[ch]) {
+                _dutyLut[ch] = _dutyLut[other];
+                break;
+            }
+        }
+        if (_dutyLut[ch] != nullptr)
+            continue;
+
+        _dutyLutOwned[ch] = new uint32_t[RGBWW_CALC_MAXVAL + 1];
+        if (_dutyLutOwned[ch] == nullptr) {
+            debug_w("RGBWWLed::updateDutyTables: out of memory, using the dim curve directly\n");
+            freeDutyTables();
+            return true;
+        }
+        _dutyLut[ch] = _dutyLutOwned[ch];
+    }
+
+    for (int value = 0; value <= RGBWW_CALC_MAXVAL; ++value) {
+        ChannelOutput corrected(value, value, value, value, value);
+        colorutils.correctBrightness(corrected);
+        const int correctedValues[RGBWW_CHANNELS::NUM_CHANNELS] = {corrected.r, corrected.g, corrected.b,
+                                                                   corrected.ww, corrected.cw};
+        for (int ch = 0; ch < RGBWW_CHANNELS::NUM_CHANNELS; ++ch) {
+            if (_dutyLutOwned[ch] != nullptr)
+                _dutyLutOwned[ch][value] = _pwm_output->scaleDuty(RGBWW_dim_curve[correctedValues[ch]]);
+        }
+    }
+
+    return true;
+}
+
+void RGBWWLed::freeDutyTables() {
+    for (int ch = 0; ch < RGBWW_CHANNELS::NUM_CHANNELS; ++ch) {
+        delete[] _dutyLutOwned[ch];
+        _dutyLutOwned[ch] = nullptr;
+        _dutyLut[ch] = nullptr;
+    }
+}
 
 void RGBWWLed::setOutputRaw(int& red, int& green, int& blue, int& wwhite, int& cwhite) {
+    _outputInvalid = true;
     if (_pwm_output != NULL) {
         _current_output = ChannelOutput(red, green, blue, wwhite, cwhite);
         _pwm_output->setOutput(red, green, blue, wwhite, cwhite);
@@ -155,34 +433,46 @@ void RGBWWLed::setOutputRaw(int& red, int& green, int& blue, int& wwhite, int& c
  *                 ANIMATION/TRANSITION
  **************************************************************/
 
-void RGBWWLed::blink(const ChannelList& channels, int time, QueuePolicy queuePolicy, bool requeue, const String& name) {
-    if (_mode == ColorMode::Hsv) {
-        if (channels.size() == 0 || channels.contains(CtrlChannel::Val))
-            _animChannelsHsv[CtrlChannel::Val]->pushAnimation(
-                new AnimBlink(this, time, CtrlChannel::Val, requeue, name), queuePolicy);
-        if (channels.contains(CtrlChannel::Sat))
-            _animChannelsHsv[CtrlChannel::Sat]->pushAnimation(
-                new AnimBlink(this, time, CtrlChannel::Sat, requeue, name), queuePolicy);
-        if (channels.contains(CtrlChannel::Hue))
-            _animChannelsHsv[CtrlChannel::Hue]->pushAnimation(
-                new AnimBlink(this, time, CtrlChannel::Hue, requeue, name), queuePolicy);
-    } else {
-        if (channels.size() == 0 || channels.contains(CtrlChannel::WarmWhite))
-            _animChannelsHsv[CtrlChannel::WarmWhite]->pushAnimation(
-                new AnimBlink(this, time, CtrlChannel::WarmWhite, requeue, name), queuePolicy);
-        if (channels.size() == 0 || channels.contains(CtrlChannel::ColdWhite))
-            _animChannelsHsv[CtrlChannel::ColdWhite]->pushAnimation(
-                new AnimBlink(this, time, CtrlChannel::ColdWhite, requeue, name), queuePolicy);
-        if (channels.contains(CtrlChannel::Red))
-            _animChannelsHsv[CtrlChannel::Red]->pushAnimation(
-                new AnimBlink(this, time, CtrlChannel::Red, requeue, name), queuePolicy);
-        if (channels.contains(CtrlChannel::Green))
-            _animChannelsHsv[CtrlChannel::Green]->pushAnimation(
-                new AnimBlink(this, time, CtrlChannel::Green, requeue, name), queuePolicy);
-        if (channels.contains(CtrlChannel::Blue))
-            _animChannelsHsv[CtrlChannel::Blue]->pushAnimation(
-                new AnimBlink(this, time, CtrlChannel::Blue, requeue, name), queuePolicy);
+bool RGBWWLed::parseChannelList(const char* str, int length, ChannelList& channels) {
+    uint16_t mask;
+    if (!parseCtrlChannels(str, length, mask))
+        return false;
+
+    for (int i = static_cast<int>(CtrlChannel::Hue); i <= static_cast<int>(CtrlChannel::WarmWhite); ++i) {
+        const CtrlChannel ch = static_cast<CtrlChannel>(i);
+        if ((mask & ctrlChannelBit(ch)) && !channels.contains(ch))
+            channels.add(ch);
     }
+    return true;
+}
+
+bool RGBWWLed::blink(const ChannelList& channels, int time, QueuePolicy queuePolicy, bool requeue, const String& name) {
+    if (!getAnimationNames().isAvailable(name))
+        return false;
+
+    // channels blinking by default if no channel is given
+    static const CtrlChannel hsvChannels[] = {CtrlChannel::Val, CtrlChannel::Sat, CtrlChannel::Hue};
+    static const CtrlChannel rawChannels[] = {CtrlChannel::WarmWhite, CtrlChannel::ColdWhite, CtrlChannel::Red,
+                                              CtrlChannel::Green, CtrlChannel::Blue};
+    const bool hsv = (_mode == ColorMode::Hsv);
+    const CtrlChannel* candidates = hsv ? hsvChannels : rawChannels;
+    const int count = hsv ? 3 : 5;
+    const int defaults = hsv ? 1 : 2;
+
+    uint16_t mask = 0;
+    for (int i = 0; i < count; ++i) {
+        if ((channels.size() == 0 && i < defaults) || channels.contains(candidates[i]))
+            mask |= ctrlChannelBit(candidates[i]);
+    }
+
+    beginRequest(mask);
+    bool result = true;
+    for (int i = 0; i < count; ++i) {
+        if (mask & ctrlChannelBit(candidates[i]))
+            result &=
+                dispatchAnimation(new AnimBlink(this, time, candidates[i], requeue, name), candidates[i], queuePolicy);
+    }
+    return result;
 }
 
 //// fadeHSV ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -194,12 +484,16 @@ bool RGBWWLed::fadeHSV(const RequestHSVCT& color, const RampTimeOrSpeed& ramp, i
 
 bool RGBWWLed::fadeHSV(const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay, QueuePolicy queuePolicy,
                        bool requeue, const String& name) {
-    return fadeHSV(color, ramp, stay, queuePolicy, requeue, name);
+    return fadeHSV(color, ramp, stay, HueTransitionDirection::dir_short, queuePolicy, requeue, name);
 }
 
 bool RGBWWLed::fadeHSV(const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay,
                        HueTransitionDirection direction, QueuePolicy queuePolicy, bool requeue, const String& name) {
+    if (!getAnimationNames().isAvailable(name))
+        return false;
+
     _mode = ColorMode::Hsv;
+    beginRequest(getRequestChannels(color));
 
     bool result = true;
     result &=
@@ -213,7 +507,11 @@ bool RGBWWLed::fadeHSV(const RequestHSVCT& color, const RampTimeOrSpeed& ramp, i
 
 bool RGBWWLed::fadeHSV(const RequestHSVCT& colorFrom, const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay,
                        HueTransitionDirection direction, QueuePolicy queuePolicy, bool requeue, const String& name) {
+    if (!getAnimationNames().isAvailable(name))
+        return false;
+
     _mode = ColorMode::Hsv;
+    beginRequest(getRequestChannels(color));
 
     bool result = true;
 
@@ -231,7 +529,11 @@ bool RGBWWLed::fadeHSV(const RequestHSVCT& colorFrom, const RequestHSVCT& color,
 
 bool RGBWWLed::fadeRAW(const RequestChannelOutput& output, const RampTimeOrSpeed& ramp, int stay,
                        QueuePolicy queuePolicy, bool requeue, const String& name) {
+    if (!getAnimationNames().isAvailable(name))
+        return false;
+
     _mode = ColorMode::Raw;
+    beginRequest(getRequestChannels(output));
 
     bool result = true;
     result &= pushAnimTransition(output.r, ramp, stay, queuePolicy, CtrlChannel::Red, requeue, name);
@@ -246,7 +548,11 @@ bool RGBWWLed::fadeRAW(const RequestChannelOutput& output, const RampTimeOrSpeed
 bool RGBWWLed::fadeRAW(const RequestChannelOutput& output_from, const RequestChannelOutput& output,
                        const RampTimeOrSpeed& ramp, int stay, QueuePolicy queuePolicy, bool requeue,
                        const String& name) {
+    if (!getAnimationNames().isAvailable(name))
+        return false;
+
     _mode = ColorMode::Raw;
+    beginRequest(getRequestChannels(output));
 
     bool result = true;
     result &= pushAnimTransition(output_from.r, output.r, ramp, stay, queuePolicy, CtrlChannel::Red, requeue, name);
@@ -260,37 +566,78 @@ bool RGBWWLed::fadeRAW(const RequestChannelOutput& output_from, const RequestCha
     return result;
 }
 
+//// joint fades //////////////////////////////////////////////////////////////////////////////////////////////
+
+bool RGBWWLed::fadeHSVJoint(const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay,
+                            HueTransitionDirection direction, QueuePolicy queuePolicy, bool requeue,
+                            const String& name) {
+    if (!getAnimationNames().isAvailable(name))
+        return false;
+
+    return pushJointAnimation(new AnimJointTransition(this, color, ramp, stay, direction, requeue, name), queuePolicy);
+}
+
+bool RGBWWLed::fadeHSVJoint(const RequestHSVCT& colorFrom, const RequestHSVCT& color, const RampTimeOrSpeed& ramp,
+                            int stay, HueTransitionDirection direction, QueuePolicy queuePolicy, bool requeue,
+                            const String& name) {
+    if (!getAnimationNames().isAvailable(name))
+        return false;
+
+    return pushJointAnimation(new AnimJointTransition(this, colorFrom, color, ramp, stay, direction, requeue, name),
+                              queuePolicy);
+}
+
+bool RGBWWLed::fadeRAWJoint(const RequestChannelOutput& output, const RampTimeOrSpeed& ramp, int stay,
+                            QueuePolicy queuePolicy, bool requeue, const String& name) {
+    if (!getAnimationNames().isAvailable(name))
+        return false;
+
+    return pushJointAnimation(new AnimJointTransition(this, output, ramp, stay, requeue, name), queuePolicy);
+}
+
+bool RGBWWLed::fadeRAWJoint(const RequestChannelOutput& output_from, const RequestChannelOutput& output,
+                            const RampTimeOrSpeed& ramp, int stay, QueuePolicy queuePolicy, bool requeue,
+                            const String& name) {
+    if (!getAnimationNames().isAvailable(name))
+        return false;
+
+    return pushJointAnimation(new AnimJointTransition(this, output_from, output, ramp, stay, requeue, name),
+                              queuePolicy);
+}
+
 void RGBWWLed::colorDirectHSV(const RequestHSVCT& output) {
     if (output.h.hasValue()) {
-        _animChannelsHsv[CtrlChannel::Hue]->setValue(output.h.getValue());
+        getAnimChannel(CtrlChannel::Hue).setValue(output.h.getValue());
     }
     if (output.s.hasValue()) {
-        _animChannelsHsv[CtrlChannel::Sat]->setValue(output.s.getValue());
+        getAnimChannel(CtrlChannel::Sat).setValue(output.s.getValue());
     }
     if (output.v.hasValue()) {
-        _animChannelsHsv[CtrlChannel::Val]->setValue(output.v.getValue());
+        getAnimChannel(CtrlChannel::Val).setValue(output.v.getValue());
     }
     if (output.ct.hasValue()) {
-        _animChannelsHsv[CtrlChannel::ColorTemp]->setValue(output.ct.getValue());
+        getAnimChannel(CtrlChannel::ColorTemp).setValue(output.ct.getValue());
     }
+    ++_stateRevision;
 }
 
 void RGBWWLed::colorDirectRAW(const RequestChannelOutput& output) {
     if (output.r.hasValue()) {
-        _animChannelsHsv[CtrlChannel::Red]->setValue(output.r.getValue());
+        getAnimChannel(CtrlChannel::Red).setValue(output.r.getValue());
     }
     if (output.g.hasValue()) {
-        _animChannelsHsv[CtrlChannel::Green]->setValue(output.g.getValue());
+        getAnimChannel(CtrlChannel::Green).setValue(output.g.getValue());
     }
     if (output.b.hasValue()) {
-        _animChannelsHsv[CtrlChannel::Blue]->setValue(output.b.getValue());
+        getAnimChannel(CtrlChannel::Blue).setValue(output.b.getValue());
     }
     if (output.ww.hasValue()) {
-        _animChannelsHsv[CtrlChannel::WarmWhite]->setValue(output.ww.getValue());
+        getAnimChannel(CtrlChannel::WarmWhite).setValue(output.ww.getValue());
     }
     if (output.cw.hasValue()) {
-        _animChannelsHsv[CtrlChannel::ColdWhite]->setValue(output.cw.getValue());
+        getAnimChannel(CtrlChannel::ColdWhite).setValue(output.cw.getValue());
     }
+    ++_stateRevision;
 }
 
 bool RGBWWLed::pushAnimTransition(const AbsOrRelValue& from, const Optional<AbsOrRelValue>& val,
@@ -334,23 +681,85 @@ bool RGBWWLed::pushAnimTransitionCircularHue(const Optional<AbsOrRelValue>& val,
 
 bool RGBWWLed::dispatchAnimation(RGBWWLedAnimation* pAnim, CtrlChannel ch, QueuePolicy queuePolicy,
                                  const ChannelList& channels) {
+    // animation could not be allocated (i.e. animation pool exhausted)
+    if (pAnim == nullptr)
+        return false;
+
     switch (ch) {
     case CtrlChannel::Hue:
     case CtrlChannel::Sat:
     case CtrlChannel::Val:
     case CtrlChannel::ColorTemp:
-        return _animChannelsHsv[ch]->pushAnimation(pAnim, queuePolicy);
     case CtrlChannel::Red:
     case CtrlChannel::Green:
     case CtrlChannel::Blue:
     case CtrlChannel::WarmWhite:
     case CtrlChannel::ColdWhite:
-        return _animChannelsRaw[ch]->pushAnimation(pAnim, queuePolicy);
+        if (queuePolicy == QueuePolicy::Single) {
+            getJointChannel(ch).clearAnimationQueue();
+            getJointChannel(ch).skipAnimation();
+        }
+        pAnim->setRequest(_request);
+        return getAnimChannel(ch).pushAnimation(pAnim, queuePolicy);
     default:
+        delete pAnim;
         return false;
     }
 }
 
+bool RGBWWLed::pushJointAnimation(AnimJoint* pAnim, QueuePolicy queuePolicy) {
+    if (pAnim == nullptr)
+        return false;
+
+    const bool hsv = (pAnim->getFirstChannel() == CtrlChannel::Hue);
+    const ChannelGroup& cg = hsv ? _animChannelsHsv : _animChannelsRaw;
+    if (pAnim->getChannelCount() != static_cast<int>(cg.last) - static_cast<int>(cg.first) + 1) {
+        delete pAnim;
+        return false;
+    }
+
+    _mode = hsv ? ColorMode::Hsv : ColorMode::Raw;
+    uint16_t mask = 0;
+    for (int i = static_cast<int>(cg.first); i <= static_cast<int>(cg.last); ++i)
+        mask |= ctrlChannelBit(static_cast<CtrlChannel>(i));
+    beginRequest(mask);
+
+    pAnim->attach(&getAnimChannel(cg.first));
+    pAnim->setRequest(_request);
+    if (queuePolicy == QueuePolicy::Single) {
+        for (int i = static_cast<int>(cg.first); i <= static_cast<int>(cg.last); ++i) {
+            RGBWWAnimatedChannel& ch = getAnimChannel(static_cast<CtrlChannel>(i));
+            ch.clearAnimationQueue();
+            ch.skipAnimation();
+        }
+    }
+    return getJointChannel(cg.first).pushAnimation(pAnim, queuePolicy);
+}
+
+bool RGBWWLed::playScene(const RGBWWLedScene& scene, QueuePolicy queuePolicy, bool requeue, const String& name) {
+    if (!getAnimationNames().isAvailable(name))
+        return false;
+
+    AnimScene* pAnim = new AnimScene(this, scene, requeue, name);
+    if (pAnim == nullptr)
+        return false;
+    if (!pAnim->isValid()) {
+        delete pAnim;
+        return false;
+    }
+    return pushJointAnimation(pAnim, queuePolicy);
+}
+
+bool RGBWWLed::triggerScene() {
+    bool triggered = false;
+    for (RGBWWAnimatedChannel& ch : _jointChannels) {
+        RGBWWLedAnimation* pAnim = ch.getCurrentAnimation();
+        if (pAnim != nullptr && pAnim->getAnimType() == RGBWWLedAnimation::Type::Scene)
+            triggered |= static_cast<AnimScene*>(pAnim)->trigger();
+    }
+    return triggered;
+}
+
 void RGBWWLed::clearAnimationQueue(const ChannelList& channels) {
     callForChannels(_animChannelsHsv, &RGBWWAnimatedChannel::clearAnimationQueue, channels);
     callForChannels(_animChannelsRaw, &RGBWWAnimatedChannel::clearAnimationQueue, channels);
@@ -373,13 +782,79 @@ void RGBWWLed::continueAnimation(const ChannelList& channels) {
 
 void RGBWWLed::callForChannels(const ChannelGroup& group, void (RGBWWAnimatedChannel::*fnc)(),
                                const ChannelList& channels) {
+    ++_stateRevision;
     const bool all = (channels.size() == 0);
 
-    for (unsigned i = 0; i < group.count(); ++i) {
-        if (!all && !channels.contains(group.keyAt(i)))
+    bool any = all;
+    for (int i = static_cast<int>(group.first); i <= static_cast<int>(group.last); ++i) {
+        const CtrlChannel ch = static_cast<CtrlChannel>(i);
+        if (!all && !channels.contains(ch))
             continue;
-        (group.valueAt(i)->*fnc)();
+        (getAnimChannel(ch).*fnc)();
+        any = true;
     }
+
+    // the joint animations are affected by any of their channels
+    if (any)
+        (getJointChannel(group.first).*fnc)();
 }
 
 void RGBWWLed::onAnimationFinished(const String& name, bool requeued) {}
+
+/**************************************************************
+ *                    request events
+ **************************************************************/
+
+void RGBWWLed::beginRequest(uint16_t channels) {
+    // 0 marks animations without request
+    if (++_request.id == 0)
+        _request.id = 1;
+    _request.channels = channels;
+    ++_stateRevision;
+}
+
+uint16_t RGBWWLed::getRequestChannels(const RequestHSVCT& color) {
+    uint16_t mask = 0;
+    if (color.h.hasValue())
+        mask |= ctrlChannelBit(CtrlChannel::Hue);
+    if (color.s.hasValue())
+        mask |= ctrlChannelBit(CtrlChannel::Sat);
+    if (color.v.hasValue())
+        mask |= ctrlChannelBit(CtrlChannel::Val);
+    if (color.ct.hasValue())
+        mask |= ctrlChannelBit(CtrlChannel::ColorTemp);
+    return mask;
+}
+
+uint16_t RGBWWLed::getRequestChannels(const RequestChannelOutput& output) {
+    uint16_t mask = 0;
+    if (output.r.hasValue())
+        mask |= ctrlChannelBit(CtrlChannel::Red);
+    if (output.g.hasValue())
+        mask |= ctrlChannelBit(CtrlChannel::Green);
+    if (output.b.hasValue())
+        mask |= ctrlChannelBit(CtrlChannel::Blue);
+    if (output.cw.hasValue())
+        mask |= ctrlChannelBit(CtrlChannel::ColdWhite);
+    if (output.ww.hasValue())
+        mask |= ctrlChannelBit(CtrlChannel::WarmWhite);
+    return mask;
+}
+
+void RGBWWLed::checkRequestFinished(const RGBWWLedAnimation::Request& request, const String& name, bool requeued) {
+    if (request.id == 0)
+        return;
+
+    for (RGBWWAnimatedChannel& ch : _animChannels) {
+        if (ch.hasRequest(request.id, request.cycle))
+            return;
+    }
+    for (RGBWWAnimatedChannel& ch : _jointChannels) {
+        if (ch.hasRequest(request.id, request.cycle))
+            return;
+    }
+    // a requeued call continues like saved before
+    if (!requeued)
+        ++_stateRevision;
+    onRequestFinished(request.id, request.channels, name, requeued);
+}
@@ -40,9 +40,11 @@
 #include "RGBWWTypes.h"
 
 #include "RGBWWconst.h"
+#include "RGBWWAnimatedChannel.h"
 #include "RGBWWLedColor.h"
 #include "RGBWWLedAnimation.h"
 #include "RGBWWLedOutput.h"
+#include "RGBWWLedProfiler.h"
 #include "RGBWWTypes.h"
 // clang-format on
 
@@ -51,6 +53,7 @@ class RGBWWLedAnimationQ;
 class RGBWWColorUtils;
 class PWMOutput;
 class RGBWWAnimatedChannel;
+class RGBWWLedScene;
 
 /**
  *
@@ -63,10 +66,54 @@ class RGBWWLed {
     };
 
     RGBWWLed();
-    ~RGBWWLed();
+    virtual ~RGBWWLed();
 
     typedef Vector<CtrlChannel> ChannelList;
 
+    /**
+     * Parse a set of channel names like "h,s,v" for blink(), pauseAnimation(), skipAnimation() etc.,
+     * see parseCtrlChannels(). The channels are added in the order of CtrlChannel, each once
+     *
+     * @retval false unknown channel name, channels is unchanged
+     */
+    static bool parseChannelList(const char* str, int length, ChannelList& channels);
+
+    /**
+     * Clock for time based animation, returns milliseconds (i.e. millis())
+     */
+    typedef uint32_t (*Clock)();
+
+    /**
+     * Result of one call of show()
+     * Converts to bool (animFinished) for compatibility with the former interface
+     */
+    struct FrameResult {
+        bool animFinished = false;  // at least one animation finished during this frame
+        bool outputChanged = false; // new values were written to the PWM output
+        int nextFrame = 0;          // suggested ms until the next show(), 0 if no animation is running
+
+        operator bool() const {
+            return animFinished;
+        }
+    };
+
+    // buckets of FrameStats::jitter, see getJitterBucketLimit()
+    static const int JitterBuckets = 10;
+
+    /**
+     * Timing of the calls of show(), see setFrameMonitoring()
+     */
+    struct FrameStats {
+        uint32_t frames = 0;         // frames with a deadline, frames after an idle frame are not counted
+        uint32_t late = 0;           // frames more than RGBWW_FRAMELATETOLERANCE ms after their deadline
+        uint32_t dropped = 0;        // whole frame intervals which passed without a frame
+        uint32_t minInterval = 0;    // ms between two frames
+        uint32_t maxInterval = 0;    // ms between two frames
+        uint64_t totalInterval = 0;  // sum of the intervals, for the mean
+        uint32_t lastLateTime = 0;   // time of the last late frame
+        uint32_t jitter[JitterBuckets] = {}; // frames by ms after their deadline, early frames count as 0
+    };
+
     /**
      * Initialize the the LED Controller
      *
@@ -79,15 +126,124 @@ class RGBWWLed {
      */
     void init(int redPIN, int greenPIN, int bluePIN, int wwPIN, int cwPIN, int pwmFrequency = 200);
 
+    /**
+     * Change the PWM frequency after init(). The output is written again with the next show()
+     *
+     * @param pwmFrequency frequency in Hz
+     */
+    void setPwmFrequency(int pwmFrequency);
+
+    /**
+     * Statistics of the animation pool shared by all controllers.
+     * The pool is allocated by the first call of init() with
+     * RGBWW_ANIMATIONPOOLSIZE small and RGBWW_ANIMATIONPOOLLARGE large slots,
+     * the small ones hold the queue budget of one controller. Call RGBWWLedAnimation::initPool()
+     * before init() for a different size. Animations which do not fit into
+     * the pool anymore are allocated from the heap and counted in heap.
+     *
+     * @return AnimationPoolStats
+     */
+    static const AnimationPoolStats& getAnimationPoolStats();
+
+    /**
+     * Names of the animations shared by all controllers. Animations store the id of their
+     * name, use getName() and find() to convert between the name and the id
+     *
+     * @return RGBWWLedAnimationNames
+     */
+    static const RGBWWLedAnimationNames& getAnimationNames();
+
     /**
      * Main function for processing animations/color output
      * Use this in your loop()
      *
+     * The color conversion and the PWM update are skipped if neither
+     * a channel value nor a setting of colorutils changed since the last frame.
      *
-     * @retval true 	not updating
-     * @retval false 	updates applied
+     * In time based mode (see setTimeBased()) the animations advance by the
+     * time passed since the last call, otherwise by the frame interval.
+     *
+     * @return FrameResult
+     */
+    FrameResult show();
+
+    /**
+     * Like show(), but the animations advance by the time passed since the last call
+     * of show(now) (one step per full RGBWW_STEPTIME). A late frame jumps
+     * animations to their position at that time instead of lagging behind.
+     * After a frame without running or queued animations the next frame takes one step
+     *
+     * @param now current time in ms
+     * @return FrameResult
      */
-    bool show();
+    FrameResult show(uint32_t now);
+
+    /**
+     * Select time based animation for show(). Fades and blinks then take their
+     * nominal time, no matter how regularly show() is called
+     *
+     * @param enabled true for time based, false for one step per show() (default)
+     * @param clock   time source in ms, millis() if nullptr
+     */
+    void setTimeBased(bool enabled, Clock clock = nullptr);
+
+    bool isTimeBased() const {
+        return _timeBased;
+    }
+
+    /**
+     * Time between two calls of show() when not time based. Every show() advances the
+     * animations by this time, so it has to be a multiple of RGBWW_STEPTIME
+     *
+     * @param interval  ms (default RGBWW_MINTIMEDIFF)
+     * @retval false    not a positive multiple of RGBWW_STEPTIME, the interval is unchanged
+     */
+    bool setFrameInterval(int interval);
+
+    int getFrameInterval() const {
+        return _frameSteps * RGBWW_STEPTIME;
+    }
+
+    /**
+     * Track the intervals between the calls of show() against their deadline: the frame interval
+     * (default RGBWW_MINTIMEDIFF), in time based mode FrameResult::nextFrame if that is longer.
+     * Frames after an idle frame (FrameResult::nextFrame 0) have no deadline.
+     * Late frames are counted and reported by onFrameOverrun(), see getFrameStats()
+     *
+     * @param enabled true to track the frames (default false, no overhead)
+     */
+    void setFrameMonitoring(bool enabled);
+
+    bool isFrameMonitoring() const {
+        return _frameMonitoring;
+    }
+
+    const FrameStats& getFrameStats() const {
+        return _frameStats;
+    }
+
+    void resetFrameStats() {
+        _frameStats = FrameStats();
+    }
+
+    /**
+     * Upper limit of a bucket of FrameStats::jitter
+     *
+     * @return int ms after the deadline, -1 for the last bucket (no limit)
+     */
+    static int getJitterBucketLimit(int bucket);
+
+    /**
+     * Limits of FrameResult::nextFrame. For an adaptive frame rate use time based
+     * mode and call show() again after FrameResult::nextFrame ms: fast fades are
+     * rendered with up to 1000 / minInterval Hz, slow fades and the stay phase with
+     * fewer frames. With nextFrame 0 nothing is animated, show() is needed again
+     * after queuing an animation or changing the color
+     *
+     * @param minInterval shortest interval in ms (default RGBWW_STEPTIME)
+     * @param maxInterval longest interval in ms while animating (default RGBWW_MAXFRAMEINTERVAL)
+     */
+    void setFrameIntervalLimits(int minInterval, int maxInterval);
 
     /**
      * Refreshs the current output.
@@ -151,6 +307,10 @@ class RGBWWLed {
      * @param color 	new color
      * @param time		duration of transition in ms
      * @param direction direction of transition
+     * @param name      passed to onAnimationFinished(). Up to RGBWW_ANIMATIONNAMES names can be
+     *                  used by queued animations at the same time, see getAnimationNames()
+     * @retval false    not queued: a queue or the animation pool is full, or the name is new
+     *                  and all RGBWW_ANIMATIONNAMES names are in use
      */
     bool fadeHSV(const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay, HueTransitionDirection direction,
                  bool requeue = false, const String& name = "");
@@ -161,6 +321,7 @@ class RGBWWLed {
      * @param color 	new color
      * @param time		duration of transition in ms
      * @param queue		directly execute fade or queue it
+     * @retval false    not queued, see fadeHSV() above
      */
     bool fadeHSV(const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay,
                  QueuePolicy queuePolicy = QueuePolicy::Single, bool requeue = false, const String& name = "");
@@ -172,6 +333,7 @@ class RGBWWLed {
      * @param time		duration of transition in ms
      * @param direction direction of transition
      * @param queue		directly execute fade or queue it
+     * @retval false    not queued, see fadeHSV() above
      */
     bool fadeHSV(const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay,
                  HueTransitionDirection direction = HueTransitionDirection::dir_short,
@@ -185,6 +347,7 @@ class RGBWWLed {
      * @param time		duration of transition in ms
      * @param direction direction of transition
      * @param queue		directly execute fade or queue it
+     * @retval false    not queued, see fadeHSV() above
      */
     bool fadeHSV(const RequestHSVCT& colorFrom, const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay,
                  HueTransitionDirection direction = HueTransitionDirection::dir_short,
@@ -196,6 +359,7 @@ class RGBWWLed {
      * @param output
      * @param time
      * @param queue
+     * @retval false    not queued, see fadeHSV()
      */
     bool fadeRAW(const RequestChannelOutput& output, const RampTimeOrSpeed& ramp, int stay,
                  QueuePolicy queuePolicy = QueuePolicy::Single, bool requeue = false, const String& name = "");
@@ -207,15 +371,83 @@ class RGBWWLed {
      * @param output
      * @param time
      * @param queue
+     * @retval false    not queued, see fadeHSV()
      */
     bool fadeRAW(const RequestChannelOutput& output_from, const RequestChannelOutput& output,
                  const RampTimeOrSpeed& ramp, int stay, QueuePolicy queuePolicy = QueuePolicy::Single,
                  bool requeue = false, const String& name = "");
 
+    /**
+     * Fade all HSV channels with one joint animation (AnimJointTransition) instead of
+     * one animation per channel: one step counter, all channels arrive with the same
+     * frame and the animation finishes with one call of onAnimationFinished().
+     * The joint animations have their own queue, see pushJointAnimation()
+     *
+     * @param color     new color, channels without value keep their value
+     * @param direction direction of the hue transition
+     * @retval false    not queued, see fadeHSV()
+     */
+    bool fadeHSVJoint(const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay,
+                      HueTransitionDirection direction = HueTransitionDirection::dir_short,
+                      QueuePolicy queuePolicy = QueuePolicy::Single, bool requeue = false, const String& name = "");
+
+    /**
+     * Like fadeHSVJoint(), starting from colorFrom. Channels without start value start from their current value
+     */
+    bool fadeHSVJoint(const RequestHSVCT& colorFrom, const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay,
+                      HueTransitionDirection direction = HueTransitionDirection::dir_short,
+                      QueuePolicy queuePolicy = QueuePolicy::Single, bool requeue = false, const String& name = "");
+
+    /**
+     * Fade all raw channels with one joint animation, see fadeHSVJoint()
+     */
+    bool fadeRAWJoint(const RequestChannelOutput& output, const RampTimeOrSpeed& ramp, int stay,
+                      QueuePolicy queuePolicy = QueuePolicy::Single, bool requeue = false, const String& name = "");
+
+    bool fadeRAWJoint(const RequestChannelOutput& output_from, const RequestChannelOutput& output,
+                      const RampTimeOrSpeed& ramp, int stay, QueuePolicy queuePolicy = QueuePolicy::Single,
+                      bool requeue = false, const String& name = "");
+
+    /**
+     * Queue an animation of all channels of a color mode (i.e. AnimTimeline) and switch to its mode.
+     * The controller takes ownership of the animation, it is deleted if it can not be queued.
+     *
+     * The joint animations of a mode have their own queue and are processed before the
+     * animations of the single channels, which override them while running at the same time.
+     * QueuePolicy::Single also stops the channel animations of the mode and vice versa.
+     *
+     * @retval true animation was queued
+     * @retval false animation was rejected or pAnim is nullptr
+     */
+    bool pushJointAnimation(AnimJoint* pAnim, QueuePolicy queuePolicy = QueuePolicy::Single);
+
+    /**
+     * Queue a compiled scene as joint animation of its color mode, see RGBWWLedScene.
+     * The scene is copied and can be changed or deleted afterwards
+     *
+     * @retval true scene was queued
+     * @retval false scene is not compiled or can not be queued, see fadeHSV()
+     */
+    bool playScene(const RGBWWLedScene& scene, QueuePolicy queuePolicy = QueuePolicy::Single, bool requeue = false,
+                   const String& name = "");
+
+    /**
+     * Continue the running scenes waiting at a wait statement
+     *
+     * @retval true a scene was waiting
+     */
+    bool triggerScene();
+
     void colorDirectHSV(const RequestHSVCT& output);
     void colorDirectRAW(const RequestChannelOutput& output);
 
-    void blink(const ChannelList& channels = ChannelList(), int time = 100,
+    /**
+     * Blink the given channels, by default the brightness (HSV) or the white channels (raw)
+     *
+     * @retval false    a channel ignored the blink (i.e. already blinking), the animation pool is exhausted
+     *                  or the name is new and all RGBWW_ANIMATIONNAMES names are in use
+     */
+    bool blink(const ChannelList& channels = ChannelList(), int time = 100,
                QueuePolicy queuePolicy = QueuePolicy::Front, bool requeue = false, const String& name = "");
 
     // colorutils
@@ -229,12 +461,113 @@ class RGBWWLed {
 
     virtual void onAnimationFinished(const String& name, bool requeued);
 
+    /**
+     * Called with frame monitoring (see setFrameMonitoring()) for every late frame
+     *
+     * @param now       time of the frame
+     * @param interval  ms since the previous frame
+     * @param deadline  ms the frame was expected after the previous frame
+     */
+    virtual void onFrameOverrun(uint32_t now, uint32_t interval, uint32_t deadline) {}
+
+    /**
+     * Called once per call of fadeHSV(), fadeRAW(), blink(), pushJointAnimation() etc. when the
+     * animations of all its channels finished, were skipped or were requeued. Unlike
+     * onAnimationFinished(), which is called for every channel.
+     * Not called if the last animations of the call are removed by clearAnimationQueue()
+     *
+     * @param requestId id of the call, see getLastRequestId()
+     * @param channels  ctrlChannelBit() of every channel requested by the call
+     * @param name      name of the animations
+     * @param requeued  the animation of the channel finishing last was requeued
+     */
+    virtual void onRequestFinished(uint16_t requestId, uint16_t channels, const String& name, bool requeued) {}
+
+    /**
+     * Id of the last call queuing animations, passed to onRequestFinished()
+     */
+    uint16_t getLastRequestId() const {
+        return _request.id;
+    }
+
+    /**
+     * Incremented whenever a call changes the animations or the color (fades, blink, colorDirectHSV(),
+     * skipAnimation() etc.) and whenever a call finished without being requeued.
+     * Used to detect changes worth saving, see RGBWWLedPersistence
+     */
+    uint32_t getStateRevision() const {
+        return _stateRevision;
+    }
+
     ColorMode getMode() const {
         return _mode;
     }
 
+    /**
+     * Save the animation state into a versioned binary snapshot (see RGBWWLedSnapshot): color mode,
+     * channel values, the running animations with their progress and the queued animations.
+     * Not included are the settings of colorutils and animations of classes outside of the library.
+     * Use getSnapshotSize() or saveSnapshot(nullptr, 0) for the size of the buffer
+     *
+     * @param buffer    destination, nullptr to get the size only
+     * @param size      bytes of buffer
+     * @return size_t   size of the snapshot, 0 if it does not fit into buffer
+     */
+    size_t saveSnapshot(uint8_t* buffer, size_t size) const;
+
+    size_t getSnapshotSize() const {
+        return saveSnapshot(nullptr, 0);
+    }
+
+    /**
+     * Restore a snapshot of saveSnapshot(), i.e. after a reboot. Replaces all animations
+     * without calling onAnimationFinished(). Running animations continue with the next
+     * call of show() at the step they were saved at, in time based mode the first frame takes one step
+     *
+     * @retval true     restored
+     * @retval false    snapshot of another version or corrupted, the state is unchanged.
+     *                  Or the animations can not be allocated, all animations are removed then
+     */
+    bool restoreSnapshot(const uint8_t* data, size_t size);
+
+#ifdef RGBWW_ENABLE_PROFILING
+    /**
+     * Time spent in the stages of show() since the creation or resetProfiling()
+     */
+    const RGBWWLedProfiler& getProfiler() const {
+        return _profiler;
+    }
+
+    /**
+     * Maximum number of animations queued in a channel since the creation or resetProfiling()
+     */
+    int getQueueHighWater(CtrlChannel ch) const {
+        return _animChannels[static_cast<int>(ch) - static_cast<int>(CtrlChannel::Hue)].getQueueHighWater();
+    }
+
+    /**
+     * Maximum number of joint animations queued for a color mode (fadeHSVJoint(), timelines, scenes)
+     */
+    int getJointQueueHighWater(ColorMode mode) const {
+        return _jointChannels[static_cast<int>(mode)].getQueueHighWater();
+    }
+
+    /**
+     * Reset the timing counters and the queue high water marks to the current queue sizes
+     */
+    void resetProfiling();
+#endif
+
   private:
-    typedef HashMap<CtrlChannel, RGBWWAnimatedChannel*> ChannelGroup;
+    friend class RGBWWAnimatedChannel;
+
+    /**
+     * Consecutive range of channels in the channel bank
+     */
+    struct ChannelGroup {
+        CtrlChannel first;
+        CtrlChannel last;
+    };
 
     /**
      * Push a tranistion. A transition fades to a color, stays for a defined time and then continues with the next
@@ -257,19 +590,100 @@ class RGBWWLed {
     bool dispatchAnimation(RGBWWLedAnimation* pAnim, CtrlChannel ch, QueuePolicy queuePolicy,
                            const ChannelList& channels = ChannelList());
 
-    bool processChannelGroup(const ChannelGroup& cg);
+    /**
+     * Start a request, the following animations are tagged with it
+     *
+     * @param channels ctrlChannelBit() of the channels of the request
+     */
+    void beginRequest(uint16_t channels);
+    static uint16_t getRequestChannels(const RequestHSVCT& color);
+    static uint16_t getRequestChannels(const RequestChannelOutput& output);
+
+    /**
+     * Called by the channels whenever an animation finished or was requeued.
+     * Calls onRequestFinished() if no other animation of the request is left in this cycle
+     */
+    void checkRequestFinished(const RGBWWLedAnimation::Request& request, const String& name, bool requeued);
+
+    FrameResult showSteps(int steps);
+    void checkFrameTime(uint32_t now);
+    void setFrameDeadline(const FrameResult& result);
+    int calcNextFrame(const ChannelGroup& cg);
+    bool processChannelGroup(const ChannelGroup& cg, int steps, bool& changed);
+    bool applyOutput(ChannelOutput& output, bool force);
+    bool updateDutyTables();
+    void freeDutyTables();
     void getAnimChannelHsvColor(HSVCT& c);
     void getAnimChannelRawOutput(ChannelOutput& o);
     void callForChannels(const ChannelGroup& group, void (RGBWWAnimatedChannel::*fnc)(),
                          const ChannelList& channels = ChannelList());
 
+    RGBWWAnimatedChannel& getAnimChannel(CtrlChannel ch) {
+        return _animChannels[static_cast<int>(ch) - static_cast<int>(CtrlChannel::Hue)];
+    }
+
+    // queue of the joint animations of the color mode the channel belongs to
+    RGBWWAnimatedChannel& getJointChannel(CtrlChannel ch) {
+        return _jointChannels[(ch >= CtrlChannel::Red) ? static_cast<int>(ColorMode::Raw)
+                                                       : static_cast<int>(ColorMode::Hsv)];
+    }
+
     ChannelOutput _current_output;
     HSVCT _current_color;
 
     PWMOutput* _pwm_output;
 
-    ChannelGroup _animChannelsHsv;
-    ChannelGroup _animChannelsRaw;
+    // state of the last frame written by show(), used to skip frames without changes
+    bool _outputInvalid = true;
+    ColorMode _shownMode = ColorMode::Hsv;
+    uint32_t _shownRevision = 0;
+
+    // hardware duty for every calculated value of a channel: brightness correction, dim curve
+    // and PWM scaling in one lookup. Channels with the same brightness correction share a table.
+    // 32 bit entries, the ESP8266 hardware PWM has a duty range of period * 1000 / 45
+    const uint32_t* _dutyLut[RGBWW_CHANNELS::NUM_CHANNELS] = {};
+    uint32_t* _dutyLutOwned[RGBWW_CHANNELS::NUM_CHANNELS] = {};
+    int _dutyLutBrightness[RGBWW_CHANNELS::NUM_CHANNELS] = {};
+    uint32_t _dutyLutRevision = 0;
+    bool _dutyLutValid = false;
+
+    // time based animation: time of the last step taken by show(now)
+    bool _timeBased = false;
+    Clock _clock = nullptr;
+    uint32_t _stepTime = 0;
+    bool _stepTimeValid = false;
+
+    // frame monitoring: time of the last frame and the deadline of the next one, 0 if none
+    bool _frameMonitoring = false;
+    bool _frameTimeValid = false;
+    uint32_t _frameTime = 0;
+    int _frameDeadline = 0;
+    FrameStats _frameStats;
+
+    // steps per show() when not time based and limits of FrameResult::nextFrame
+    int _frameSteps = RGBWW_MINTIMEDIFF / RGBWW_STEPTIME;
+    int _minFrameInterval = RGBWW_STEPTIME;
+    int _maxFrameInterval = RGBWW_MAXFRAMEINTERVAL;
+
+    // request the animations queued next belong to
+    RGBWWLedAnimation::Request _request;
+    uint32_t _stateRevision = 0;
+
+    // queue entries shared by all channels. Declared before the channels, so it outlives their queues
+    RGBWWLedAnimationQ::Budget _animQueueBudget{RGBWW_ANIMATIONQBUDGET};
+
+    // all channels stored inline and indexed by CtrlChannel (starting at CtrlChannel::Hue)
+    RGBWWAnimatedChannel _animChannels[static_cast<int>(CtrlChannel::WarmWhite)];
+
+    // joint animations indexed by ColorMode, only used for their queue
+    RGBWWAnimatedChannel _jointChannels[2];
+
+    const ChannelGroup _animChannelsHsv = {CtrlChannel::Hue, CtrlChannel::ColorTemp};
+    const ChannelGroup _animChannelsRaw = {CtrlChannel::Red, CtrlChannel::WarmWhite};
+
+#ifdef RGBWW_ENABLE_PROFILING
+    RGBWWLedProfiler _profiler;
+#endif
 
   protected:
     ColorMode _mode = ColorMode::Hsv;
@@ -9,13 +9,63 @@
 #include "RGBWWLedAnimation.h"
 #include "RGBWWLed.h"
 #include "RGBWWLedColor.h"
+#include "RGBWWLedScene.h"
+#include "RGBWWLedTimeline.h"
 // clang-format on
 
+// Pool and names are never destroyed: controllers with static storage duration delete
+// their animations after the end of main(), possibly after the destructors of this file ran
+RGBWWLedAnimationPool& RGBWWLedAnimation::pool() {
+    static RGBWWLedAnimationPool* pool = new RGBWWLedAnimationPool();
+    return *pool;
+}
+
+RGBWWLedAnimationNames& RGBWWLedAnimation::names() {
+    static RGBWWLedAnimationNames* names = new RGBWWLedAnimationNames();
+    return *names;
+}
+
+void* RGBWWLedAnimation::operator new(size_t size) noexcept {
+    return pool().allocate(size);
+}
+
+void RGBWWLedAnimation::operator delete(void* ptr) {
+    pool().deallocate(ptr);
+}
+
+bool RGBWWLedAnimation::initPool(int slots, int largeSlots) {
+    // the fades and blinks of single channels are queued most, the joint animations hold all channels
+    size_t slotSize = sizeof(AnimTransition);
+    slotSize = max(slotSize, sizeof(AnimTransitionCircularHue));
+    slotSize = max(slotSize, sizeof(AnimBlink));
+
+    size_t largeSlotSize = sizeof(AnimTimeline);
+    largeSlotSize = max(largeSlotSize, sizeof(AnimJointTransition));
+    largeSlotSize = max(largeSlotSize, sizeof(AnimScene));
+    return pool().init(slots, slotSize, largeSlots, largeSlotSize);
+}
+
 RGBWWLedAnimation::RGBWWLedAnimation(RGBWWLed const* rgbled, CtrlChannel ch, Type type, bool requeue,
                                      const String& name)
-    : _rgbled(rgbled), _ctrlChannel(ch), _requeue(requeue), _name(name), _type(type) {}
+    : _rgbled(rgbled), _ctrlChannel(ch), _requeue(requeue), _nameId(names().acquire(name)), _type(type) {}
+
+RGBWWLedAnimation::~RGBWWLedAnimation() {
+    names().release(_nameId);
+}
+
+bool RGBWWLedAnimation::advance(int& steps) {
+    while (steps > 0) {
+        --steps;
+        if (run())
+            return true;
+    }
+    return false;
+}
 
 int RGBWWLedAnimation::getBaseValue() const {
+    if (_hasBaseOverride)
+        return _baseOverride;
+
     const HSVCT& c = _rgbled->getCurrentColor();
     const ChannelOutput& o = _rgbled->getCurrentOutput();
 
@@ -74,33 +124,10 @@ bool AnimTransition::init() {
 
     _value = _baseval;
 
-    switch (_ramp.type) {
-    case RampTimeOrSpeed::Type::Time: {
-        _stepsNeededFade = static_cast<int>(_ramp.value / RGBWW_MINTIMEDIFF);
-        break;
-    }
-    case RampTimeOrSpeed::Type::Speed: {
-        // unit of speed is percent per second
-        // calculate percentage difference, keep in mind this is not for hue channel
-        const double diffPerc = (abs(_finalval - _baseval) / static_cast<double>(RGBWW_CALC_MAXVAL)) * 100;
-        // Calculate total time in ms, divide by time per step, then round
-        double total_time_ms = (diffPerc / _ramp.value) * 60000;
-        _stepsNeededFade = static_cast<int>((total_time_ms / RGBWW_MINTIMEDIFF) + 0.5);
-        break;
-    }
-    }
-
-    _stepsNeededFade = max(_stepsNeededFade, 1); // avoid 0 division
+    _stepsNeededFade = calcStepsNeeded(_ramp, _baseval, _finalval);
+    initFade(abs(_baseval - _finalval), (_baseval > _finalval) ? -1 : 1);
 
-    _bresenham.delta = abs(_baseval - _finalval);
-    _bresenham.step = 1;
-    _bresenham.step =
-        (_bresenham.delta < _stepsNeededFade) ? (_bresenham.step << 8) : (_bresenham.delta << 8) / _stepsNeededFade;
-    _bresenham.step *= (_baseval > _finalval) ? -1 : 1;
-    _bresenham.error = -1 * _stepsNeededFade;
-    _bresenham.count = 0;
-
-    _stepsNeededFadeAndStay = _stepsNeededFade + static_cast<int>(_stay / RGBWW_MINTIMEDIFF);
+    _stepsNeededFadeAndStay = _stepsNeededFade + static_cast<int>(_stay / RGBWW_STEPTIME);
 
     return true;
 }
@@ -120,8 +147,13 @@ bool AnimTransition::run() {
         _value = _finalval;
         return true;
     } else if (_currentstep < _stepsNeededFade) {
-        // we are fading. calculate new colors with bresenham
-        _value = bresenham(_bresenham, _stepsNeededFade, _baseval, _value);
+        if (_ramp.easing == Easing::Linear) {
+            // we are fading. calculate new colors with bresenham
+            _value = bresenham(_bresenham, _stepsNeededFade, _baseval, _value);
+        } else {
+            _easeProgress += _easeIncrement;
+            _value = easedValue();
+        }
     } else {
         // we are in the stay phase, do nothing
     }
@@ -129,11 +161,131 @@ bool AnimTransition::run() {
     return false;
 }
 
+bool AnimTransition::advance(int& steps) {
+    if (steps <= 0)
+        return false;
+
+    // the first step initializes the transition, like run()
+    if (_currentstep == 0 && !init()) {
+        --steps;
+        return true;
+    }
+
+    const int remaining = _stepsNeededFadeAndStay - _currentstep;
+    if (steps >= remaining) {
+        steps -= remaining;
+        _currentstep = _stepsNeededFadeAndStay;
+        _value = _finalval;
+        return true;
+    }
+
+    // same position as after one run() per step: the fade is calculated for the steps 1 .. _stepsNeededFade - 1
+    const int done = min(_currentstep, _stepsNeededFade - 1);
+    _currentstep += steps;
+    steps = 0;
+    const int calls = min(_currentstep, _stepsNeededFade - 1) - max(done, 0);
+    if (calls <= 0)
+        return false;
+
+    if (_ramp.easing == Easing::Linear) {
+        _value = bresenhamAdvance(_bresenham, _stepsNeededFade, _baseval, _value, calls);
+    } else {
+        _easeProgress += _easeIncrement * calls;
+        _value = easedValue();
+    }
+    return false;
+}
+
+void AnimTransition::initFade(int delta, int direction) {
+    initBresenham(_bresenham, delta, direction, _stepsNeededFade);
+
+    _distance = delta * direction;
+    _easeProgress = 0;
+    _easeIncrement = (1 << 24) / _stepsNeededFade;
+}
+
+int AnimTransition::easedValue() const {
+    const int eased = RGBWWEasing::ease(_ramp.easing, _easeProgress >> 8);
+    return _baseval + int((int64_t(_distance) * eased + RGBWWEasing::One / 2) >> 16);
+}
+
+int AnimTransition::stepsToNextChange() const {
+    if (_currentstep == 0)
+        return 1;
+
+    // the last step sets the final value
+    int next = _stepsNeededFadeAndStay;
+    if (_currentstep < _stepsNeededFade - 1 && _bresenham.delta > 0 && _ramp.easing != Easing::Linear) {
+        const int steps = easedStepsToNextChange(_ramp.easing, _easeProgress, _easeIncrement, _distance);
+        next = min(next, _currentstep + steps);
+    } else if (_currentstep < _stepsNeededFade - 1 && _bresenham.delta > 0) {
+        if (_bresenham.delta >= _stepsNeededFade) {
+            // the value changes with every call of bresenham()
+            next = _currentstep + 1;
+        } else {
+            // first call of bresenham() with a positive error after incrementing count, see bresenhamSeek()
+            const int64_t S = _stepsNeededFade;
+            const int64_t call = (2 * S * _bresenham.count + S) / (2 * _bresenham.delta) + 1;
+            if (call < _stepsNeededFade)
+                next = int(call);
+        }
+    }
+
+    return max(next - _currentstep, 1);
+}
+
+int AnimTransition::easedStepsToNextChange(Easing easing, int progress, int increment, int distance) {
+    // estimated from the slope of the curve, limited to the current segment of the easing table
+    const int position = progress >> 8;
+    const int64_t segmentEnd = int64_t((position / RGBWWEasing::SegmentWidth) + 1) * RGBWWEasing::SegmentWidth;
+    int64_t steps = ((segmentEnd << 8) - progress) / increment + 1;
+
+    // eased position per step (rounded up) and eased position left until the rounded value changes (rounded down)
+    const int64_t slope = RGBWWEasing::slope(easing, position);
+    const int64_t perStep = (slope * ((increment >> 8) + 1) + RGBWWEasing::One - 1) >> 16;
+    const int64_t scaled = int64_t(distance) * RGBWWEasing::ease(easing, position) + RGBWWEasing::One / 2;
+    const int64_t fraction = scaled & (RGBWWEasing::One - 1);
+    const int64_t left = ((distance > 0) ? RGBWWEasing::One - fraction : fraction + 1) / abs(distance) - 1;
+    if (perStep > 0)
+        steps = min(steps, max(int64_t(1), left / perStep));
+    return int(steps);
+}
+
 void AnimTransition::reset() {
     _currentstep = 0;
 }
 
-int AnimTransition::bresenham(BresenhamValues& values, int& dx, int& base, int& current) {
+int AnimTransition::calcStepsNeeded(const RampTimeOrSpeed& ramp, int base, int final, int stepTime) {
+    int steps = 0;
+    switch (ramp.type) {
+    case RampTimeOrSpeed::Type::Time: {
+        steps = static_cast<int>(ramp.value / stepTime);
+        break;
+    }
+    case RampTimeOrSpeed::Type::Speed: {
+        // unit of speed is percent per second
+        // calculate percentage difference, keep in mind this is not for hue channel
+        const double diffPerc = (abs(final - base) / static_cast<double>(RGBWW_CALC_MAXVAL)) * 100;
+        // Calculate total time in ms, divide by time per step, then round
+        double total_time_ms = (diffPerc / ramp.value) * 60000;
+        steps = static_cast<int>((total_time_ms / stepTime) + 0.5);
+        break;
+    }
+    }
+
+    return max(steps, 1); // avoid 0 division
+}
+
+void AnimTransition::initBresenham(BresenhamValues& values, int delta, int direction, int steps) {
+    values.delta = delta;
+    values.step = 1;
+    values.step = (values.delta < steps) ? (values.step << 8) : (values.delta << 8) / steps;
+    values.step *= direction;
+    values.error = -1 * steps;
+    values.count = 0;
+}
+
+int AnimTransition::bresenham(BresenhamValues& values, int dx, int base, int current) {
     // more information on bresenham:
     // https://www.cs.helsinki.fi/group/goa/mallinnus/lines/bresenh.html
     values.error = values.error + 2 * values.delta;
@@ -145,6 +297,38 @@ int AnimTransition::bresenham(BresenhamValues& values, int& dx, int& base, int&
     return current;
 }
 
+int AnimTransition::bresenhamAdvance(BresenhamValues& values, int dx, int base, int current, int calls) {
+    // the error grows by 2 * delta per call, count is incremented at most once per call
+    // whenever the error is positive. The error stays above -2 * dx, see bresenhamSeek()
+    const int64_t error = values.error + int64_t(2) * values.delta * calls;
+    if (error <= 0) {
+        values.error = int(error);
+        return current;
+    }
+
+    const int64_t divisor = int64_t(2) * dx;
+    int64_t count;
+    if (error <= INT32_MAX - divisor)
+        count = (int32_t(error) + int32_t(divisor) - 1) / int32_t(divisor);
+    else
+        count = (error + divisor - 1) / divisor;
+    count = min(int64_t(calls), count);
+
+    values.count += int(count);
+    values.error = int(error - divisor * count);
+    return base + ((values.count * values.step) >> 8);
+}
+
+int AnimTransition::bresenhamSeek(BresenhamValues& values, int dx, int base, int calls) {
+    // every call adds 2 * delta to the error and increments count at most once,
+    // count is incremented when the error becomes positive
+    const int64_t error = int64_t(2) * values.delta * calls - dx;
+    const int64_t count = (error > 0) ? min(int64_t(calls), (error + 2 * dx - 1) / (2 * dx)) : 0;
+    values.count = int(count);
+    values.error = int(error - 2 * dx * count);
+    return base + ((values.count * values.step) >> 8);
+}
+
 ///////////////////////////////
 
 AnimTransitionCircularHue::AnimTransitionCircularHue(RGBWWLed const* rgbled, const AbsOrRelValue& endVal,
@@ -167,45 +351,53 @@ bool AnimTransitionCircularHue::init() {
 
     _value = _baseval;
 
+    int delta;
+    const int d = calcDirection(_baseval, _finalval, _direction, delta);
+
+    _stepsNeededFade = calcStepsNeeded(_ramp, _baseval, _finalval, d);
+
+    // HUE
+    initFade(delta, d);
+
+    _stepsNeededFadeAndStay = _stepsNeededFade + static_cast<int>(_stay / RGBWW_STEPTIME);
+
+    return true;
+}
+
+int AnimTransitionCircularHue::calcDirection(int base, int final, HueTransitionDirection direction, int& delta) {
     // calculate hue direction
-    const int l = (_baseval + RGBWW_CALC_HUEWHEELMAX - _finalval) % RGBWW_CALC_HUEWHEELMAX;
-    const int r = (_finalval + RGBWW_CALC_HUEWHEELMAX - _baseval) % RGBWW_CALC_HUEWHEELMAX;
+    const int l = (base + RGBWW_CALC_HUEWHEELMAX - final) % RGBWW_CALC_HUEWHEELMAX;
+    const int r = (final + RGBWW_CALC_HUEWHEELMAX - base) % RGBWW_CALC_HUEWHEELMAX;
 
     // decide on direction of turn depending on size
     int d = (l < r) ? -1 : 1;
     // turn direction if user wishes for long transition
-    if (_direction == HueTransitionDirection::dir_long)
+    if (direction == HueTransitionDirection::dir_long)
         d *= -1;
 
-    switch (_ramp.type) {
+    delta = (d == -1) ? l : r;
+    return d;
+}
+
+int AnimTransitionCircularHue::calcStepsNeeded(const RampTimeOrSpeed& ramp, int base, int final, int direction,
+                                               int stepTime) {
+    int steps = 0;
+    switch (ramp.type) {
     case RampTimeOrSpeed::Type::Time: {
-        _stepsNeededFade = static_cast<int>(_ramp.value / RGBWW_MINTIMEDIFF);
+        steps = static_cast<int>(ramp.value / stepTime);
         break;
     }
     case RampTimeOrSpeed::Type::Speed: {
-        const uint32_t diff1 = abs(_finalval - _baseval);
+        const uint32_t diff1 = abs(final - base);
         const uint32_t diff2 = RGBWW_CALC_HUEWHEELMAX - diff1;
-        const uint32_t diff = (d == -1) ? max(diff1, diff2) : min(diff1, diff2);
+        const uint32_t diff = (direction == -1) ? max(diff1, diff2) : min(diff1, diff2);
         const double diffDegree = (static_cast<double>(diff) / RGBWW_CALC_HUEWHEELMAX) * 360;
-        _stepsNeededFade = static_cast<int>((diffDegree / _ramp.value) * 60000 / RGBWW_MINTIMEDIFF);
+        steps = static_cast<int>((diffDegree / ramp.value) * 60000 / stepTime);
         break;
     }
     }
 
-    _stepsNeededFade = max(_stepsNeededFade, 1); // avoid 0 division
-
-    // HUE
-    _bresenham.delta = (d == -1) ? l : r;
-    _bresenham.step = 1;
-    _bresenham.step =
-        (_bresenham.delta < _stepsNeededFade) ? (_bresenham.step << 8) : (_bresenham.delta << 8) / _stepsNeededFade;
-    _bresenham.step *= d;
-    _bresenham.error = -1 * _stepsNeededFade;
-    _bresenham.count = 0;
-
-    _stepsNeededFadeAndStay = _stepsNeededFade + static_cast<int>(_stay / RGBWW_MINTIMEDIFF);
-
-    return true;
+    return max(steps, 1); // avoid 0 division
 }
 
 bool AnimTransitionCircularHue::run() {
@@ -214,10 +406,16 @@ bool AnimTransitionCircularHue::run() {
     return result;
 }
 
+bool AnimTransitionCircularHue::advance(int& steps) {
+    const bool result = AnimTransition::advance(steps);
+    RGBWWColorUtils::circleHue(_value);
+    return result;
+}
+
 AnimBlink::AnimBlink(RGBWWLed const* rgbled, int blinkTime, CtrlChannel ch, bool requeue, const String& name)
     : RGBWWLedAnimation(rgbled, ch, Type::Blink, requeue, name) {
     if (blinkTime > 0) {
-        _stepsNeeded = blinkTime / RGBWW_MINTIMEDIFF;
+        _stepsNeeded = blinkTime / RGBWW_STEPTIME;
     }
 }
 
@@ -238,6 +436,30 @@ bool AnimBlink::run() {
     return true;
 }
 
+bool AnimBlink::advance(int& steps) {
+    if (_currentstep == 0 || _stepsNeeded == 0)
+        return RGBWWLedAnimation::advance(steps);
+
+    // the blink is finished with step _stepsNeeded
+    const int remaining = max(_stepsNeeded - _currentstep, 1);
+    if (steps < remaining) {
+        _currentstep += steps;
+        steps = 0;
+        return false;
+    }
+
+    _currentstep += remaining - 1;
+    steps -= remaining - 1;
+    return RGBWWLedAnimation::advance(steps);
+}
+
+int AnimBlink::stepsToNextChange() const {
+    if (_currentstep == 0 || _stepsNeeded == 0)
+        return 1;
+
+    return max(_stepsNeeded - _currentstep, 1);
+}
+
 bool AnimBlink::init() {
     // preserve the value before the blink
     _prevvalue = getBaseValue();
@@ -257,3 +479,188 @@ bool AnimBlink::init() {
 void AnimBlink::reset() {
     _currentstep = 0;
 }
+
+AnimJoint::AnimJoint(RGBWWLed const* rgbled, CtrlChannel first, int channels, Type type, bool requeue,
+                     const String& name)
+    : RGBWWLedAnimation(rgbled, first, type, requeue, name), _channelCount(constrain(channels, 0, MaxChannels)) {}
+
+int AnimJoint::getChannelValue(int index) const {
+    return _channels[index].getValue();
+}
+
+void AnimJoint::setChannelValue(int index, int value) {
+    _channels[index].setValue(value);
+}
+
+void AnimJoint::initFade(const Optional<AbsOrRelValue>* values, const Optional<AbsOrRelValue>* from,
+                         const RampTimeOrSpeed& ramp, int stay, HueTransitionDirection direction) {
+    const bool hsv = (_ctrlChannel == CtrlChannel::Hue);
+
+    _easing = ramp.easing;
+    _stepsNeededFade = 1;
+    for (int i = 0; i < _channelCount; ++i) {
+        int base = getChannelValue(i);
+        if (from != nullptr && from[i].hasValue()) {
+            base = from[i].getValue().getFinalValue(base);
+            setChannelValue(i, base);
+        }
+        _baseval[i] = base;
+        if (!values[i].hasValue()) {
+            _distance[i] = 0;
+            continue;
+        }
+
+        const int final = values[i].getValue().getFinalValue(base);
+        int steps;
+        if (hsv && i == 0) {
+            int delta;
+            const int d = AnimTransitionCircularHue::calcDirection(base, final, direction, delta);
+            _distance[i] = delta * d;
+            steps = AnimTransitionCircularHue::calcStepsNeeded(ramp, base, final, d);
+        } else {
+            _distance[i] = final - base;
+            steps = AnimTransition::calcStepsNeeded(ramp, base, final);
+        }
+        _stepsNeededFade = max(_stepsNeededFade, steps);
+    }
+
+    _stepsNeededFadeAndStay = _stepsNeededFade + static_cast<int>(stay / RGBWW_STEPTIME);
+    _easeProgress = 0;
+    _easeIncrement = (1 << 24) / _stepsNeededFade;
+}
+
+void AnimJoint::updateFadeValues(int eased) {
+    for (int i = 0; i < _channelCount; ++i) {
+        if (_distance[i] == 0)
+            continue;
+
+        int value = _baseval[i] + int((int64_t(_distance[i]) * eased + RGBWWEasing::One / 2) >> 16);
+        if (i == 0 && _ctrlChannel == CtrlChannel::Hue)
+            RGBWWColorUtils::circleHue(value);
+        setChannelValue(i, value);
+    }
+}
+
+bool AnimJoint::runFade() {
+    _currentstep++;
+    if (_currentstep >= _stepsNeededFadeAndStay) {
+        // arrive at the target values with the last step
+        updateFadeValues(RGBWWEasing::One);
+        _currentstep = 0;
+        return true;
+    }
+
+    if (_currentstep < _stepsNeededFade) {
+        _easeProgress += _easeIncrement;
+        updateFadeValues(RGBWWEasing::ease(_easing, _easeProgress >> 8));
+    }
+    return false;
+}
+
+bool AnimJoint::advanceFade(int& steps) {
+    const int remaining = _stepsNeededFadeAndStay - _currentstep;
+    if (steps >= remaining) {
+        steps -= remaining;
+        _currentstep = _stepsNeededFadeAndStay - 1;
+        return runFade();
+    }
+
+    // same position as after one runFade() per step
+    const int fadeSteps = min(_currentstep + steps, _stepsNeededFade - 1);
+    if (fadeSteps > min(_currentstep, _stepsNeededFade - 1)) {
+        _easeProgress = _easeIncrement * fadeSteps;
+        updateFadeValues(RGBWWEasing::ease(_easing, _easeProgress >> 8));
+    }
+    _currentstep += steps;
+    steps = 0;
+    return false;
+}
+
+int AnimJoint::fadeStepsToNextChange() const {
+    // the last step sets the target values
+    int next = _stepsNeededFadeAndStay;
+    if (_currentstep < _stepsNeededFade - 1) {
+        for (int i = 0; i < _channelCount; ++i) {
+            if (_distance[i] == 0)
+                continue;
+
+            const int steps = AnimTransition::easedStepsToNextChange(_easing, _easeProgress, _easeIncrement,
+                                                                     _distance[i]);
+            next = min(next, _currentstep + steps);
+        }
+    }
+
+    return max(next - _currentstep, 1);
+}
+
+AnimJointTransition::AnimJointTransition(RGBWWLed const* rgbled, const RequestHSVCT& color,
+                                         const RampTimeOrSpeed& ramp, int stay, HueTransitionDirection direction,
+                                         bool requeue, const String& name)
+    : AnimJoint(rgbled, CtrlChannel::Hue, 4, Type::JointTransition, requeue, name), _ramp(ramp), _stay(stay),
+      _direction(direction) {
+    _initEndVal[0] = color.h;
+    _initEndVal[1] = color.s;
+    _initEndVal[2] = color.v;
+    _initEndVal[3] = color.ct;
+}
+
+AnimJointTransition::AnimJointTransition(RGBWWLed const* rgbled, const RequestHSVCT& colorFrom,
+                                         const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay,
+                                         HueTransitionDirection direction, bool requeue, const String& name)
+    : AnimJointTransition(rgbled, color, ramp, stay, direction, requeue, name) {
+    _initStartVal[0] = colorFrom.h;
+    _initStartVal[1] = colorFrom.s;
+    _initStartVal[2] = colorFrom.v;
+    _initStartVal[3] = colorFrom.ct;
+    _hasfromval = true;
+}
+
+AnimJointTransition::AnimJointTransition(RGBWWLed const* rgbled, const RequestChannelOutput& output,
+                                         const RampTimeOrSpeed& ramp, int stay, bool requeue, const String& name)
+    : AnimJoint(rgbled, CtrlChannel::Red, 5, Type::JointTransition, requeue, name), _ramp(ramp), _stay(stay) {
+    // same order as CtrlChannel
+    _initEndVal[0] = output.r;
+    _initEndVal[1] = output.g;
+    _initEndVal[2] = output.b;
+    _initEndVal[3] = output.cw;
+    _initEndVal[4] = output.ww;
+}
+
+AnimJointTransition::AnimJointTransition(RGBWWLed const* rgbled, const RequestChannelOutput& outputFrom,
+                                         const RequestChannelOutput& output, const RampTimeOrSpeed& ramp, int stay,
+                                         bool requeue, const String& name)
+    : AnimJointTransition(rgbled, output, ramp, stay, requeue, name) {
+    _initStartVal[0] = outputFrom.r;
+    _initStartVal[1] = outputFrom.g;
+    _initStartVal[2] = outputFrom.b;
+    _initStartVal[3] = outputFrom.cw;
+    _initStartVal[4] = outputFrom.ww;
+    _hasfromval = true;
+}
+
+void AnimJointTransition::init() {
+    initFade(_initEndVal, _hasfromval ? _initStartVal : nullptr, _ramp, _stay, _direction);
+}
+
+bool AnimJointTransition::run() {
+    if (!isFadeStarted())
+        init();
+    return runFade();
+}
+
+bool AnimJointTransition::advance(int& steps) {
+    if (steps <= 0)
+        return false;
+
+    if (!isFadeStarted())
+        init();
+    return advanceFade(steps);
+}
+
+int AnimJointTransition::stepsToNextChange() const {
+    return isFadeStarted() ? fadeStepsToNextChange() : 1;
+}
+
+void AnimJointTransition::reset() {
+    resetFade();
+}
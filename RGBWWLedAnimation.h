@@ -10,9 +10,14 @@
 // clang-format off
 #include "RGBWWTypes.h"
 #include "RGBWWLedColor.h"
+#include "RGBWWLedAnimationPool.h"
+#include "RGBWWLedAnimationNames.h"
 // clang-format on
 class RGBWWLed;
 class RGBWWLedAnimation;
+class RGBWWAnimatedChannel;
+class RGBWWLedSnapshotWriter;
+class RGBWWLedSnapshotReader;
 
 /**
  * Abstract class representing the interface for animations
@@ -20,16 +25,61 @@ class RGBWWLedAnimation;
  */
 class RGBWWLedAnimation {
   public:
+    /**
+     * Call of the controller which queued the animation (i.e. one fadeHSV())
+     */
+    struct Request {
+        uint16_t id = 0;       // 0 if not queued by a call of the controller
+        uint16_t channels = 0; // ctrlChannelBit() of every channel of the call
+        uint8_t cycle = 0;     // incremented whenever the animation is requeued
+    };
+
     enum class Type {
         Undefined,
         SetAndStay,
         Transition,
         Blink,
+        Timeline,
+        JointTransition,
+        Scene,
     };
 
     RGBWWLedAnimation(RGBWWLed const* rgbled, CtrlChannel ch, Type type, bool requeue = false, const String& name = "");
 
-    virtual ~RGBWWLedAnimation(){};
+    virtual ~RGBWWLedAnimation();
+
+    /**
+     * Animations are allocated from the animation pool once it is initialized.
+     * Before the pool is initialized and while it is exhausted the heap is used,
+     * counted in AnimationPoolStats::heap. Returns nullptr if the heap is exhausted too.
+     */
+    static void* operator new(size_t size) noexcept;
+    static void operator delete(void* ptr);
+
+    /**
+     * Allocate the animation pool. The small slots are sized for the animations of
+     * single channels (AnimTransition, AnimBlink), the large ones for the biggest
+     * animation type of the library (AnimJointTransition). Small animations take a large
+     * slot when the small ones are used up. Timelines and scenes keep their keyframes
+     * and code on the heap
+     *
+     * @param slots      number of small animations the pool can hold
+     * @param largeSlots number of large animations the pool can hold
+     * @retval true  pool was allocated
+     * @retval false pool was already initialized or out of memory
+     */
+    static bool initPool(int slots, int largeSlots = RGBWW_ANIMATIONPOOLLARGE);
+
+    static const RGBWWLedAnimationPool& getPool() {
+        return pool();
+    }
+
+    /**
+     * Names of all animations, the animations store the id of their name
+     */
+    static const RGBWWLedAnimationNames& getNames() {
+        return names();
+    }
 
     /**
      * Processing method, will be called from main loop
@@ -42,6 +92,25 @@ class RGBWWLedAnimation {
         return true;
     };
 
+    /**
+     * Advance the animation by several steps at once (one step per RGBWW_STEPTIME).
+     * Used when a frame covers more than one step
+     *
+     * @param steps     steps to advance, at least 1. Returns the steps left over
+     *                  after the animation finished, 0 otherwise
+     * @retval true     the animation is finished
+     * @retval false    the animation is not finished yet
+     */
+    virtual bool advance(int& steps);
+
+    /**
+     * Steps until the value of the animation changes next (at least 1).
+     * Used to choose the interval of the next frame
+     */
+    virtual int stepsToNextChange() const {
+        return 1;
+    }
+
     virtual const char* toString() {
         return "<empty>";
     }
@@ -68,12 +137,28 @@ class RGBWWLedAnimation {
      */
     virtual void reset(){};
 
+    /**
+     * Start from the given value instead of the current color/output of the controller.
+     * Used when an animation starts in the middle of several steps, before the
+     * controller has shown the value the previous animation ended with
+     *
+     * @param enabled   false to use the current color/output again
+     */
+    void overrideBaseValue(bool enabled, int value = 0) {
+        _hasBaseOverride = enabled;
+        _baseOverride = value;
+    }
+
     bool shouldRequeue() const {
         return _requeue;
     }
 
     const String& getName() const {
-        return _name;
+        return names().getName(_nameId);
+    }
+
+    RGBWWLedAnimationNames::Id getNameId() const {
+        return _nameId;
     }
 
     int getAnimValue() const {
@@ -84,15 +169,87 @@ class RGBWWLedAnimation {
         return _type;
     }
 
+    const Request& getRequest() const {
+        return _request;
+    }
+
+    void setRequest(const Request& request) {
+        _request = request;
+    }
+
+    /**
+     * Start a new cycle of the request, called when the animation is requeued
+     */
+    void nextRequestCycle() {
+        ++_request.cycle;
+    }
+
+    /**
+     * Check if the animation can be saved into a snapshot, true for the animations of the library
+     */
+    bool isSnapshotSupported() const {
+        return getSnapshotClass() != SnapshotClass::None;
+    }
+
+    /**
+     * Save the animation including its progress, see RGBWWLed::saveSnapshot()
+     */
+    void saveSnapshot(RGBWWLedSnapshotWriter& writer) const;
+
+    /**
+     * Create an animation saved by saveSnapshot(), it continues with the step it was saved at
+     *
+     * @param ch        channel of the animation, first channel of the color mode for joint animations
+     * @param channels  channels joint animations are attached to, nullptr for animations of a single channel
+     * @return RGBWWLedAnimation* nullptr if the snapshot is invalid (the error flag of reader
+     *                            is set) or the animation can not be allocated
+     */
+    static RGBWWLedAnimation* restoreSnapshot(RGBWWLedSnapshotReader& reader, RGBWWLed const* rgbled, CtrlChannel ch,
+                                              RGBWWAnimatedChannel* channels);
+
   protected:
+    // classes of the library in a snapshot
+    enum class SnapshotClass : uint8_t {
+        None,
+        Transition,
+        TransitionCircularHue,
+        Blink,
+        Timeline,
+        JointTransition,
+        Scene,
+    };
+
+    virtual SnapshotClass getSnapshotClass() const {
+        return SnapshotClass::None;
+    }
+
+    /**
+     * State of the derived class, the members of RGBWWLedAnimation are saved by saveSnapshot()
+     */
+    virtual void saveState(RGBWWLedSnapshotWriter& writer) const {}
+    virtual void loadState(RGBWWLedSnapshotReader& reader) {}
+
     int getBaseValue() const;
 
     RGBWWLed const* _rgbled = nullptr;
     CtrlChannel _ctrlChannel = CtrlChannel::None;
     const bool _requeue = false;
-    const String _name;
+    const RGBWWLedAnimationNames::Id _nameId = RGBWWLedAnimationNames::None;
     int _value = 0;
     Type _type = Type::Undefined;
+    Request _request;
+
+  private:
+    friend class RGBWWLedAnimationQ;
+
+    bool _hasBaseOverride = false;
+    int _baseOverride = 0;
+
+    // link to the next animation while the animation is queued
+    RGBWWLedAnimation* _next = nullptr;
+
+    static RGBWWLedAnimationPool& pool();
+    static RGBWWLedAnimationNames& names();
 };
 
 class AnimTransition : public RGBWWLedAnimation {
@@ -104,13 +261,77 @@ class AnimTransition : public RGBWWLedAnimation {
                    const String& name = "");
 
     virtual bool run() override;
+    virtual bool advance(int& steps) override;
+    virtual int stepsToNextChange() const override;
     virtual void reset() override;
 
+    /**
+     * Number of steps for a linear fade from base to final value
+     *
+     * @param ramp      duration or speed (percent per second) of the fade
+     * @param stepTime  duration of one step in ms
+     * @return int      steps, at least 1
+     */
+    static int calcStepsNeeded(const RampTimeOrSpeed& ramp, int base, int final, int stepTime = RGBWW_STEPTIME);
+
+    /**
+     * Steps until the rounded value of an eased fade changes next (estimated, at least 1)
+     *
+     * @param progress  progress of the fade, fixed point with 24 fractional bits
+     * @param increment progress per step
+     * @param distance  signed distance of the fade, not 0
+     */
+    static int easedStepsToNextChange(Easing easing, int progress, int increment, int distance);
+
+    /**
+     * Prepare the bresenham values for a fade
+     *
+     * @param delta     absolute distance between start and end value
+     * @param direction 1 for increasing, -1 for decreasing values
+     * @param steps     steps of the fade
+     */
+    static void initBresenham(BresenhamValues& values, int delta, int direction, int steps);
+
+    /**
+     * Next value of a fade. Has to be called once per step
+     */
+    static int bresenham(BresenhamValues& values, int dx, int base, int current);
+
+    /**
+     * Value of a fade after the given number of calls of bresenham(), without
+     * calling it for every step. Updates values like the calls would
+     *
+     * @param values    values prepared by initBresenham()
+     * @param calls     calls of bresenham() since initBresenham()
+     */
+    static int bresenhamSeek(BresenhamValues& values, int dx, int base, int calls);
+
+    /**
+     * Like the given number of calls of bresenham() from the current values, in constant
+     * time. The usual frame of a few steps needs one 32 bit division
+     *
+     * @param calls     calls of bresenham(), 0 returns current
+     */
+    static int bresenhamAdvance(BresenhamValues& values, int dx, int base, int current, int calls);
+
   protected:
-    int bresenham(BresenhamValues& values, int& dx, int& base, int& current);
+    virtual SnapshotClass getSnapshotClass() const override {
+        return SnapshotClass::Transition;
+    }
+    virtual void saveState(RGBWWLedSnapshotWriter& writer) const override;
+    virtual void loadState(RGBWWLedSnapshotReader& reader) override;
 
     virtual bool init();
 
+    /**
+     * Prepare bresenham or easing for the fade from _baseval
+     *
+     * @param delta     absolute distance of the fade
+     * @param direction 1 for increasing, -1 for decreasing values
+     */
+    void initFade(int delta, int direction);
+    int easedValue() const;
+
     int _baseval = 0;
     int _currentval = 0;
     int _finalval = 0;
@@ -121,6 +342,10 @@ class AnimTransition : public RGBWWLedAnimation {
         0; // steps for fading + staying (after the fade). so this is the total number of steps
 
     BresenhamValues _bresenham;
+    // eased transitions: progress of the fade (fixed point, 24 fractional bits) and signed distance
+    int _easeProgress = 0;
+    int _easeIncrement = 0;
+    int _distance = 0;
     AbsOrRelValue _initEndVal;
     AbsOrRelValue _initStartVal;
     RampTimeOrSpeed _ramp;
@@ -137,6 +362,32 @@ class AnimTransitionCircularHue : public AnimTransition {
                               bool requeue = false, const String& name = "");
 
     virtual bool run() override;
+    virtual bool advance(int& steps) override;
+
+    /**
+     * Distance and direction of a fade on the hue wheel
+     *
+     * @param delta     distance on the hue wheel
+     * @return int      1 for increasing, -1 for decreasing hue
+     */
+    static int calcDirection(int base, int final, HueTransitionDirection direction, int& delta);
+
+    /**
+     * Number of steps for a fade on the hue wheel
+     *
+     * @param ramp      duration or speed (degree per second) of the fade
+     * @param stepTime  duration of one step in ms
+     * @return int      steps, at least 1
+     */
+    static int calcStepsNeeded(const RampTimeOrSpeed& ramp, int base, int final, int direction,
+                               int stepTime = RGBWW_STEPTIME);
+
+  protected:
+    virtual SnapshotClass getSnapshotClass() const override {
+        return SnapshotClass::TransitionCircularHue;
+    }
+    virtual void saveState(RGBWWLedSnapshotWriter& writer) const override;
+    virtual void loadState(RGBWWLedSnapshotReader& reader) override;
 
   private:
     virtual bool init() override;
@@ -149,8 +400,17 @@ class AnimBlink : public RGBWWLedAnimation {
     AnimBlink(RGBWWLed const* rgbled, int blinkTime, CtrlChannel ch, bool requeue = false, const String& name = "");
 
     virtual bool run() override;
+    virtual bool advance(int& steps) override;
+    virtual int stepsToNextChange() const override;
     virtual void reset() override;
 
+  protected:
+    virtual SnapshotClass getSnapshotClass() const override {
+        return SnapshotClass::Blink;
+    }
+    virtual void saveState(RGBWWLedSnapshotWriter& writer) const override;
+    virtual void loadState(RGBWWLedSnapshotReader& reader) override;
+
   private:
     virtual bool init();
 
@@ -160,3 +420,141 @@ class AnimBlink : public RGBWWLedAnimation {
   protected:
     int _prevvalue = 0;
 };
+
+/**
+ * Animation of all channels of a color mode at once (hue, sat, val, ct or red, green, blue, cw, ww).
+ * Queued with RGBWWLed::pushJointAnimation(), which attaches the channels. The animation
+ * writes the channel values itself, its own value is unused.
+ *
+ * Provides a fade of all channels with one step counter: the easing is evaluated
+ * once per step for all channels and all channels arrive with the same step.
+ * Linear fades are interpolated in fixed point like the eased ones, so their values
+ * can differ slightly from the bresenham steps of AnimTransition.
+ */
+class AnimJoint : public RGBWWLedAnimation {
+  public:
+    static const int MaxChannels = 5;
+
+    AnimJoint(RGBWWLed const* rgbled, CtrlChannel first, int channels, Type type, bool requeue = false,
+              const String& name = "");
+
+    /**
+     * @param channels first of getChannelCount() consecutive channels
+     */
+    void attach(RGBWWAnimatedChannel* channels) {
+        _channels = channels;
+    }
+
+    CtrlChannel getFirstChannel() const {
+        return _ctrlChannel;
+    }
+
+    int getChannelCount() const {
+        return _channelCount;
+    }
+
+  protected:
+    int getChannelValue(int index) const;
+    void setChannelValue(int index, int value);
+
+    /**
+     * Start a fade of all channels, channels without value keep their value.
+     * The steps of the fade are the longest of all channels
+     *
+     * @param values    target values in the order of CtrlChannel
+     * @param from      start values or nullptr to start from the current values
+     * @param stay      ms to stay at the target values
+     */
+    void initFade(const Optional<AbsOrRelValue>* values, const Optional<AbsOrRelValue>* from,
+                  const RampTimeOrSpeed& ramp, int stay, HueTransitionDirection direction);
+
+    bool isFadeStarted() const {
+        return _currentstep != 0;
+    }
+
+    /**
+     * One step of the fade. The last step sets the target values
+     *
+     * @retval true     the fade (and stay) is finished
+     */
+    bool runFade();
+
+    /**
+     * Several steps of the fade, like calling runFade() for every step
+     *
+     * @param steps     returns the steps left over after the fade finished
+     */
+    bool advanceFade(int& steps);
+    int fadeStepsToNextChange() const;
+
+    void resetFade() {
+        _currentstep = 0;
+    }
+
+    /**
+     * State of the fade, called by the derived classes
+     */
+    virtual void saveState(RGBWWLedSnapshotWriter& writer) const override;
+    virtual void loadState(RGBWWLedSnapshotReader& reader) override;
+
+    RGBWWAnimatedChannel* _channels = nullptr;
+    int _channelCount = 0;
+
+  private:
+    /**
+     * @param eased eased position of the fade (0 .. RGBWWEasing::One)
+     */
+    void updateFadeValues(int eased);
+
+    Easing _easing = Easing::Linear;
+    int _currentstep = 0; // 0 before the fade started
+    int _stepsNeededFade = 0;
+    int _stepsNeededFadeAndStay = 0;
+    int _easeProgress = 0; // fixed point, 24 fractional bits
+    int _easeIncrement = 0;
+    int _baseval[MaxChannels] = {};
+    int _distance[MaxChannels] = {}; // signed, 0 for channels without change
+};
+
+/**
+ * Fade of all channels of a color mode with one animation, one step counter and
+ * one finish event, instead of one AnimTransition per channel.
+ * It holds the requests of all channels and is the biggest animation, the large slots of
+ * the animation pool are sized for it (one slot per fade instead of one slot per channel)
+ */
+class AnimJointTransition : public AnimJoint {
+  public:
+    AnimJointTransition(RGBWWLed const* rgbled, const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay,
+                        HueTransitionDirection direction, bool requeue = false, const String& name = "");
+    AnimJointTransition(RGBWWLed const* rgbled, const RequestHSVCT& colorFrom, const RequestHSVCT& color,
+                        const RampTimeOrSpeed& ramp, int stay, HueTransitionDirection direction, bool requeue = false,
+                        const String& name = "");
+    AnimJointTransition(RGBWWLed const* rgbled, const RequestChannelOutput& output, const RampTimeOrSpeed& ramp,
+                        int stay, bool requeue = false, const String& name = "");
+    AnimJointTransition(RGBWWLed const* rgbled, const RequestChannelOutput& outputFrom,
+                        const RequestChannelOutput& output, const RampTimeOrSpeed& ramp, int stay,
+                        bool requeue = false, const String& name = "");
+
+    virtual bool run() override;
+    virtual bool advance(int& steps) override;
+    virtual int stepsToNextChange() const override;
+    virtual void reset() override;
+
+  protected:
+    virtual SnapshotClass getSnapshotClass() const override {
+        return SnapshotClass::JointTransition;
+    }
+    virtual void saveState(RGBWWLedSnapshotWriter& writer) const override;
+    virtual void loadState(RGBWWLedSnapshotReader& reader) override;
+
+  private:
+    void init();
+
+    // in the order of CtrlChannel
+    Optional<AbsOrRelValue> _initEndVal[MaxChannels];
+    Optional<AbsOrRelValue> _initStartVal[MaxChannels];
+    bool _hasfromval = false;
+    RampTimeOrSpeed _ramp;
+    int _stay = 0; // milliseconds
+    HueTransitionDirection _direction = HueTransitionDirection::dir_short;
+};
@@ -0,0 +1,81 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+#include "RGBWWLedAnimationNames.h"
+
+RGBWWLedAnimationNames::Id RGBWWLedAnimationNames::acquire(const String& name) {
+    if (name.length() == 0)
+        return None;
+
+    int unused = -1;
+    for (int i = 0; i < RGBWW_ANIMATIONNAMES; ++i) {
+        Entry& entry = _entries[i];
+        if (entry.name == name) {
+            ++entry.refs;
+            return Id(i + 1);
+        }
+        // prefer entries which never held a name, they do not drop a cached name
+        if (entry.refs == 0 && (unused < 0 || entry.name.length() == 0))
+            unused = i;
+    }
+
+    if (unused < 0) {
+        debug_w("RGBWWLedAnimationNames::acquire: name table full, dropping name %s\n", name.c_str());
+        return None;
+    }
+
+    _entries[unused].name = name;
+    _entries[unused].refs = 1;
+    return Id(unused + 1);
+}
+
+void RGBWWLedAnimationNames::release(Id id) {
+    if (id == None || id > RGBWW_ANIMATIONNAMES)
+        return;
+
+    Entry& entry = _entries[id - 1];
+    if (entry.refs > 0)
+        --entry.refs;
+}
+
+bool RGBWWLedAnimationNames::isAvailable(const String& name) const {
+    if (name.length() == 0)
+        return true;
+
+    for (const Entry& entry : _entries) {
+        if (entry.refs == 0 || entry.name == name)
+            return true;
+    }
+    return false;
+}
+
+RGBWWLedAnimationNames::Id RGBWWLedAnimationNames::find(const String& name) const {
+    if (name.length() == 0)
+        return None;
+
+    for (int i = 0; i < RGBWW_ANIMATIONNAMES; ++i) {
+        if (_entries[i].name == name)
+            return Id(i + 1);
+    }
+    return None;
+}
+
+const String& RGBWWLedAnimationNames::getName(Id id) const {
+    if (id == None || id > RGBWW_ANIMATIONNAMES)
+        return _empty;
+
+    return _entries[id - 1].name;
+}
+
+int RGBWWLedAnimationNames::getUsed() const {
+    int used = 0;
+    for (const Entry& entry : _entries) {
+        if (entry.refs > 0)
+            ++used;
+    }
+    return used;
+}
@@ -0,0 +1,75 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite LEDs via PWM
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+
+#pragma once
+
+#include "RGBWWconst.h"
+
+/**
+ * Interned names of animations
+ *
+ * Animations store a small id instead of a copy of their name. Each distinct
+ * name is copied once into the table, queuing more animations with the same
+ * name does not touch the heap. Names no longer used by any animation stay
+ * in the table until their entry is needed for another name.
+ */
+class RGBWWLedAnimationNames {
+  public:
+    typedef uint8_t Id;
+
+    // id of the empty name
+    static const Id None = 0;
+
+    RGBWWLedAnimationNames() {}
+    RGBWWLedAnimationNames(const RGBWWLedAnimationNames&) = delete;
+    RGBWWLedAnimationNames& operator=(const RGBWWLedAnimationNames&) = delete;
+
+    /**
+     * Id of a name, the name is added to the table if needed.
+     * Every call has to be matched by a call of release()
+     *
+     * @return Id   None for an empty name or if all entries are in use
+     */
+    Id acquire(const String& name);
+
+    void release(Id id);
+
+    /**
+     * Check if acquire() gets an id for a name
+     *
+     * @retval true     the name is empty, already in the table or an entry is unused
+     * @retval false    all entries are in use by other names
+     */
+    bool isAvailable(const String& name) const;
+
+    /**
+     * Id of a name without adding it
+     *
+     * @return Id   None if the name is not in the table
+     */
+    Id find(const String& name) const;
+
+    /**
+     * Name of an id, empty for None or an unknown id
+     */
+    const String& getName(Id id) const;
+
+    /**
+     * Number of names used by animations
+     */
+    int getUsed() const;
+
+  private:
+    struct Entry {
+        String name;
+        uint16_t refs = 0;
+    };
+
+    Entry _entries[RGBWW_ANIMATIONNAMES];
+    const String _empty;
+};
@@ -0,0 +1,109 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+#include "RGBWWLedAnimationPool.h"
+
+RGBWWLedAnimationPool::~RGBWWLedAnimationPool() {
+    for (Class& c : _classes)
+        delete[] c.memory;
+}
+
+bool RGBWWLedAnimationPool::init(int slots, size_t slotSize, int largeSlots, size_t largeSlotSize) {
+    if (isInitialized() || slots <= 0 || largeSlots < 0)
+        return false;
+
+    const int classSlots[SizeClasses] = {slots, largeSlots};
+    const size_t classSlotSizes[SizeClasses] = {slotSize, max(slotSize, largeSlotSize)};
+    for (int i = 0; i < SizeClasses; ++i) {
+        Class& c = _classes[i];
+        if (classSlots[i] == 0)
+            continue;
+
+        // keep every slot aligned for the objects stored in it
+        c.slotSize = (max(classSlotSizes[i], sizeof(FreeSlot)) + 7) & ~size_t(7);
+        c.memory = new uint8_t[classSlots[i] * c.slotSize];
+        if (c.memory == nullptr) {
+            for (Class& other : _classes) {
+                delete[] other.memory;
+                other = Class();
+            }
+            return false;
+        }
+
+        c.free = nullptr;
+        for (int s = classSlots[i] - 1; s >= 0; --s) {
+            FreeSlot* slot = reinterpret_cast<FreeSlot*>(c.memory + s * c.slotSize);
+            slot->next = c.free;
+            c.free = slot;
+        }
+        c.slots = classSlots[i];
+    }
+
+    _stats.capacity = slots + largeSlots;
+    _stats.bytes = 0;
+    for (const Class& c : _classes)
+        _stats.bytes += c.slots * c.slotSize;
+    return true;
+}
+
+void* RGBWWLedAnimationPool::acquire(size_t size) {
+    for (Class& c : _classes) {
+        if (size > c.slotSize || c.free == nullptr)
+            continue;
+
+        FreeSlot* slot = c.free;
+        c.free = slot->next;
+
+        ++_stats.used;
+        _stats.highWater = max(_stats.highWater, _stats.used);
+        return slot;
+    }
+    return nullptr;
+}
+
+bool RGBWWLedAnimationPool::release(void* ptr) {
+    for (Class& c : _classes) {
+        const uint8_t* p = static_cast<const uint8_t*>(ptr);
+        if (c.memory == nullptr || p < c.memory || p >= c.memory + c.slots * c.slotSize)
+            continue;
+
+        FreeSlot* slot = static_cast<FreeSlot*>(ptr);
+        slot->next = c.free;
+        c.free = slot;
+
+        --_stats.used;
+        return true;
+    }
+    return false;
+}
+
+bool RGBWWLedAnimationPool::owns(const void* ptr) const {
+    const uint8_t* p = static_cast<const uint8_t*>(ptr);
+    for (const Class& c : _classes) {
+        if (c.memory != nullptr && p >= c.memory && p < c.memory + c.slots * c.slotSize)
+            return true;
+    }
+    return false;
+}
+
+void* RGBWWLedAnimationPool::allocate(size_t size) {
+    void* ptr = acquire(size);
+    if (ptr != nullptr)
+        return ptr;
+
+    ptr = malloc(size);
+    if (ptr != nullptr)
+        ++_stats.heap;
+    else
+        ++_stats.failed;
+    return ptr;
+}
+
+void RGBWWLedAnimationPool::deallocate(void* ptr) {
+    if (!release(ptr))
+        free(ptr);
+}
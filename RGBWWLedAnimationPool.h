@@ -0,0 +1,123 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite LEDs via PWM
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+
+#pragma once
+
+#include "RGBWWconst.h"
+
+/**
+ * Usage counters of an animation pool, summed over its size classes
+ */
+struct AnimationPoolStats {
+    int capacity = 0;  // number of slots in the pool
+    int used = 0;      // slots currently in use
+    int highWater = 0; // maximum number of slots used at the same time
+    int heap = 0;      // allocations served from the heap because the pool was exhausted or not initialized
+    int failed = 0;    // allocations which failed, neither the pool nor the heap had memory left
+    size_t bytes = 0;  // memory of all slots
+};
+
+/**
+ * Fixed capacity storage for animation objects
+ *
+ * The slots come in two size classes, so the small and frequent animations do not
+ * occupy slots sized for the biggest one. All slots of a class are allocated in one
+ * block by init(). Afterwards acquiring and releasing slots does not touch the heap anymore.
+ */
+class RGBWWLedAnimationPool {
+  public:
+    enum SizeClass {
+        Small,
+        Large,
+        SizeClasses,
+    };
+
+    RGBWWLedAnimationPool() {}
+    RGBWWLedAnimationPool(const RGBWWLedAnimationPool&) = delete;
+    RGBWWLedAnimationPool& operator=(const RGBWWLedAnimationPool&) = delete;
+    ~RGBWWLedAnimationPool();
+
+    /**
+     * Allocate the pool memory
+     *
+     * @param slots         number of small objects the pool can hold
+     * @param slotSize      size of a small slot in bytes
+     * @param largeSlots    number of large objects the pool can hold
+     * @param largeSlotSize size of a large slot in bytes
+     * @retval true     pool was allocated
+     * @retval false    pool is already initialized or out of memory
+     */
+    bool init(int slots, size_t slotSize, int largeSlots = 0, size_t largeSlotSize = 0);
+
+    bool isInitialized() const {
+        return _classes[Small].memory != nullptr;
+    }
+
+    /**
+     * Get a free slot of the smallest size class the object fits into.
+     * Once the small slots are used up, small objects take large slots
+     *
+     * @param size  requested size
+     * @return pointer to the slot or nullptr if no fitting slot is free
+     */
+    void* acquire(size_t size);
+
+    /**
+     * Return a slot to the pool
+     *
+     * @param ptr   pointer returned by acquire()
+     * @retval true     slot was released
+     * @retval false    ptr is not part of this pool
+     */
+    bool release(void* ptr);
+
+    bool owns(const void* ptr) const;
+
+    /**
+     * Get a slot, or memory from the heap if the pool is exhausted.
+     * Heap allocations are counted in AnimationPoolStats::heap
+     *
+     * @param size  requested size
+     * @return pointer to the memory or nullptr if the heap is exhausted too
+     */
+    void* allocate(size_t size);
+
+    /**
+     * Free memory returned by allocate()
+     *
+     * @param ptr   pointer returned by allocate() or nullptr
+     */
+    void deallocate(void* ptr);
+
+    size_t getSlotSize(SizeClass sizeClass = Small) const {
+        return _classes[sizeClass].slotSize;
+    }
+
+    int getSlots(SizeClass sizeClass = Small) const {
+        return _classes[sizeClass].slots;
+    }
+
+    const AnimationPoolStats& getStats() const {
+        return _stats;
+    }
+
+  private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    struct Class {
+        uint8_t* memory = nullptr;
+        FreeSlot* free = nullptr;
+        size_t slotSize = 0;
+        int slots = 0;
+    };
+
+    Class _classes[SizeClasses];
+    AnimationPoolStats _stats;
+};
@@ -10,17 +10,14 @@
 #include "RGBWWLedAnimation.h"
 // clang-format on
 
-RGBWWLedAnimationQ::RGBWWLedAnimationQ(int qsize) {
-    _size = qsize;
-    _count = 0;
-    _front = 0;
-    _back = 0;
-    _q = new RGBWWLedAnimation*[qsize];
-}
+RGBWWLedAnimationQ::RGBWWLedAnimationQ(int qsize, Budget* budget) : _size(qsize), _budget(budget) {}
 
 RGBWWLedAnimationQ::~RGBWWLedAnimationQ() {
     clear();
-    delete _q;
+}
+
+void RGBWWLedAnimationQ::setBudget(Budget* budget) {
+    _budget = budget;
 }
 
 bool RGBWWLedAnimationQ::isEmpty() {
@@ -28,16 +25,26 @@ bool RGBWWLedAnimationQ::isEmpty() {
 }
 
 bool RGBWWLedAnimationQ::isFull() {
-    return _count == _size;
+    return _count >= _size || (_budget != nullptr && _budget->used >= _budget->size);
 }
 
 bool RGBWWLedAnimationQ::push(RGBWWLedAnimation* animation) {
     if (isFull())
         return false;
 
-    _count++;
-    _q[_front] = animation;
-    _front = (_front + 1) % _size;
+    animation->_next = nullptr;
+    if (_last != nullptr)
+        _last->_next = animation;
+    else
+        _first = animation;
+    _last = animation;
+
+    ++_count;
+    if (_budget != nullptr)
+        ++_budget->used;
+#ifdef RGBWW_ENABLE_PROFILING
+    _highWater = max(_highWater, _count);
+#endif
     return true;
 }
 
@@ -45,12 +52,17 @@ bool RGBWWLedAnimationQ::pushFront(RGBWWLedAnimation* animation) {
     if (isFull())
         return false;
 
-    ++_count;
-    --_back;
-    if (_back < 0)
-        _back = _size + _back;
+    animation->_next = _first;
+    _first = animation;
+    if (_last == nullptr)
+        _last = animation;
 
-    _q[_back] = animation;
+    ++_count;
+    if (_budget != nullptr)
+        ++_budget->used;
+#ifdef RGBWW_ENABLE_PROFILING
+    _highWater = max(_highWater, _count);
+#endif
     return true;
 }
 
@@ -63,21 +75,26 @@ void RGBWWLedAnimationQ::clear() {
     }
 }
 
-RGBWWLedAnimation* RGBWWLedAnimationQ::peek() {
-    if (!isEmpty()) {
-        return _q[_back];
-    }
-    return NULL;
+RGBWWLedAnimation* RGBWWLedAnimationQ::peek() const {
+    return _first;
+}
+
+RGBWWLedAnimation* RGBWWLedAnimationQ::next(const RGBWWLedAnimation* animation) {
+    return animation->_next;
 }
 
 RGBWWLedAnimation* RGBWWLedAnimationQ::pop() {
-    RGBWWLedAnimation* tmpptr;
-    if (!isEmpty()) {
-        _count--;
-        tmpptr = _q[_back];
-        _q[_back] = NULL;
-        _back = (_back + 1) % _size;
-        return tmpptr;
-    }
-    return NULL;
+    RGBWWLedAnimation* tmpptr = _first;
+    if (tmpptr == NULL)
+        return NULL;
+
+    _first = tmpptr->_next;
+    if (_first == NULL)
+        _last = NULL;
+    tmpptr->_next = NULL;
+
+    --_count;
+    if (_budget != nullptr)
+        --_budget->used;
+    return tmpptr;
 }
@@ -13,12 +13,35 @@ class RGBWWLedAnimation;
 /**
  * A simple queue implementation
  *
+ * The animations are linked into the queue directly, so the queue itself
+ * does not need any storage for its entries. The number of entries is
+ * limited per queue and optionally by a budget shared with other queues.
  */
 class RGBWWLedAnimationQ {
   public:
-    RGBWWLedAnimationQ(int qsize);
+    /**
+     * Maximum number of entries of all queues using this budget
+     */
+    struct Budget {
+        Budget(int budgetSize) : size(budgetSize) {}
+
+        int size;
+        int used = 0;
+    };
+
+    RGBWWLedAnimationQ(int qsize, Budget* budget = nullptr);
+    RGBWWLedAnimationQ(const RGBWWLedAnimationQ&) = delete;
+    RGBWWLedAnimationQ& operator=(const RGBWWLedAnimationQ&) = delete;
     ~RGBWWLedAnimationQ();
 
+    /**
+     * Draw the entries of this queue from a shared budget.
+     * Must be set while the queue is empty
+     *
+     * @param budget shared budget or nullptr to only use the queue size
+     */
+    void setBudget(Budget* budget);
+
     /**
      * Check if the queue is empty or not
      *
@@ -32,7 +55,7 @@ class RGBWWLedAnimationQ {
      * Check if the queue is full
      *
      * @return	bool
-     * @retval	true	queue is full
+     * @retval	true	queue is full or the shared budget is used up
      * @retval	false	queue is not full
      */
     bool isFull();
@@ -59,7 +82,7 @@ class RGBWWLedAnimationQ {
      *
      * @return RGBWWLedAnimation*
      */
-    RGBWWLedAnimation* peek();
+    RGBWWLedAnimation* peek() const;
 
     /**
      *	Returns first animation object pointer and removes it from queue
@@ -68,7 +91,37 @@ class RGBWWLedAnimationQ {
      */
     RGBWWLedAnimation* pop();
 
+    /**
+     * Animation following the given one in the queue
+     *
+     * @return RGBWWLedAnimation* nullptr at the end of the queue
+     */
+    static RGBWWLedAnimation* next(const RGBWWLedAnimation* animation);
+
+    int count() const {
+        return _count;
+    }
+
+#ifdef RGBWW_ENABLE_PROFILING
+    /**
+     * Maximum number of entries since the creation or resetHighWater()
+     */
+    int getHighWater() const {
+        return _highWater;
+    }
+
+    void resetHighWater() {
+        _highWater = _count;
+    }
+#endif
+
   private:
-    int _size, _count, _front, _back;
-    RGBWWLedAnimation** _q;
+    int _size = 0;
+    int _count = 0;
+    Budget* _budget = nullptr;
+    RGBWWLedAnimation* _first = nullptr;
+    RGBWWLedAnimation* _last = nullptr;
+#ifdef RGBWW_ENABLE_PROFILING
+    int _highWater = 0;
+#endif
 };
@@ -10,6 +10,231 @@
 #include "RGBWWLedColor.h"
 // clang-format on
 
+/**************************************************************
+ *                  request parsing
+ **************************************************************/
+
+namespace {
+
+bool isSeparator(char c) {
+    return c == ',' || c == ';' || c == ' ';
+}
+
+/**
+ * Split a comma separated list in place
+ *
+ * @param tokens    start of the tokens, surrounding spaces removed
+ * @param lengths   length of the tokens
+ * @return int      number of tokens, maxTokens + 1 if there are more
+ */
+int splitList(const char* str, int length, const char** tokens, int* lengths, int maxTokens) {
+    if (length <= 0)
+        return 0;
+
+    int count = 0;
+    const char* end = str + length;
+    while (true) {
+        const char* sep = static_cast<const char*>(memchr(str, ',', end - str));
+        const char* tokenEnd = (sep != nullptr) ? sep : end;
+        if (count == maxTokens)
+            return maxTokens + 1;
+
+        while (str < tokenEnd && *str == ' ')
+            ++str;
+        int len = tokenEnd - str;
+        while (len > 0 && str[len - 1] == ' ')
+            --len;
+        tokens[count] = str;
+        lengths[count++] = len;
+
+        if (sep == nullptr)
+            return count;
+        str = sep + 1;
+    }
+}
+
+/**
+ * Value of a token scaled from 0 - inputMax to 0 - outputMax, negative values are 0 and values
+ * above inputMax are outputMax. Same float math as String::toFloat() and the float constructor of HSVCT
+ */
+bool parseScaled(const char* str, int length, int inputMax, int outputMax, int& value) {
+    const bool negative = (length > 0 && *str == '-');
+    if (negative) {
+        ++str;
+        --length;
+    }
+
+    float number;
+    if (!parseDecimalFloat(str, length, number))
+        return false;
+
+    if (negative) {
+        value = 0;
+        return true;
+    }
+
+    value = int((min(double(number), double(inputMax)) / inputMax) * outputMax);
+    return true;
+}
+
+/**
+ * Integer part of a token like String::toInt()
+ */
+bool parseIntegerPart(const char* str, int length, int& value) {
+    const bool negative = (length > 0 && *str == '-');
+    if (negative) {
+        ++str;
+        --length;
+    }
+
+    int32_t mantissa;
+    int decimals;
+    if (!parseDecimal(str, length, mantissa, decimals, 0))
+        return false;
+
+    value = negative ? -mantissa : mantissa;
+    return true;
+}
+
+/**
+ * Call parseChannel of the request for every name=value entry of the list
+ */
+template <typename Request> bool parseChannelList(Request& request, const char* str, int length) {
+    const char* end = str + length;
+    while (str < end) {
+        if (isSeparator(*str)) {
+            ++str;
+            continue;
+        }
+
+        const char* entry = str;
+        while (str < end && !isSeparator(*str))
+            ++str;
+        const char* assign = static_cast<const char*>(memchr(entry, '=', str - entry));
+        if (assign == nullptr || !request.parseChannel(entry, assign - entry, assign + 1, str - assign - 1))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+ParseStatus ChannelOutput::parse(const char* str, int length) {
+    const char* tokens[5];
+    int lengths[5];
+    const int count = splitList(str, length, tokens, lengths, 5);
+    if (count == 0)
+        return ParseStatus::Empty;
+    if (count != 5)
+        return ParseStatus::TokenCount;
+
+    int values[5];
+    for (int i = 0; i < 5; ++i) {
+        if (!parseIntegerPart(tokens[i], lengths[i], values[i]))
+            return ParseStatus::Malformed;
+        values[i] = constrain(values[i], 0, RGBWW_CALC_MAXVAL);
+    }
+
+    r = values[0];
+    g = values[1];
+    b = values[2];
+    ww = values[3];
+    cw = values[4];
+    return ParseStatus::Ok;
+}
+
+ParseStatus HSVCT::parse(const char* str, int length) {
+    const char* tokens[4];
+    int lengths[4];
+    const int count = splitList(str, length, tokens, lengths, 4);
+    if (count == 0)
+        return ParseStatus::Empty;
+    if (count < 3 || count > 4)
+        return ParseStatus::TokenCount;
+
+    int hue, sat, val;
+    int colorTemp = ct;
+    if (!parseScaled(tokens[0], lengths[0], 360, RGBWW_CALC_HUEWHEELMAX, hue) ||
+        !parseScaled(tokens[1], lengths[1], 100, RGBWW_CALC_MAXVAL, sat) ||
+        !parseScaled(tokens[2], lengths[2], 100, RGBWW_CALC_MAXVAL, val))
+        return ParseStatus::Malformed;
+
+    if (count == 4 && !parseIntegerPart(tokens[3], lengths[3], colorTemp))
+        return ParseStatus::Malformed;
+
+    h = hue;
+    s = sat;
+    v = val;
+    ct = colorTemp;
+    return ParseStatus::Ok;
+}
+
+bool RequestChannelOutput::parseChannel(const char* name, int nameLength, const char* value, int valueLength) {
+    Optional<AbsOrRelValue>* channel;
+    switch (ctrlChannelFromString(name, nameLength)) {
+    case CtrlChannel::Red:
+        channel = &r;
+        break;
+    case CtrlChannel::Green:
+        channel = &g;
+        break;
+    case CtrlChannel::Blue:
+        channel = &b;
+        break;
+    case CtrlChannel::WarmWhite:
+        channel = &ww;
+        break;
+    case CtrlChannel::ColdWhite:
+        channel = &cw;
+        break;
+    default:
+        return false;
+    }
+
+    AbsOrRelValue parsed;
+    if (!AbsOrRelValue::parse(value, valueLength, AbsOrRelValue::Type::Raw, parsed))
+        return false;
+    *channel = parsed;
+    return true;
+}
+
+bool RequestChannelOutput::parse(const char* str, int length) {
+    return parseChannelList(*this, str, length);
+}
+
+bool RequestHSVCT::parseChannel(const char* name, int nameLength, const char* value, int valueLength) {
+    Optional<AbsOrRelValue>* channel;
+    AbsOrRelValue::Type type = AbsOrRelValue::Type::Percent;
+    switch (ctrlChannelFromString(name, nameLength)) {
+    case CtrlChannel::Hue:
+        channel = &h;
+        type = AbsOrRelValue::Type::Hue;
+        break;
+    case CtrlChannel::Sat:
+        channel = &s;
+        break;
+    case CtrlChannel::Val:
+        channel = &v;
+        break;
+    case CtrlChannel::ColorTemp:
+        channel = &ct;
+        type = AbsOrRelValue::Type::Ct;
+        break;
+    default:
+        return false;
+    }
+
+    AbsOrRelValue parsed;
+    if (!AbsOrRelValue::parse(value, valueLength, type, parsed))
+        return false;
+    *channel = parsed;
+    return true;
+}
+
+bool RequestHSVCT::parse(const char* str, int length) {
+    return parseChannelList(*this, str, length);
+}
+
 RGBWWColorUtils::RGBWWColorUtils() {
     _colormode = RGBWWCW;
     _hsvmodel = RAW;
@@ -19,9 +244,14 @@ RGBWWColorUtils::RGBWWColorUtils() {
     setBrightnessCorrection(100, 100, 100, 100, 100);
 }
 
+RGBWWColorUtils::~RGBWWColorUtils() {
+    delete[] _hueLut;
+}
+
 void RGBWWColorUtils::setColorMode(RGBWW_COLORMODE mode) {
     debug_d("COLORMODE %i", mode);
     _colormode = mode;
+    ++_revision;
 }
 
 RGBWW_COLORMODE RGBWWColorUtils::getColorMode() const {
@@ -32,6 +262,8 @@ RGBWW_COLORMODE RGBWWColorUtils::getColorMode() const {
 void RGBWWColorUtils::setHSVmodel(RGBWW_HSVMODEL model) {
     debug_d("HSVMODE %i", model);
     _hsvmodel = model;
+    createHueLut();
+    ++_revision;
 }
 
 RGBWW_HSVMODEL RGBWWColorUtils::getHSVmodel() const {
@@ -39,12 +271,29 @@ RGBWW_HSVMODEL RGBWWColorUtils::getHSVmodel() const {
     return _hsvmodel;
 }
 
+void RGBWWColorUtils::setHSVlut(bool enable) {
+    if (!enable) {
+        delete[] _hueLut;
+        _hueLut = nullptr;
+        return;
+    }
+
+    if (_hueLut == nullptr)
+        _hueLut = new uint16_t[RGBWW_CALC_HUEWHEELMAX];
+    createHueLut();
+}
+
+bool RGBWWColorUtils::getHSVlut() const {
+    return _hueLut != nullptr;
+}
+
 void RGBWWColorUtils::setWhiteTemperature(int WarmWhite, int ColdWhite) {
     _WarmWhiteKelvin = WarmWhite;
     _ColdWhiteKelvin = ColdWhite;
 
     AbsOrRelValue::colorTempWarm = WarmWhite;
     AbsOrRelValue::colorTempCold = ColdWhite;
+    ++_revision;
 }
 
 void RGBWWColorUtils::getWhiteTemperature(int& WarmWhite, int& ColdWhite) const {
@@ -58,6 +307,7 @@ void RGBWWColorUtils::setBrightnessCorrection(int r, int g, int b, int ww, int c
     _BrightnessFactor[RGBWW_CHANNELS::BLUE] = (constrain(b, 0, 100) * RGBWW_CALC_MAXVAL) / 100;
     _BrightnessFactor[RGBWW_CHANNELS::WW] = (constrain(ww, 0, 100) * RGBWW_CALC_MAXVAL) / 100;
     _BrightnessFactor[RGBWW_CHANNELS::CW] = (constrain(cw, 0, 100) * RGBWW_CALC_MAXVAL) / 100;
+    ++_revision;
 };
 
 void RGBWWColorUtils::getBrightnessCorrection(int& r, int& g, int& b, int& ww, int& cw) const {
@@ -68,6 +318,10 @@ void RGBWWColorUtils::getBrightnessCorrection(int& r, int& g, int& b, int& ww, i
     cw = (_BrightnessFactor[RGBWW_CHANNELS::CW] * 100) / RGBWW_CALC_MAXVAL;
 }
 
+uint32_t RGBWWColorUtils::getRevision() const {
+    return _revision;
+}
+
 void RGBWWColorUtils::correctBrightness(ChannelOutput& output) const {
     output.red = (output.red * _BrightnessFactor[RGBWW_CHANNELS::RED]) / RGBWW_CALC_MAXVAL;
     output.green = (output.green * _BrightnessFactor[RGBWW_CHANNELS::GREEN]) / RGBWW_CALC_MAXVAL;
@@ -111,6 +365,9 @@ void RGBWWColorUtils::setHSVcorrection(float red, float yellow, float green, flo
     _HueWheelSectorWidth[5] += parseColorCorrection(red);
     _HueWheelSector[6] += parseColorCorrection(red);
     _HueWheelSector[0] += parseColorCorrection(red);
+
+    createHueLut();
+    ++_revision;
 }
 
 void RGBWWColorUtils::getHSVcorrection(float& red, float& yellow, float& green, float& cyan, float& blue,
@@ -216,6 +473,11 @@ void RGBWWColorUtils::HSVtoRGB(const HSVCT& hsvk, RGBWCT& rgbwk, RGBWW_HSVMODEL
 #define rainbow_sector_width int(RGBWW_CALC_HUEWHEELMAX / 8)
 
 void RGBWWColorUtils::HSVtoRGBrainbow(const HSVCT& hsvk, RGBWCT& rgbwk) const {
+    if (hasHueLut(RAINBOW, hsvk)) {
+        HSVtoRGBrainbowLut(hsvk, rgbwk);
+        return;
+    }
+
     int val, hue, sat, r, g, b, chroma, m, sector;
 
     hue = hsvk.h;
@@ -322,6 +584,11 @@ void RGBWWColorUtils::HSVtoRGBrainbow(const HSVCT& hsvk, RGBWCT& rgbwk) const {
 }
 
 void RGBWWColorUtils::HSVtoRGBspektrum(const HSVCT& hsvk, RGBWCT& rgbwk) const {
+    if (hasHueLut(SPEKTRUM, hsvk)) {
+        HSVtoRGBspektrumLut(hsvk, rgbwk);
+        return;
+    }
+
     int val, hue, sat, r, g, b, fract, chroma, half_chroma, m;
 
     hue = hsvk.h;
@@ -425,6 +692,11 @@ void RGBWWColorUtils::HSVtoRGBspektrum(const HSVCT& hsvk, RGBWCT& rgbwk) const {
 }
 
 void RGBWWColorUtils::HSVtoRGBraw(const HSVCT& hsvk, RGBWCT& rgbwk) const {
+    if (hasHueLut(RAW, hsvk)) {
+        HSVtoRGBrawLut(hsvk, rgbwk);
+        return;
+    }
+
     int val, hue, sat, r, g, b, fract, chroma, m;
 
     hue = hsvk.h;
@@ -545,6 +817,235 @@ void RGBWWColorUtils::HSVtoRGBraw(const HSVCT& hsvk, RGBWCT& rgbwk) const {
 #endif
 }
 
+/*
+ * Table driven versions of the HSV to RGB conversions
+ *
+ * The hue dependent fraction of each sector only depends on the hue and the
+ * hue wheel. It is precomputed for every hue value, so the conversion boils
+ * down to a table lookup and scaling the fraction with the chroma.
+ *
+ * Table entries for RAW and SPEKTRUM:
+ *   bits 13 - 15: sector (1 - 6), 0 if the entry can't be represented
+ *   bits  0 - 12: (RGBWW_CALC_MAXVAL * fract) / sector width
+ *
+ * Table entries for RAINBOW:
+ *   bits 10 - 13: sector (0 - 8)
+ *   bits  1 -  9: (rainbow_third * hue) / rainbow_sector_width
+ *   bit   0     : difference of (rainbow_two_third * hue) / rainbow_sector_width
+ *                 to twice the value above
+ */
+#define HUELUT_SECTOR_SHIFT 13
+#define HUELUT_FRACT_MASK 0x1FFF
+#define HUELUT_RAINBOW_SECTOR_SHIFT 10
+
+/*
+ * x / RGBWW_CALC_MAXVAL for 0 <= x <= RGBWW_CALC_MAXVAL * RGBWW_CALC_MAXVAL without a division,
+ * the ESP8266 has no hardware divider
+ */
+static inline int divMaxVal(int x) {
+    return (x + 1 + (x >> RGBWW_CALC_DEPTH)) >> RGBWW_CALC_DEPTH;
+}
+
+bool RGBWWColorUtils::hasHueLut(RGBWW_HSVMODEL model, const HSVCT& hsvk) const {
+    if (_hueLut == nullptr || hsvk.h < 0 || hsvk.h >= RGBWW_CALC_HUEWHEELMAX)
+        return false;
+
+    // the products of the table driven version are only exact within the channel range
+    if (hsvk.s < 0 || hsvk.s > RGBWW_CALC_MAXVAL || hsvk.v < 0 || hsvk.v > RGBWW_CALC_MAXVAL)
+        return false;
+
+    if ((model == RAINBOW) != (_hueLutModel == RAINBOW))
+        return false;
+
+    // entries which do not fit into the table are calculated
+    return model == RAINBOW || (_hueLut[hsvk.h] >> HUELUT_SECTOR_SHIFT) != 0;
+}
+
+void RGBWWColorUtils::createHueLut() {
+    if (_hueLut == nullptr)
+        return;
+
+    _hueLutModel = _hsvmodel;
+
+    for (int hue = 0; hue < RGBWW_CALC_HUEWHEELMAX; ++hue) {
+        if (_hueLutModel == RAINBOW) {
+            const int sector = hue / rainbow_sector_width;
+            const int h = hue - sector * rainbow_sector_width;
+            const int third = (rainbow_third * h) / rainbow_sector_width;
+            const int twoThird = (rainbow_two_third * h) / rainbow_sector_width;
+            _hueLut[hue] = (sector << HUELUT_RAINBOW_SECTOR_SHIFT) | (third << 1) | (twoThird - 2 * third);
+            continue;
+        }
+
+        // same sector boundaries as in HSVtoRGBraw/HSVtoRGBspektrum
+        int sector, fract;
+        if (hue < _HueWheelSector[0] || (hue > _HueWheelSector[5] && hue <= _HueWheelSector[6])) {
+            sector = 6;
+            fract = (hue < _HueWheelSector[0]) ? RGBWW_CALC_MAXVAL + hue : hue - _HueWheelSector[5];
+        } else if (hue <= _HueWheelSector[1] || hue > _HueWheelSector[6]) {
+            sector = 1;
+            fract = (hue > _HueWheelSector[6]) ? hue - _HueWheelSector[6]
+                                               : hue + (RGBWW_CALC_HUEWHEELMAX - _HueWheelSector[6]);
+        } else if (hue <= _HueWheelSector[2]) {
+            sector = 2;
+            fract = hue - _HueWheelSector[1];
+        } else if (hue <= _HueWheelSector[3]) {
+            sector = 3;
+            fract = hue - _HueWheelSector[2];
+        } else if (hue <= _HueWheelSector[4]) {
+            sector = 4;
+            fract = hue - _HueWheelSector[3];
+        } else {
+            sector = 5;
+            fract = hue - _HueWheelSector[4];
+        }
+
+        // divMaxVal() needs a fraction within the channel range
+        const int q = (RGBWW_CALC_MAXVAL * fract) / _HueWheelSectorWidth[sector - 1];
+        if (q < 0 || q > RGBWW_CALC_MAXVAL) {
+            _hueLut[hue] = 0;
+            continue;
+        }
+        _hueLut[hue] = (sector << HUELUT_SECTOR_SHIFT) | q;
+    }
+}
+
+void RGBWWColorUtils::HSVtoRGBrawLut(const HSVCT& hsvk, RGBWCT& rgbwk) const {
+    const uint16_t entry = _hueLut[hsvk.h];
+    const int q = entry & HUELUT_FRACT_MASK;
+    const int chroma = divMaxVal(hsvk.s * hsvk.v);
+
+    rgbwk.ct = hsvk.ct;
+    rgbwk.w = hsvk.v - chroma;
+
+    switch (entry >> HUELUT_SECTOR_SHIFT) {
+    case 1:
+        rgbwk.r = chroma;
+        rgbwk.g = divMaxVal(chroma * q);
+        rgbwk.b = 0;
+        break;
+    case 2:
+        rgbwk.r = divMaxVal(chroma * (RGBWW_CALC_MAXVAL - q));
+        rgbwk.g = chroma;
+        rgbwk.b = 0;
+        break;
+    case 3:
+        rgbwk.r = 0;
+        rgbwk.g = chroma;
+        rgbwk.b = divMaxVal(chroma * q);
+        break;
+    case 4:
+        rgbwk.r = 0;
+        rgbwk.g = divMaxVal(chroma * (RGBWW_CALC_MAXVAL - q));
+        rgbwk.b = chroma;
+        break;
+    case 5:
+        rgbwk.r = divMaxVal(chroma * q);
+        rgbwk.g = 0;
+        rgbwk.b = chroma;
+        break;
+    default:
+        rgbwk.r = chroma;
+        rgbwk.g = 0;
+        rgbwk.b = divMaxVal(chroma * (RGBWW_CALC_MAXVAL - q));
+        break;
+    }
+}
+
+void RGBWWColorUtils::HSVtoRGBspektrumLut(const HSVCT& hsvk, RGBWCT& rgbwk) const {
+    const uint16_t entry = _hueLut[hsvk.h];
+    const int chroma = divMaxVal(hsvk.s * hsvk.v);
+    const int half_chroma = chroma >> 1;
+    const int fract = divMaxVal(half_chroma * (entry & HUELUT_FRACT_MASK));
+
+    rgbwk.w = hsvk.v - chroma;
+
+    switch (entry >> HUELUT_SECTOR_SHIFT) {
+    case 1:
+        rgbwk.r = chroma - fract;
+        rgbwk.g = fract;
+        rgbwk.b = 0;
+        break;
+    case 2:
+        rgbwk.r = half_chroma - fract;
+        rgbwk.g = half_chroma + fract;
+        rgbwk.b = 0;
+        break;
+    case 3:
+        rgbwk.r = 0;
+        rgbwk.g = chroma - fract;
+        rgbwk.b = fract;
+        break;
+    case 4:
+        rgbwk.r = 0;
+        rgbwk.g = half_chroma - fract;
+        rgbwk.b = half_chroma + fract;
+        break;
+    case 5:
+        rgbwk.r = fract;
+        rgbwk.g = 0;
+        rgbwk.b = chroma - fract;
+        break;
+    default:
+        rgbwk.r = half_chroma + fract;
+        rgbwk.g = 0;
+        rgbwk.b = half_chroma - fract;
+        break;
+    }
+}
+
+void RGBWWColorUtils::HSVtoRGBrainbowLut(const HSVCT& hsvk, RGBWCT& rgbwk) const {
+    const uint16_t entry = _hueLut[hsvk.h];
+    const int third = (entry >> 1) & 0x1FF;
+    const int twoThird = 2 * third + (entry & 1);
+    const int chroma = divMaxVal(hsvk.s * hsvk.v);
+
+    rgbwk.w = hsvk.v - chroma;
+
+    switch (entry >> HUELUT_RAINBOW_SECTOR_SHIFT) {
+    case 0:
+        rgbwk.r = divMaxVal(chroma * (RGBWW_CALC_MAXVAL - third));
+        rgbwk.g = divMaxVal(chroma * third);
+        rgbwk.b = 0;
+        break;
+    case 1:
+        rgbwk.r = divMaxVal(chroma * rainbow_two_third);
+        rgbwk.g = divMaxVal(chroma * (rainbow_third + third));
+        rgbwk.b = 0;
+        break;
+    case 2:
+        rgbwk.r = divMaxVal(chroma * (rainbow_two_third - twoThird));
+        rgbwk.g = divMaxVal(chroma * (rainbow_two_third + third));
+        rgbwk.b = 0;
+        break;
+    case 3:
+        rgbwk.r = 0;
+        rgbwk.g = divMaxVal(chroma * (RGBWW_CALC_MAXVAL - third));
+        rgbwk.b = divMaxVal(chroma * third);
+        break;
+    case 4:
+        rgbwk.r = 0;
+        rgbwk.g = divMaxVal(chroma * (rainbow_two_third - twoThird));
+        rgbwk.b = divMaxVal(chroma * (rainbow_third + twoThird));
+        break;
+    case 5:
+        rgbwk.r = divMaxVal(chroma * third);
+        rgbwk.g = 0;
+        rgbwk.b = divMaxVal(chroma * (RGBWW_CALC_MAXVAL - third));
+        break;
+    case 6:
+        rgbwk.r = divMaxVal(chroma * (rainbow_third + third));
+        rgbwk.g = 0;
+        rgbwk.b = divMaxVal(chroma * (rainbow_two_third - third));
+        break;
+    default:
+        rgbwk.r = divMaxVal(chroma * (rainbow_two_third + third));
+        rgbwk.g = 0;
+        rgbwk.b = divMaxVal(chroma * (rainbow_third - third));
+        break;
+    }
+}
+
 void RGBWWColorUtils::RGBtoHSV(const RGBWCT& rgbw, HSVCT& hsv) const {
     debug_d("RGBWWColorUtils::RGBtoHSV");
     // TODO: needs implementation
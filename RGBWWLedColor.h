@@ -16,6 +16,16 @@ enum RGBWW_HSVMODEL { RAW = 0, SPEKTRUM = 1, RAINBOW = 2, NUM_HSVMODELS = 3 };
 
 enum RGBWW_CHANNELS { RED = 0, GREEN = 1, BLUE = 2, WW = 3, CW = 4, NUM_CHANNELS = 5 };
 
+/**
+ * Result of parsing a color from a string
+ */
+enum class ParseStatus {
+    Ok,
+    Empty,      // no input
+    TokenCount, // wrong number of comma separated values
+    Malformed,  // a value is not a number
+};
+
 // struct for RGBW + Kelvin
 struct RGBWCT {
 
@@ -96,22 +106,21 @@ struct ChannelOutput {
     }
 
     ChannelOutput& operator=(String& channelStr) {
-        Vector<String> tokens;
-        splitString(channelStr, ',', tokens);
-
-        if (tokens.size() != 5) {
+        if (parse(channelStr.c_str(), channelStr.length()) != ParseStatus::Ok)
             debug_e("ChannelOutput::setFromString - Invalid input string: %s", channelStr.c_str());
-            return *this;
-        }
-
-        this->r = constrain(tokens[0].toInt(), 0, 1023);
-        this->g = constrain(tokens[1].toInt(), 0, 1023);
-        this->b = constrain(tokens[2].toInt(), 0, 1023);
-        this->ww = constrain(tokens[3].toInt(), 0, 1023);
-        this->cw = constrain(tokens[4].toInt(), 0, 1023);
         return *this;
     }
 
+    /**
+     * Set the channels from "r,g,b,ww,cw" (0 - 1023) without allocations.
+     * Values are cut off like String::toInt() and clamped to 0 - 1023, numbers have at most 9 digits
+     *
+     * @param str       does not need to be terminated
+     * @param length    characters of str
+     * @return ParseStatus, the channels are only changed with ParseStatus::Ok
+     */
+    ParseStatus parse(const char* str, int length);
+
     bool operator==(const ChannelOutput& output) const {
         return r == output.r && g == output.g && b == output.b && ww == output.ww && cw == output.cw;
     }
@@ -197,23 +206,22 @@ struct HSVCT {
     }
 
     HSVCT& operator=(String& colorStr) {
-        Vector<String> tokens;
-        splitString(colorStr, ',', tokens);
-
-        if (tokens.size() < 3 || tokens.size() > 4) {
+        if (parse(colorStr.c_str(), colorStr.length()) != ParseStatus::Ok)
             debug_e("HSVCT::setFromString - Invalid input string: %s", colorStr.c_str());
-            return *this;
-        }
-
-        this->h = (constrain(tokens[0].toFloat(), 0.0, 360.0) / 360) * RGBWW_CALC_HUEWHEELMAX;
-        this->s = (constrain(tokens[1].toFloat(), 0.0, 100.0) / 100) * RGBWW_CALC_MAXVAL;
-        this->v = (constrain(tokens[2].toFloat(), 0.0, 100.0) / 100) * RGBWW_CALC_MAXVAL;
-
-        if (tokens.size() > 3)
-            this->colortemp = tokens[3].toInt();
         return *this;
     }
 
+    /**
+     * Set the color from "h,s,v" or "h,s,v,ct" (h in degree, s and v in percent) without allocations.
+     * h, s and v are read like String::toFloat(), clamped and scaled like the float constructor,
+     * numbers have at most 9 digits. ct is cut off like String::toInt()
+     *
+     * @param str       does not need to be terminated
+     * @param length    characters of str
+     * @return ParseStatus, the color is only changed with ParseStatus::Ok
+     */
+    ParseStatus parse(const char* str, int length);
+
     void asRadian(float& hue, float& sat, float& val) const {
         hue = (float(h) / float(RGBWW_CALC_HUEWHEELMAX)) * 360.0;
         sat = (float(s) / float(RGBWW_CALC_MAXVAL)) * 100.0;
@@ -261,6 +269,22 @@ struct RequestChannelOutput {
         this->ww = ch.ww;
         return *this;
     }
+
+    /**
+     * Set one channel from a parameter without allocations, see AbsOrRelValue::parse().
+     * Channels are r, g, b, ww and cw with raw values (0 - 1023)
+     *
+     * @retval false unknown channel or malformed value
+     */
+    bool parseChannel(const char* name, int nameLength, const char* value, int valueLength);
+
+    /**
+     * Set the channels from a list like "r=1023,g=+10,ww=0" (separated by ',', ';' or ' ').
+     * The channels before a malformed entry are set
+     *
+     * @retval false unknown channel or malformed value
+     */
+    bool parse(const char* str, int length);
 };
 
 struct RequestHSVCT {
@@ -294,6 +318,22 @@ struct RequestHSVCT {
         return *this;
     }
 
+    /**
+     * Set one channel from a parameter without allocations, see AbsOrRelValue::parse().
+     * Channels are h (degree), s and v (percent) and ct
+     *
+     * @retval false unknown channel or malformed value
+     */
+    bool parseChannel(const char* name, int nameLength, const char* value, int valueLength);
+
+    /**
+     * Set the channels from a list like "h=120,s=100,v=+10" (separated by ',', ';' or ' ').
+     * The channels before a malformed entry are set
+     *
+     * @retval false unknown channel or malformed value
+     */
+    bool parse(const char* str, int length);
+
     operator HSVCT() {
         HSVCT c;
         c.h = h.getValue();
@@ -326,7 +366,9 @@ class RGBWWColorUtils {
 
   public:
     RGBWWColorUtils();
-    virtual ~RGBWWColorUtils(){};
+    RGBWWColorUtils(const RGBWWColorUtils&) = delete;
+    RGBWWColorUtils& operator=(const RGBWWColorUtils&) = delete;
+    virtual ~RGBWWColorUtils();
 
     /**
      * Set the output setting of the controler.
@@ -358,6 +400,25 @@ class RGBWWColorUtils {
      */
     RGBWW_HSVMODEL getHSVmodel() const;
 
+    /**
+     * Enable the table driven HSV to RGB conversion.
+     * The hue dependent part of the conversion is precomputed for the whole
+     * hue wheel and rebuilt whenever the HSV model or HSV correction changes,
+     * a conversion is then a table lookup and two multiplications without division.
+     * Results are identical to the calculated conversion.
+     * The table needs RGBWW_CALC_HUEWHEELMAX * 2 bytes of RAM
+     *
+     * @param enable
+     */
+    void setHSVlut(bool enable);
+
+    /**
+     * Check if the table driven HSV to RGB conversion is active
+     *
+     * @return bool
+     */
+    bool getHSVlut() const;
+
     /**
      * Set the color temperature for warm/cold white channel in kelvin
      *
@@ -429,6 +490,15 @@ class RGBWWColorUtils {
      */
     void getBrightnessCorrection(int& r, int& g, int& b, int& ww, int& cw) const;
 
+    /**
+     * Revision of the settings. Changes whenever a setting which affects
+     * the conversion result is changed (color mode, HSV model, HSV correction,
+     * white temperature or brightness correction)
+     *
+     * @return uint32_t
+     */
+    uint32_t getRevision() const;
+
     /**
      * Applies the white colortemperature
      *
@@ -495,6 +565,41 @@ class RGBWWColorUtils {
      */
     void HSVtoRGBrainbow(const HSVCT& hsvk, RGBWCT& rgbwk) const;
 
+    /**
+     * Convert an array of HSVK values to RGBK colorspace
+     * Same result as calling HSVtoRGB() for every element. The RAW model
+     * converts four colors at once if the target supports SSE2
+     *
+     * @param hsvk		array of HSVK values
+     * @param rgbwk		array to hold the results
+     * @param count		number of elements
+     */
+    void HSVtoRGB(const HSVCT* hsvk, RGBWCT* rgbwk, int count) const;
+
+    /**
+     * Convert HSVK values stored in separate arrays (structure of arrays) to RGBK colorspace
+     * Same result as calling HSVtoRGB() for every element, without copying the arrays
+     * for the SSE2 kernel of the RAW model
+     *
+     * @param hue		array of hue values
+     * @param sat		array of saturation values
+     * @param val		array of values
+     * @param ct		array of color temperatures
+     * @param rgbwk		array to hold the results
+     * @param count		number of elements
+     */
+    void HSVtoRGB(const int* hue, const int* sat, const int* val, const int* ct, RGBWCT* rgbwk, int count) const;
+
+    /**
+     * Convert an array of HSVK values to channel output.
+     * Applies HSVtoRGB, whiteBalance and correctBrightness
+     *
+     * @param hsvk		array of HSVK values
+     * @param output	array to hold the results
+     * @param count		number of elements
+     */
+    void HSVtoOutput(const HSVCT* hsvk, ChannelOutput* output, int count) const;
+
     /**
      *
      * @param rgbwk
@@ -519,6 +624,21 @@ class RGBWWColorUtils {
     RGBWW_COLORMODE _colormode;
     RGBWW_HSVMODEL _hsvmodel;
 
+    uint32_t _revision = 0;
+
+    uint16_t* _hueLut = nullptr;
+    RGBWW_HSVMODEL _hueLutModel = RAW;
+
     static int parseColorCorrection(float val);
     void createHueWheel();
+    void createHueLut();
+
+    bool hasHueLut(RGBWW_HSVMODEL model, const HSVCT& hsvk) const;
+    void HSVtoRGBrawLut(const HSVCT& hsvk, RGBWCT& rgbwk) const;
+    void HSVtoRGBspektrumLut(const HSVCT& hsvk, RGBWCT& rgbwk) const;
+    void HSVtoRGBrainbowLut(const HSVCT& hsvk, RGBWCT& rgbwk) const;
+
+    // converts the leading multiple of four colors, returns their number (0 without SSE2)
+    int HSVtoRGBrawKernel(const int* hue, const int* sat, const int* val, const int* ct, RGBWCT* rgbwk,
+                          int count) const;
 };
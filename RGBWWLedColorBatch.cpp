@@ -0,0 +1,241 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ *
+ * Batch conversion of colors. On targets with SSE2 the RAW model converts
+ * four colors at once, other targets (i.e. the ESP8266) convert one color
+ * after the other with the single conversion.
+ */
+// clang-format off
+#include "RGBWWLed.h"
+#include "RGBWWLedColor.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define RGBWW_BATCH_SSE2
+#endif
+// clang-format on
+
+namespace {
+
+// colors converted per chunk when converting arrays of structs
+const int BatchChunkSize = 32;
+
+} // namespace
+
+#ifdef RGBWW_BATCH_SSE2
+
+namespace {
+
+// r, g, b and w of a color are stored with one 16 byte store
+static_assert(offsetof(RGBWCT, g) == offsetof(RGBWCT, r) + sizeof(int) &&
+                  offsetof(RGBWCT, b) == offsetof(RGBWCT, r) + 2 * sizeof(int) &&
+                  offsetof(RGBWCT, w) == offsetof(RGBWCT, r) + 3 * sizeof(int),
+              "RGBWCT layout");
+
+inline __m128i select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// product of two values within 0 - 32767
+inline __m128i mul16(__m128i a, __m128i b) {
+    return _mm_madd_epi16(a, b);
+}
+
+// x / RGBWW_CALC_MAXVAL for 0 <= x <= RGBWW_CALC_MAXVAL^2, see divMaxVal() in RGBWWLedColor.cpp
+inline __m128i divMaxVal(__m128i x) {
+    const __m128i t = _mm_add_epi32(_mm_add_epi32(x, _mm_set1_epi32(1)), _mm_srai_epi32(x, RGBWW_CALC_DEPTH));
+    return _mm_srai_epi32(t, RGBWW_CALC_DEPTH);
+}
+
+} // namespace
+
+/*
+ * Branch free version of HSVtoRGBraw() for four colors at once.
+ *
+ * The sector of every lane is selected with masks in the reverse order of the
+ * if/else chain of HSVtoRGBraw(), so the first matching sector wins like there.
+ * The divisions by RGBWW_CALC_MAXVAL use divMaxVal(), which is exact for products of
+ * two channel values. The division by the sector width is done in single precision
+ * float: RGBWW_CALC_MAXVAL * fract stays below 2^24 for the hues accepted here, so
+ * the float division truncated towards zero equals the integer division.
+ * Lanes outside of these ranges are converted with HSVtoRGBraw().
+ */
+int RGBWWColorUtils::HSVtoRGBrawKernel(const int* hue, const int* sat, const int* val, const int* ct,
+                                       RGBWCT* rgbwk, int count) const {
+    const __m128i maxVal = _mm_set1_epi32(RGBWW_CALC_MAXVAL);
+    // values within 0 - RGBWW_CALC_MAXVAL have none of these bits set
+    const __m128i outOfRange = _mm_set1_epi32(~RGBWW_CALC_MAXVAL);
+    const __m128i minHue = _mm_set1_epi32(-RGBWW_CALC_HUEWHEELMAX - 1);
+    const __m128i maxHue = _mm_set1_epi32(2 * RGBWW_CALC_HUEWHEELMAX);
+    const __m128 maxValF = _mm_set1_ps(float(RGBWW_CALC_MAXVAL));
+
+    __m128i sector[7];
+    __m128i width[6];
+    for (int i = 0; i < 7; ++i)
+        sector[i] = _mm_set1_epi32(_HueWheelSector[i]);
+    for (int i = 0; i < 6; ++i)
+        width[i] = _mm_set1_epi32(_HueWheelSectorWidth[i]);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hue + i));
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sat + i));
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(val + i));
+
+        const __m128i chroma = divMaxVal(mul16(s, v));
+
+        // sector 5, then the sectors before it where the hue is not above their end
+        __m128i sec = _mm_set1_epi32(5);
+        __m128i fract = _mm_sub_epi32(h, sector[4]);
+        __m128i w = width[4];
+
+        __m128i above = _mm_cmpgt_epi32(h, sector[4]);
+        sec = select(above, sec, _mm_set1_epi32(4));
+        fract = select(above, fract, _mm_sub_epi32(h, sector[3]));
+        w = select(above, w, width[3]);
+
+        above = _mm_cmpgt_epi32(h, sector[3]);
+        sec = select(above, sec, _mm_set1_epi32(3));
+        fract = select(above, fract, _mm_sub_epi32(h, sector[2]));
+        w = select(above, w, width[2]);
+
+        above = _mm_cmpgt_epi32(h, sector[2]);
+        sec = select(above, sec, _mm_set1_epi32(2));
+        fract = select(above, fract, _mm_sub_epi32(h, sector[1]));
+        w = select(above, w, width[1]);
+
+        const __m128i above6 = _mm_cmpgt_epi32(h, sector[6]);
+        __m128i mask = _mm_or_si128(_mm_andnot_si128(_mm_cmpgt_epi32(h, sector[1]), _mm_set1_epi32(-1)), above6);
+        sec = select(mask, _mm_set1_epi32(1), sec);
+        fract = select(mask,
+                       select(above6, _mm_sub_epi32(h, sector[6]),
+                              _mm_add_epi32(h, _mm_sub_epi32(_mm_set1_epi32(RGBWW_CALC_HUEWHEELMAX), sector[6]))),
+                       fract);
+        w = select(mask, width[0], w);
+
+        const __m128i below0 = _mm_cmplt_epi32(h, sector[0]);
+        mask = _mm_or_si128(below0, _mm_andnot_si128(above6, _mm_cmpgt_epi32(h, sector[5])));
+        sec = select(mask, _mm_set1_epi32(6), sec);
+        fract = select(mask, select(below0, _mm_add_epi32(maxVal, h), _mm_sub_epi32(h, sector[5])), fract);
+        w = select(mask, width[5], w);
+
+        // (RGBWW_CALC_MAXVAL * fract) / width
+        const __m128 qf = _mm_div_ps(_mm_mul_ps(_mm_cvtepi32_ps(fract), maxValF), _mm_cvtepi32_ps(w));
+        const __m128i q = _mm_cvttps_epi32(qf);
+
+        __m128i valid = _mm_and_si128(_mm_cmpgt_epi32(h, minHue), _mm_cmplt_epi32(h, maxHue));
+        const __m128i ranges = _mm_and_si128(_mm_or_si128(_mm_or_si128(s, v), q), outOfRange);
+        valid = _mm_and_si128(valid, _mm_cmpeq_epi32(ranges, _mm_setzero_si128()));
+
+        // sectors 1, 3 and 5 rise, 2, 4 and 6 fall
+        const __m128i rising = _mm_cmpeq_epi32(_mm_and_si128(sec, _mm_set1_epi32(1)), _mm_set1_epi32(1));
+        const __m128i x = divMaxVal(mul16(chroma, select(rising, q, _mm_sub_epi32(maxVal, q))));
+
+        // sector:   1  2  3  4  5  6
+        // red:      C  X  0  0  X  C
+        // green:    X  C  C  X  0  0
+        // blue:     0  0  X  C  C  X
+        const __m128i sec1 = _mm_cmpeq_epi32(sec, _mm_set1_epi32(1));
+        const __m128i sec2 = _mm_cmpeq_epi32(sec, _mm_set1_epi32(2));
+        const __m128i sec3 = _mm_cmpeq_epi32(sec, _mm_set1_epi32(3));
+        const __m128i sec4 = _mm_cmpeq_epi32(sec, _mm_set1_epi32(4));
+        const __m128i sec5 = _mm_cmpeq_epi32(sec, _mm_set1_epi32(5));
+        const __m128i sec6 = _mm_cmpeq_epi32(sec, _mm_set1_epi32(6));
+        const __m128i r = _mm_or_si128(_mm_and_si128(_mm_or_si128(sec1, sec6), chroma),
+                                       _mm_and_si128(_mm_or_si128(sec2, sec5), x));
+        const __m128i g = _mm_or_si128(_mm_and_si128(_mm_or_si128(sec2, sec3), chroma),
+                                       _mm_and_si128(_mm_or_si128(sec1, sec4), x));
+        const __m128i b = _mm_or_si128(_mm_and_si128(_mm_or_si128(sec4, sec5), chroma),
+                                       _mm_and_si128(_mm_or_si128(sec3, sec6), x));
+
+        const __m128i m = _mm_sub_epi32(v, chroma);
+        const int validLanes = _mm_movemask_ps(_mm_castsi128_ps(valid));
+        if (validLanes == 0xf) {
+            // transpose to r, g, b, w of each color
+            const __m128i rg01 = _mm_unpacklo_epi32(r, g);
+            const __m128i rg23 = _mm_unpackhi_epi32(r, g);
+            const __m128i bw01 = _mm_unpacklo_epi32(b, m);
+            const __m128i bw23 = _mm_unpackhi_epi32(b, m);
+            const __m128i colors[4] = {_mm_unpacklo_epi64(rg01, bw01), _mm_unpackhi_epi64(rg01, bw01),
+                                       _mm_unpacklo_epi64(rg23, bw23), _mm_unpackhi_epi64(rg23, bw23)};
+            for (int l = 0; l < 4; ++l) {
+                RGBWCT& out = rgbwk[i + l];
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&out.r), colors[l]);
+                out.ct = ct[i + l];
+            }
+            continue;
+        }
+
+        alignas(16) int lanes[4][4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes[0]), r);
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes[1]), g);
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes[2]), b);
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes[3]), m);
+        for (int l = 0; l < 4; ++l) {
+            RGBWCT& out = rgbwk[i + l];
+            if (validLanes & (1 << l)) {
+                out.r = lanes[0][l];
+                out.g = lanes[1][l];
+                out.b = lanes[2][l];
+                out.w = lanes[3][l];
+                out.ct = ct[i + l];
+            } else {
+                HSVtoRGBraw(HSVCT(hue[i + l], sat[i + l], val[i + l], ct[i + l]), out);
+            }
+        }
+    }
+    return i;
+}
+
+#else
+
+int RGBWWColorUtils::HSVtoRGBrawKernel(const int* hue, const int* sat, const int* val, const int* ct,
+                                       RGBWCT* rgbwk, int count) const {
+    return 0;
+}
+
+#endif
+
+void RGBWWColorUtils::HSVtoRGB(const HSVCT* hsvk, RGBWCT* rgbwk, int count) const {
+#ifdef RGBWW_BATCH_SSE2
+    if (_hsvmodel == RAW) {
+        int hue[BatchChunkSize], sat[BatchChunkSize], val[BatchChunkSize], ct[BatchChunkSize];
+        for (int i = 0; i < count; i += BatchChunkSize) {
+            const int n = min(count - i, BatchChunkSize);
+            for (int j = 0; j < n; ++j) {
+                hue[j] = hsvk[i + j].h;
+                sat[j] = hsvk[i + j].s;
+                val[j] = hsvk[i + j].v;
+                ct[j] = hsvk[i + j].ct;
+            }
+            HSVtoRGB(hue, sat, val, ct, rgbwk + i, n);
+        }
+        return;
+    }
+#endif
+    for (int i = 0; i < count; ++i)
+        HSVtoRGB(hsvk[i], rgbwk[i]);
+}
+
+void RGBWWColorUtils::HSVtoRGB(const int* hue, const int* sat, const int* val, const int* ct, RGBWCT* rgbwk,
+                               int count) const {
+    int i = (_hsvmodel == RAW) ? HSVtoRGBrawKernel(hue, sat, val, ct, rgbwk, count) : 0;
+    for (; i < count; ++i)
+        HSVtoRGB(HSVCT(hue[i], sat[i], val[i], ct[i]), rgbwk[i]);
+}
+
+void RGBWWColorUtils::HSVtoOutput(const HSVCT* hsvk, ChannelOutput* output, int count) const {
+    RGBWCT rgbwk[BatchChunkSize];
+    for (int i = 0; i < count; i += BatchChunkSize) {
+        const int n = min(count - i, BatchChunkSize);
+        HSVtoRGB(hsvk + i, rgbwk, n);
+        for (int j = 0; j < n; ++j) {
+            whiteBalance(rgbwk[j], output[i + j]);
+            correctBrightness(output[i + j]);
+        }
+    }
+}
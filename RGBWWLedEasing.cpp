@@ -0,0 +1,80 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+#include "RGBWWLedEasing.h"
+
+namespace {
+
+// compile time math for the table generation (C++11 constexpr, series expansions)
+
+constexpr double cube(double x) {
+    return x * x * x;
+}
+
+constexpr double expSeries(double x, double term, int n) {
+    return (n > 40) ? 0.0 : term + expSeries(x, term * x / n, n + 1);
+}
+
+constexpr double exponential(double x) {
+    return expSeries(x, 1.0, 1);
+}
+
+constexpr double cosSeries(double x2, double term, int k) {
+    return (k > 20) ? 0.0 : term + cosSeries(x2, -term * x2 / ((2 * k + 1) * (2 * k + 2)), k + 1);
+}
+
+constexpr double cosine(double x) {
+    return cosSeries(x * x, 1.0, 0);
+}
+
+constexpr double curve(Easing easing, double x) {
+    return (easing == Easing::In)    ? cube(x)
+           : (easing == Easing::Out) ? 1.0 - cube(1.0 - x)
+           : (easing == Easing::InOut)
+               ? ((x < 0.5) ? 4.0 * cube(x) : 1.0 - 4.0 * cube(1.0 - x))
+               // 2^(10x) normalized to 0 .. 1
+               : (easing == Easing::Exponential) ? (exponential(6.931471805599453 * x) - 1.0) / 1023.0
+                                                 : (1.0 - cosine(3.141592653589793 * x)) / 2.0;
+}
+
+constexpr uint16_t entry(Easing easing, int i) {
+    return uint16_t(curve(easing, double(i) / RGBWWEasing::Segments) * 65535.0 + 0.5);
+}
+
+template <int... I> struct Indices {};
+template <int N, int... I> struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+template <int... I> struct MakeIndices<0, I...> {
+    typedef Indices<I...> type;
+};
+
+template <int... I> constexpr RGBWWEasing::Table makeTable(Easing easing, Indices<I...>) {
+    return RGBWWEasing::Table{{entry(easing, I)...}};
+}
+
+constexpr RGBWWEasing::Table makeTable(Easing easing) {
+    return makeTable(easing, MakeIndices<RGBWWEasing::Segments + 1>::type());
+}
+
+static_assert(makeTable(Easing::In).values[0] == 0, "curves start at 0");
+static_assert(makeTable(Easing::Sine).values[RGBWWEasing::Segments] == 65535, "curves end at 65535");
+static_assert(makeTable(Easing::Exponential).values[RGBWWEasing::Segments] == 65535, "curves end at 65535");
+
+} // namespace
+
+// constant initialized, the tables are calculated by the compiler
+const RGBWWEasing::Table RGBWWEasing::_tables[static_cast<int>(Easing::Sine)] = {
+    makeTable(Easing::In), makeTable(Easing::Out), makeTable(Easing::InOut), makeTable(Easing::Exponential),
+    makeTable(Easing::Sine)};
+
+int RGBWWEasing::slope(Easing easing, int position) {
+    if (easing == Easing::Linear)
+        return One;
+
+    const uint16_t* table = _tables[static_cast<int>(easing) - 1].values;
+    const int segment = constrain(position >> SegmentShift, 0, Segments - 1);
+    return (table[segment + 1] - table[segment]) * Segments;
+}
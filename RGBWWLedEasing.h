@@ -0,0 +1,74 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite LEDs via PWM
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+
+#pragma once
+
+#include "RGBWWconst.h"
+
+/**
+ * Shape of a transition
+ */
+enum class Easing {
+    Linear,
+    In,          // cubic, slow start
+    Out,         // cubic, slow end
+    InOut,       // cubic, slow start and end
+    Exponential, // exponential rise, perceived as even for brightness
+    Sine,        // sine, slow start and end
+};
+
+/**
+ * Easing curves as fixed point tables.
+ *
+ * The tables are generated at compile time. At runtime an eased position
+ * costs one table segment lookup and a multiply, without float math.
+ */
+class RGBWWEasing {
+  public:
+    // position and eased position are fixed point with 16 fractional bits (0 .. One)
+    static const int One = 1 << 16;
+
+    // segments of each table, the eased position is interpolated within a segment
+    static const int Segments = 64;
+
+    // eased positions at the segment borders, scaled to 0 .. 65535
+    struct Table {
+        uint16_t values[Segments + 1];
+    };
+
+    /**
+     * Eased position
+     *
+     * @param easing    curve, Linear returns the position unchanged
+     * @param position  0 .. One
+     * @return int      0 .. One
+     */
+    static int ease(Easing easing, int position) {
+        if (easing == Easing::Linear || position <= 0 || position >= One)
+            return constrain(position, 0, One);
+
+        const uint16_t* table = _tables[static_cast<int>(easing) - 1].values;
+        const int segment = position >> SegmentShift;
+        const int offset = position & (SegmentWidth - 1);
+        return table[segment] + (((table[segment + 1] - table[segment]) * offset) >> SegmentShift);
+    }
+
+    /**
+     * Slope of the curve at the given position, relative to a linear ramp (One = same slope)
+     */
+    static int slope(Easing easing, int position);
+
+    // width of a segment in positions
+    static const int SegmentWidth = One / Segments;
+
+  private:
+    static const int SegmentShift = 10;
+
+    // one table per curve except Linear
+    static const Table _tables[static_cast<int>(Easing::Sine)];
+};
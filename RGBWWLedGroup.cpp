@@ -0,0 +1,274 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include "RGBWWLedGroup.h"
+#include "RGBWWLedAnimation.h"
+// clang-format on
+
+RGBWWLedGroup::RGBWWLedGroup() {}
+
+RGBWWLedGroup::~RGBWWLedGroup() {
+    freeState();
+}
+
+void RGBWWLedGroup::freeState() {
+    delete[] _state;
+    delete[] _currentStep;
+    delete[] _stepsTotal;
+    delete[] _flags;
+    delete[] _changed;
+    delete[] _output;
+    _state = nullptr;
+    _currentStep = nullptr;
+    _stepsTotal = nullptr;
+    _flags = nullptr;
+    _changed = nullptr;
+    _output = nullptr;
+    _size = 0;
+}
+
+bool RGBWWLedGroup::init(int fixtures) {
+    if (_size != 0 || fixtures <= 0)
+        return false;
+
+    _state = new int[NumFields * NumChannels * fixtures];
+    _currentStep = new int[fixtures];
+    _stepsTotal = new int[fixtures];
+    _flags = new uint8_t[fixtures];
+    _changed = new int[fixtures];
+    _output = new ChannelOutput[fixtures];
+    if (_state == nullptr || _currentStep == nullptr || _stepsTotal == nullptr || _flags == nullptr ||
+        _changed == nullptr || _output == nullptr) {
+        freeState();
+        return false;
+    }
+
+    _size = fixtures;
+    memset(_state, 0, sizeof(int) * NumFields * NumChannels * fixtures);
+    memset(_currentStep, 0, sizeof(int) * fixtures);
+    memset(_stepsTotal, 0, sizeof(int) * fixtures);
+    // convert all fixtures in the first frame
+    memset(_flags, FlagDirty, fixtures);
+    _shownRevision = colorutils.getRevision();
+    return true;
+}
+
+bool RGBWWLedGroup::setFrameInterval(int interval) {
+    if (interval <= 0 || interval % RGBWW_STEPTIME != 0)
+        return false;
+
+    _frameSteps = interval / RGBWW_STEPTIME;
+    return true;
+}
+
+RGBWWLedGroup::FrameResult RGBWWLedGroup::show() {
+    FrameResult result;
+
+    for (int i = 0; i < _size; ++i) {
+        if (_flags[i] & FlagActive)
+            _currentStep[i] += _frameSteps;
+    }
+
+    for (int ch = 0; ch < NumChannels; ++ch) {
+        stepChannel(static_cast<Channel>(ch), _frameSteps);
+    }
+
+    // changed settings affect every fixture
+    const bool convertAll = colorutils.getRevision() != _shownRevision;
+    _shownRevision = colorutils.getRevision();
+
+    int changed = 0;
+    for (int i = 0; i < _size; ++i) {
+        uint8_t& flags = _flags[i];
+        if ((flags & FlagActive) && _currentStep[i] >= _stepsTotal[i]) {
+            flags &= ~FlagActive;
+            ++result.animFinished;
+            onAnimationFinished(i);
+        }
+        if (convertAll || (flags & FlagDirty)) {
+            flags &= ~FlagDirty;
+            _changed[changed++] = i;
+        }
+    }
+
+    convert(_changed, changed);
+    for (int k = 0; k < changed; ++k) {
+        const int i = _changed[k];
+        ++result.outputChanged;
+        onOutputChanged(i, _output[i]);
+    }
+
+    return result;
+}
+
+void RGBWWLedGroup::stepChannel(Channel ch, int steps) {
+    int* value = column(Value, ch);
+    const int* base = column(Base, ch);
+    const int* final = column(Final, ch);
+    const int* delta = column(Delta, ch);
+    int* error = column(Error, ch);
+    int* count = column(Count, ch);
+    const int* step = column(Step, ch);
+    const int* stepsFade = column(StepsFade, ch);
+    const int* stepsTotal = column(StepsTotal, ch);
+
+    for (int i = 0; i < _size; ++i) {
+        if (!(_flags[i] & FlagActive))
+            continue;
+
+        const int currentStep = _currentStep[i];
+        int v;
+        if (currentStep >= stepsTotal[i]) {
+            // arrive at the destination with the last step
+            v = final[i];
+        } else {
+            // same as AnimTransition::advance(): the fade is calculated for the steps 1 .. StepsFade - 1
+            const int calls = min(currentStep, stepsFade[i] - 1) - max(min(currentStep - steps, stepsFade[i] - 1), 0);
+            if (calls <= 0)
+                continue;
+
+            BresenhamValues bresenham;
+            bresenham.delta = delta[i];
+            bresenham.error = error[i];
+            bresenham.count = count[i];
+            bresenham.step = step[i];
+            v = AnimTransition::bresenhamAdvance(bresenham, stepsFade[i], base[i], value[i], calls);
+            error[i] = bresenham.error;
+            count[i] = bresenham.count;
+        }
+
+        if (ch == Hue)
+            RGBWWColorUtils::circleHue(v);
+
+        if (v != value[i]) {
+            value[i] = v;
+            _flags[i] |= FlagDirty;
+        }
+    }
+}
+
+void RGBWWLedGroup::convert(const int* fixtures, int count) {
+    const int* hue = column(Value, Hue);
+    const int* sat = column(Value, Sat);
+    const int* val = column(Value, Val);
+    const int* ct = column(Value, ColorTemp);
+
+    // the colors of the fixtures are gathered into arrays for the batch conversion of RGBWWColorUtils
+    int h[ConvertChunkSize], s[ConvertChunkSize], v[ConvertChunkSize], t[ConvertChunkSize];
+    RGBWCT rgbwk[ConvertChunkSize];
+    for (int k = 0; k < count; k += ConvertChunkSize) {
+        const int n = min(count - k, int(ConvertChunkSize));
+        for (int j = 0; j < n; ++j) {
+            const int i = fixtures[k + j];
+            h[j] = hue[i];
+            s[j] = sat[i];
+            v[j] = val[i];
+            t[j] = ct[i];
+        }
+        colorutils.HSVtoRGB(h, s, v, t, rgbwk, n);
+
+        for (int j = 0; j < n; ++j) {
+            ChannelOutput& output = _output[fixtures[k + j]];
+            colorutils.whiteBalance(rgbwk[j], output);
+            colorutils.correctBrightness(output);
+        }
+    }
+}
+
+void RGBWWLedGroup::colorDirectHSV(int fixture, const RequestHSVCT& color) {
+    if (!isValidFixture(fixture))
+        return;
+
+    const Optional<AbsOrRelValue>* request[NumChannels] = {&color.h, &color.s, &color.v, &color.ct};
+    for (int ch = 0; ch < NumChannels; ++ch) {
+        if (!request[ch]->hasValue())
+            continue;
+
+        int& value = column(Value, static_cast<Channel>(ch))[fixture];
+        value = request[ch]->getValue().getFinalValue(value);
+    }
+
+    // also stops a running transition
+    _flags[fixture] = FlagDirty;
+}
+
+bool RGBWWLedGroup::fadeHSV(int fixture, const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay,
+                            HueTransitionDirection direction) {
+    if (!isValidFixture(fixture))
+        return false;
+
+    const Optional<AbsOrRelValue>* request[NumChannels] = {&color.h, &color.s, &color.v, &color.ct};
+    if (!request[Hue]->hasValue() && !request[Sat]->hasValue() && !request[Val]->hasValue() &&
+        !request[ColorTemp]->hasValue()) {
+        return false;
+    }
+
+    const int stayCount = static_cast<int>(stay / RGBWW_STEPTIME);
+    int stepsTotal = 0;
+    for (int c = 0; c < NumChannels; ++c) {
+        const Channel ch = static_cast<Channel>(c);
+        const int current = column(Value, ch)[fixture];
+
+        int final = current;
+        int steps = 1;
+        int delta = 0;
+        int dir = 1;
+        int total = 0;
+        if (request[ch]->hasValue()) {
+            final = request[ch]->getValue().getFinalValue(current);
+            if (ch == Hue) {
+                dir = AnimTransitionCircularHue::calcDirection(current, final, direction, delta);
+                steps = AnimTransitionCircularHue::calcStepsNeeded(ramp, current, final, dir);
+            } else {
+                delta = abs(current - final);
+                dir = (current > final) ? -1 : 1;
+                steps = AnimTransition::calcStepsNeeded(ramp, current, final);
+            }
+            total = steps + stayCount;
+        }
+
+        BresenhamValues bresenham;
+        AnimTransition::initBresenham(bresenham, delta, dir, steps);
+
+        column(Base, ch)[fixture] = current;
+        column(Final, ch)[fixture] = final;
+        column(Delta, ch)[fixture] = bresenham.delta;
+        column(Error, ch)[fixture] = bresenham.error;
+        column(Count, ch)[fixture] = bresenham.count;
+        column(Step, ch)[fixture] = bresenham.step;
+        column(StepsFade, ch)[fixture] = steps;
+        column(StepsTotal, ch)[fixture] = total;
+        stepsTotal = max(stepsTotal, total);
+    }
+
+    _currentStep[fixture] = 0;
+    _stepsTotal[fixture] = stepsTotal;
+    _flags[fixture] |= FlagActive;
+    return true;
+}
+
+void RGBWWLedGroup::skipAnimation(int fixture) {
+    if (isValidFixture(fixture))
+        _flags[fixture] &= ~FlagActive;
+}
+
+bool RGBWWLedGroup::isAnimationActive(int fixture) const {
+    return isValidFixture(fixture) && (_flags[fixture] & FlagActive);
+}
+
+HSVCT RGBWWLedGroup::getCurrentColor(int fixture) const {
+    if (!isValidFixture(fixture))
+        return HSVCT();
+
+    return HSVCT(column(Value, Hue)[fixture], column(Value, Sat)[fixture], column(Value, Val)[fixture],
+                 column(Value, ColorTemp)[fixture]);
+}
+
+const ChannelOutput& RGBWWLedGroup::getCurrentOutput(int fixture) const {
+    return _output[fixture];
+}
@@ -0,0 +1,180 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite LEDs via PWM
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+#pragma once
+// clang-format off
+#include "RGBWWTypes.h"
+#include "RGBWWLedColor.h"
+// clang-format on
+
+/**
+ * Engine for many fixtures sharing one render loop and one set of color settings.
+ *
+ * The animation state of all fixtures is stored in structure-of-arrays form
+ * (one array per channel and field), show() steps all transitions in one pass
+ * per channel. Afterwards the colors of all changed fixtures are gathered into
+ * arrays and converted with the batch HSVtoRGB() of RGBWWColorUtils, which
+ * converts four colors at once for the RAW model on targets with SSE2.
+ *
+ * Each fixture runs one HSV transition at a time with the same semantics as
+ * AnimTransition (sat, val, ct) and AnimTransitionCircularHue (hue),
+ * always linear (the easing of the ramp is ignored). Like RGBWWLed the
+ * transitions count steps of RGBWW_STEPTIME.
+ * There are no queues and no PWM output, the resulting channel values are
+ * read with getCurrentOutput() or by overriding onOutputChanged().
+ */
+class RGBWWLedGroup {
+  public:
+    /**
+     * Result of one call of show()
+     */
+    struct FrameResult {
+        int animFinished = 0;  // fixtures whose transition finished during this frame
+        int outputChanged = 0; // fixtures whose output was recalculated
+    };
+
+    RGBWWLedGroup();
+    RGBWWLedGroup(const RGBWWLedGroup&) = delete;
+    RGBWWLedGroup& operator=(const RGBWWLedGroup&) = delete;
+    virtual ~RGBWWLedGroup();
+
+    /**
+     * Allocate the state for the given number of fixtures.
+     * All fixtures start with HSVCT(0, 0, 0, 0)
+     *
+     * @param fixtures number of fixtures
+     * @retval true  state allocated
+     * @retval false already initialized or out of memory
+     */
+    bool init(int fixtures);
+
+    int getSize() const {
+        return _size;
+    }
+
+    /**
+     * Step the transitions of all fixtures and convert the colors of
+     * all fixtures which changed. Call once per getFrameInterval()
+     *
+     * @return FrameResult
+     */
+    FrameResult show();
+
+    /**
+     * Time between two calls of show(), see RGBWWLed::setFrameInterval()
+     *
+     * @param interval  ms (default RGBWW_MINTIMEDIFF)
+     * @retval false    not a positive multiple of RGBWW_STEPTIME, the interval is unchanged
+     */
+    bool setFrameInterval(int interval);
+
+    int getFrameInterval() const {
+        return _frameSteps * RGBWW_STEPTIME;
+    }
+
+    /**
+     * Set the color of a fixture, stops a running transition
+     *
+     * @param fixture index of the fixture
+     * @param color   new color, channels without value are left untouched
+     */
+    void colorDirectHSV(int fixture, const RequestHSVCT& color);
+
+    /**
+     * Start a transition of a fixture. A running transition is replaced
+     * and the new one starts from the current color
+     *
+     * @param fixture   index of the fixture
+     * @param color     target color, channels without value are left untouched
+     * @param ramp      duration or speed of the fade
+     * @param stay      time in ms to stay at the target color before the transition finishes
+     * @param direction direction of the hue transition
+     * @retval true     transition started
+     * @retval false    invalid fixture or no channel to fade
+     */
+    bool fadeHSV(int fixture, const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay = 0,
+                 HueTransitionDirection direction = HueTransitionDirection::dir_short);
+
+    /**
+     * Stop the transition of a fixture at its current color
+     */
+    void skipAnimation(int fixture);
+
+    bool isAnimationActive(int fixture) const;
+
+    /**
+     * Current color of a fixture
+     */
+    HSVCT getCurrentColor(int fixture) const;
+
+    /**
+     * Current channel values of a fixture (after brightness correction)
+     * The fixture index has to be valid
+     */
+    const ChannelOutput& getCurrentOutput(int fixture) const;
+
+    /**
+     * Called by show() for every fixture whose output was recalculated
+     */
+    virtual void onOutputChanged(int fixture, const ChannelOutput& output) {}
+
+    /**
+     * Called by show() for every fixture whose transition finished
+     */
+    virtual void onAnimationFinished(int fixture) {}
+
+    // colorutils used by all fixtures
+    RGBWWColorUtils colorutils;
+
+  private:
+    // animated channels in HSV mode
+    enum Channel { Hue, Sat, Val, ColorTemp, NumChannels };
+
+    // per channel transition state, one array of _size entries each
+    enum Field {
+        Value,      // current value
+        Base,       // value at the start of the transition
+        Final,      // value at the end of the transition
+        Delta,      // Delta, Error, Count and Step are the BresenhamValues of AnimTransition
+        Error,
+        Count,
+        Step,
+        StepsFade,  // steps of the fade
+        StepsTotal, // steps of the fade and stay, 0 if the channel is not animated
+        NumFields
+    };
+
+    enum Flags : uint8_t {
+        FlagActive = 1, // transition running
+        FlagDirty = 2,  // color changed since the last conversion
+    };
+
+    int* column(Field field, Channel ch) const {
+        return _state + (field * NumChannels + ch) * _size;
+    }
+
+    void freeState();
+    void stepChannel(Channel ch, int steps);
+    // fixtures gathered per batch conversion
+    static const int ConvertChunkSize = 16;
+
+    void convert(const int* fixtures, int count);
+    bool isValidFixture(int fixture) const {
+        return fixture >= 0 && fixture < _size;
+    }
+
+    int _size = 0;
+    int* _state = nullptr;            // [field][channel][fixture]
+    int* _currentStep = nullptr;      // [fixture]
+    int* _stepsTotal = nullptr;       // [fixture] longest StepsTotal of all channels
+    uint8_t* _flags = nullptr;        // [fixture]
+    int* _changed = nullptr;          // indices of the fixtures to convert in this frame
+    ChannelOutput* _output = nullptr; // [fixture]
+
+    uint32_t _shownRevision = 0;
+    int _frameSteps = RGBWW_MINTIMEDIFF / RGBWW_STEPTIME; // steps per show()
+};
@@ -21,11 +21,7 @@ PWMOutput::PWMOutput(uint8_t redPin, uint8_t greenPin, uint8_t bluePin, uint8_t
                      uint16_t freq /* = 200 */) {
     uint8_t pins[] = {redPin, greenPin, bluePin, wwPin, cwPin};
     _pPwm = new HardwarePWM(pins, sizeof(pins));
-
-    // this period calculation is meant for SDK-PWM or for newPcm when SDK_PWM_PERIOD_COMPAT_MODE is ON
-    const int period = int(float(1000) / (float(freq) / float(1000)));
-    _pPwm->setPeriod(period);
-    _dutyRangeFactor = _pPwm->getMaxDuty() / 65535.0f; // 65535 is the maximum what the linear curve will deliver
+    setFrequency(freq);
 }
 
 PWMOutput::~PWMOutput() {
@@ -85,16 +81,46 @@ void PWMOutput::setOutput(int red, int green, int blue, int warmwhite, int coldw
     _pPwm->update();
 }
 
+void PWMOutput::setOutputDuty(int red, int green, int blue, int warmwhite, int coldwhite) {
+    setChannelDuty(RGBWW_CHANNELS::RED, red, false);
+    setChannelDuty(RGBWW_CHANNELS::GREEN, green, false);
+    setChannelDuty(RGBWW_CHANNELS::BLUE, blue, false);
+    setChannelDuty(RGBWW_CHANNELS::WW, warmwhite, false);
+    setChannelDuty(RGBWW_CHANNELS::CW, coldwhite, false);
+
+    _pPwm->update();
+}
+
+void PWMOutput::setFrequency(int freq) {
+    _freq = freq;
+
+    // this period calculation is meant for SDK-PWM or for newPcm when SDK_PWM_PERIOD_COMPAT_MODE is ON
+    const int period = int(float(1000) / (float(freq) / float(1000)));
+    _pPwm->setPeriod(period);
+    _dutyRangeFactor = _pPwm->getMaxDuty() / 65535.0f; // 65535 is the maximum what the linear curve will deliver
+}
+
+int PWMOutput::getFrequency() {
+    return _freq;
+}
+
+int PWMOutput::scaleDuty(int value) {
+    return int(roundf(value * _dutyRangeFactor));
+}
+
 int PWMOutput::getChannel(int chan) {
     return _pPwm->getDutyChan(chan);
 }
 
 void PWMOutput::setChannel(int chan, int duty, bool update /* = true */) {
+    setChannelDuty(chan, scaleDuty(duty), update);
+}
+
+void PWMOutput::setChannelDuty(int chan, int duty, bool update /* = true */) {
     if (unsigned(duty) == _pPwm->getDutyChan(chan))
         return;
 
-    const uint32 scaledDuty = uint32(roundf(duty * _dutyRangeFactor));
-    _pPwm->setDutyChan(chan, scaledDuty, update);
+    _pPwm->setDutyChan(chan, duty, update);
 }
 
 #else
@@ -183,6 +209,15 @@ void PWMOutput::setOutput(int red, int green, int blue, int warmwhite, int coldw
     setColdWhite(coldwhite);
 }
 
+void PWMOutput::setOutputDuty(int red, int green, int blue, int warmwhite, int coldwhite) {
+    setOutput(red, green, blue, warmwhite, coldwhite);
+}
+
+int PWMOutput::scaleDuty(int value) {
+    // analogWrite takes the values of the dim curve
+    return value;
+}
+
 int PWMOutput::parseDuty(int duty) {
     return (duty * _maxduty) / RGBWW_CALC_WIDTH;
 }
@@ -34,11 +34,31 @@ class PWMOutput {
     int getColdWhite();
     void setOutput(int red, int green, int blue, int warmwhite, int coldwhite);
 
+    /**
+     * Change the PWM frequency, the current duties are not rescaled
+     *
+     * @param freq frequency in Hz
+     */
+    void setFrequency(int freq);
+    int getFrequency();
+
+    /**
+     * Hardware duty for a value of the dim curve (as used by setOutput)
+     */
+    int scaleDuty(int value);
+
+    /**
+     * Set the hardware duties of all channels, see scaleDuty()
+     */
+    void setOutputDuty(int red, int green, int blue, int warmwhite, int coldwhite);
+
     int getChannel(int chan);
     void setChannel(int channel, int duty, bool update = true);
+    void setChannelDuty(int channel, int duty, bool update = true);
 
   private:
     int parseDuty(int duty);
+    int _freq = 0;
     float _dutyRangeFactor = 0.0f;
     HardwarePWM* _pPwm;
 };
@@ -70,6 +90,16 @@ class PWMOutput {
     int getColdWhite();
     void setOutput(int red, int green, int blue, int warmwhite, int coldwhite);
 
+    /**
+     * Hardware duty for a value of the dim curve (as used by setOutput)
+     */
+    int scaleDuty(int value);
+
+    /**
+     * Set the hardware duties of all channels, see scaleDuty()
+     */
+    void setOutputDuty(int red, int green, int blue, int warmwhite, int coldwhite);
+
   private:
     int _freq;
     int _pins[RGBWW_CHANNELS::NUM_CHANNELS];
@@ -0,0 +1,197 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include <FileSystem.h>
+#include "RGBWWLedPersistence.h"
+#include "RGBWWLedSnapshot.h"
+// clang-format on
+
+bool RGBWWLedFileStorage::read(int slot, size_t offset, void* data, size_t size) {
+    file_t file = fileOpen(_fileName, eFO_ReadOnly);
+    if (file < 0)
+        return false;
+
+    const int pos = slot * _slotSize + offset;
+    const bool ok = (fileSeek(file, pos, eSO_FileStart) == pos) && (fileRead(file, data, size) == int(size));
+    fileClose(file);
+    return ok;
+}
+
+bool RGBWWLedFileStorage::write(int slot, size_t offset, const void* data, size_t size) {
+    file_t file = fileOpen(_fileName, eFO_ReadWrite | eFO_CreateIfNotExist);
+    if (file < 0)
+        return false;
+
+    // fill the slots in front of a new slot
+    const int pos = slot * _slotSize + offset;
+    int end = fileSeek(file, 0, eSO_FileEnd);
+    const uint8_t zeros[64] = {};
+    while (end >= 0 && end < pos) {
+        const int written = fileWrite(file, zeros, min(int(sizeof(zeros)), pos - end));
+        end = (written > 0) ? end + written : -1;
+    }
+
+    const bool ok = (end >= 0) && (fileSeek(file, pos, eSO_FileStart) == pos) &&
+                    (fileWrite(file, data, size) == int(size));
+    fileClose(file);
+    return ok;
+}
+
+bool RGBWWLedPersistence::restore() {
+    const size_t maxSize = (_storage.getSlotSize() > HeaderSize) ? _storage.getSlotSize() - HeaderSize : 0;
+
+    // newest slot with a valid header and snapshot
+    uint8_t* data = nullptr;
+    for (int slot = 0; slot < _storage.getSlotCount(); ++slot) {
+        uint8_t header[HeaderSize];
+        if (!_storage.read(slot, 0, header, HeaderSize))
+            continue;
+
+        RGBWWLedSnapshotReader reader(header, HeaderSize);
+        const uint32_t sequence = reader.getUint32();
+        const uint32_t size = reader.getUint32();
+        const uint32_t checksum = reader.getUint32();
+        if (size == 0 || size > maxSize || (data != nullptr && int32_t(sequence - _sequence) <= 0))
+            continue;
+
+        uint8_t* candidate = new uint8_t[size];
+        if (candidate == nullptr)
+            continue;
+        if (!_storage.read(slot, HeaderSize, candidate, size) ||
+            RGBWWLedSnapshot::checksum(candidate, size) != checksum) {
+            delete[] candidate;
+            continue;
+        }
+
+        delete[] data;
+        data = candidate;
+        _slot = slot;
+        _sequence = sequence;
+        _savedSize = size;
+        _savedChecksum = checksum;
+    }
+
+    if (data == nullptr)
+        return false;
+
+    // the next save goes into the following slot, even if the snapshot is of another version
+    _hasSaved = true;
+    const bool restored = _rgbled.restoreSnapshot(data, _savedSize);
+    delete[] data;
+
+    _revision = _rgbled.getStateRevision();
+    _dirty = false;
+    return restored;
+}
+
+void RGBWWLedPersistence::checkRevision(uint32_t now) {
+    const uint32_t revision = _rgbled.getStateRevision();
+    if (revision == _revision)
+        return;
+
+    _stats.changes += revision - _revision;
+    _revision = revision;
+    _changeTime = now;
+    _dirty = true;
+}
+
+bool RGBWWLedPersistence::process(uint32_t now) {
+    checkRevision(now);
+    if (!_dirty || now - _changeTime < uint32_t(_quietPeriod))
+        return false;
+    if (_saveTimeValid && now - _saveTime < uint32_t(_minInterval))
+        return false;
+
+    return save(now);
+}
+
+bool RGBWWLedPersistence::flush() {
+    const uint32_t now = millis();
+    checkRevision(now);
+    return !_dirty || save(now);
+}
+
+bool RGBWWLedPersistence::save(uint32_t now) {
+    // failed saves are retried after minInterval
+    _saveTime = now;
+    _saveTimeValid = true;
+
+    const size_t size = _rgbled.getSnapshotSize();
+    if (_storage.getSlotCount() <= 0 || size + HeaderSize > _storage.getSlotSize()) {
+        debug_w("RGBWWLedPersistence::save: Snapshot of %d bytes does not fit into a slot\n", int(size));
+        ++_stats.failed;
+        return false;
+    }
+
+    uint8_t* data = new uint8_t[HeaderSize + size];
+    if (data == nullptr) {
+        ++_stats.failed;
+        return false;
+    }
+    _rgbled.saveSnapshot(data + HeaderSize, size);
+    const uint32_t checksum = RGBWWLedSnapshot::checksum(data + HeaderSize, size);
+    if (_hasSaved && size == _savedSize && checksum == _savedChecksum) {
+        delete[] data;
+        ++_stats.unchanged;
+        _dirty = false;
+        return true;
+    }
+
+    RGBWWLedSnapshotWriter header(data, HeaderSize);
+    header.putUint32(_sequence + 1);
+    header.putUint32(size);
+    header.putUint32(checksum);
+
+    // the header is written last, it stays invalid until the snapshot is complete
+    const int slot = (_slot + 1) % _storage.getSlotCount();
+    const bool ok = writeDelta(slot, HeaderSize, data + HeaderSize, size) && writeSlot(slot, 0, data, HeaderSize);
+    delete[] data;
+    if (!ok) {
+        debug_w("RGBWWLedPersistence::save: Writing slot %d failed\n", slot);
+        ++_stats.failed;
+        return false;
+    }
+
+    _slot = slot;
+    ++_sequence;
+    _hasSaved = true;
+    _savedSize = size;
+    _savedChecksum = checksum;
+    _dirty = false;
+    ++_stats.saves;
+    return true;
+}
+
+bool RGBWWLedPersistence::writeDelta(int slot, size_t offset, const uint8_t* data, size_t size) {
+    uint8_t current[DeltaChunkSize];
+
+    // consecutive chunks which differ are written at once
+    size_t start = 0;
+    size_t length = 0;
+    for (size_t pos = 0; pos < size; pos += DeltaChunkSize) {
+        const size_t chunk = (size - pos < DeltaChunkSize) ? size - pos : DeltaChunkSize;
+        if (!_storage.read(slot, offset + pos, current, chunk) || memcmp(current, data + pos, chunk) != 0) {
+            if (length == 0)
+                start = pos;
+            length = pos + chunk - start;
+            continue;
+        }
+
+        if (length > 0 && !writeSlot(slot, offset + start, data + start, length))
+            return false;
+        length = 0;
+    }
+
+    return length == 0 || writeSlot(slot, offset + start, data + start, length);
+}
+
+bool RGBWWLedPersistence::writeSlot(int slot, size_t offset, const uint8_t* data, size_t size) {
+    ++_stats.writes;
+    _stats.bytesWritten += size;
+    return _storage.write(slot, offset, data, size);
+}
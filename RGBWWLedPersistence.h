@@ -0,0 +1,170 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite LEDs via PWM
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+#pragma once
+// clang-format off
+#include "RGBWWLed.h"
+#include "RGBWWconst.h"
+// clang-format on
+
+/**
+ * Storage of RGBWWLedPersistence: a number of slots of the same size.
+ * Implement it for the memory of the device (file, flash sector, EEPROM)
+ */
+class RGBWWLedStorage {
+  public:
+    virtual ~RGBWWLedStorage() {}
+
+    virtual int getSlotCount() const = 0;
+    virtual size_t getSlotSize() const = 0;
+
+    /**
+     * @retval false    read error or the slot was never written
+     */
+    virtual bool read(int slot, size_t offset, void* data, size_t size) = 0;
+    virtual bool write(int slot, size_t offset, const void* data, size_t size) = 0;
+};
+
+/**
+ * Slots stored one after the other in a file of the file system (SPIFFS on the device, the
+ * host file system with the Sming host emulator)
+ */
+class RGBWWLedFileStorage : public RGBWWLedStorage {
+  public:
+    RGBWWLedFileStorage(const String& fileName, int slots, size_t slotSize)
+        : _fileName(fileName), _slots(slots), _slotSize(slotSize) {}
+
+    virtual int getSlotCount() const override {
+        return _slots;
+    }
+
+    virtual size_t getSlotSize() const override {
+        return _slotSize;
+    }
+
+    virtual bool read(int slot, size_t offset, void* data, size_t size) override;
+    virtual bool write(int slot, size_t offset, const void* data, size_t size) override;
+
+  private:
+    String _fileName;
+    int _slots;
+    size_t _slotSize;
+};
+
+/**
+ * Counters of RGBWWLedPersistence
+ */
+struct PersistenceStats {
+    uint32_t changes = 0;      // state changes noticed, several changes within the quiet period are saved once
+    uint32_t saves = 0;        // snapshots saved
+    uint32_t unchanged = 0;    // saves skipped because the snapshot equals the last saved one
+    uint32_t writes = 0;       // calls of RGBWWLedStorage::write()
+    uint32_t bytesWritten = 0; // bytes passed to RGBWWLedStorage::write()
+    uint32_t failed = 0;       // saves which failed (snapshot too big for a slot, write error)
+};
+
+/**
+ * Saves the state of a controller (see RGBWWLed::saveSnapshot()) into a storage
+ * after it changed, instead of writing on every call.
+ *
+ * - Changes are noticed by RGBWWLed::getStateRevision(). The state is saved once no
+ *   change happened for quietPeriod ms and the last save is at least minInterval ms ago
+ * - Every save goes into the next slot, so the writes are spread over all slots. A slot
+ *   holds a header (sequence number, size, checksum) and the snapshot. The header is written
+ *   last, an interrupted save leaves the previous slots intact
+ * - Only the parts of the slot which differ from its former content are written
+ *
+ *   RGBWWLedFileStorage storage("rgbww.state", 4, 1024);
+ *   RGBWWLedPersistence persistence(rgbled, storage);
+ *   persistence.restore();
+ *   ...
+ *   // in the main loop
+ *   rgbled.show();
+ *   persistence.process();
+ */
+class RGBWWLedPersistence {
+  public:
+    // sequence number, size and checksum in front of the snapshot
+    static const size_t HeaderSize = 12;
+
+    RGBWWLedPersistence(RGBWWLed& rgbled, RGBWWLedStorage& storage, int quietPeriod = RGBWW_PERSISTQUIETPERIOD,
+                        int minInterval = RGBWW_PERSISTMININTERVAL)
+        : _rgbled(rgbled), _storage(storage), _quietPeriod(quietPeriod), _minInterval(minInterval),
+          _revision(rgbled.getStateRevision()) {}
+
+    RGBWWLedPersistence(const RGBWWLedPersistence&) = delete;
+    RGBWWLedPersistence& operator=(const RGBWWLedPersistence&) = delete;
+
+    /**
+     * Restore the newest valid slot into the controller. Call once after init() of the controller
+     *
+     * @retval false    no valid slot or the snapshot could not be restored
+     */
+    bool restore();
+
+    /**
+     * Save the state if it changed and the quiet period passed. Call it from the main loop
+     *
+     * @param now   current time in ms
+     * @retval true the state was saved
+     */
+    bool process(uint32_t now);
+
+    bool process() {
+        return process(millis());
+    }
+
+    /**
+     * Save a changed state at once, i.e. before a reboot
+     *
+     * @retval false    saving failed
+     */
+    bool flush();
+
+    /**
+     * Check if a change was not saved yet
+     */
+    bool isDirty() const {
+        return _dirty;
+    }
+
+    const PersistenceStats& getStats() const {
+        return _stats;
+    }
+
+  private:
+    // granularity of the comparison with the former content of a slot
+    static const size_t DeltaChunkSize = 32;
+
+    void checkRevision(uint32_t now);
+    bool save(uint32_t now);
+
+    /**
+     * Write only the chunks of data which differ from the content of the slot
+     */
+    bool writeDelta(int slot, size_t offset, const uint8_t* data, size_t size);
+    bool writeSlot(int slot, size_t offset, const uint8_t* data, size_t size);
+
+    RGBWWLed& _rgbled;
+    RGBWWLedStorage& _storage;
+    int _quietPeriod;
+    int _minInterval;
+
+    uint32_t _revision = 0;
+    bool _dirty = false;
+    uint32_t _changeTime = 0; // time of the last change
+
+    bool _hasSaved = false; // a slot holds a valid snapshot
+    int _slot = -1;         // slot of the last save
+    uint32_t _sequence = 0;
+    bool _saveTimeValid = false;
+    uint32_t _saveTime = 0; // time of the last save of this run
+    uint32_t _savedSize = 0;
+    uint32_t _savedChecksum = 0;
+
+    PersistenceStats _stats;
+};
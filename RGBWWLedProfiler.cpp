@@ -0,0 +1,82 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include "RGBWWLedProfiler.h"
+// clang-format on
+
+int RGBWWLedProfiler::getBucket(uint32_t ticks) {
+    if (ticks < 4)
+        return ticks;
+
+    // highest bit selects the power of 2, the two bits below it the bucket within
+    const int msb = 31 - __builtin_clz(ticks);
+    const int bucket = (msb - 1) * 4 + ((ticks >> (msb - 2)) & 3);
+    return min(bucket, BucketCount - 1);
+}
+
+uint32_t RGBWWLedProfiler::getBucketLimit(int bucket) {
+    if (bucket < 4)
+        return bucket;
+
+    const int shift = bucket / 4 - 1;
+    return ((uint32_t(4 + bucket % 4) + 1) << shift) - 1;
+}
+
+void RGBWWLedProfiler::add(Stage stage, uint32_t ticks) {
+    const int index = static_cast<int>(stage);
+    ProfileStats& stats = _stats[index];
+    if (stats.count == 0 || ticks < stats.min)
+        stats.min = ticks;
+    if (ticks > stats.max)
+        stats.max = ticks;
+    ++stats.count;
+    stats.total += ticks;
+    ++_histogram[index][getBucket(ticks)];
+}
+
+uint32_t RGBWWLedProfiler::getPercentile(Stage stage, int percent) const {
+    const int index = static_cast<int>(stage);
+    const ProfileStats& stats = _stats[index];
+    if (stats.count == 0)
+        return 0;
+
+    const uint32_t rank = uint32_t((uint64_t(stats.count) * constrain(percent, 1, 100) + 99) / 100);
+    uint32_t seen = 0;
+    for (int bucket = 0; bucket < BucketCount; ++bucket) {
+        seen += _histogram[index][bucket];
+        if (seen >= rank)
+            return constrain(getBucketLimit(bucket), stats.min, stats.max);
+    }
+    return stats.max;
+}
+
+const char* RGBWWLedProfiler::getStageName(Stage stage) {
+    switch (stage) {
+    case Stage::Channels:
+        return "channels";
+    case Stage::HsvToRgb:
+        return "hsv2rgb";
+    case Stage::WhiteBalance:
+        return "whitebalance";
+    case Stage::Brightness:
+        return "brightness";
+    case Stage::Output:
+        return "output";
+    case Stage::Frame:
+        return "frame";
+    }
+    return "";
+}
+
+void RGBWWLedProfiler::reset() {
+    for (int i = 0; i < StageCount; ++i) {
+        _stats[i] = ProfileStats();
+        for (int bucket = 0; bucket < BucketCount; ++bucket)
+            _histogram[i][bucket] = 0;
+    }
+}
@@ -0,0 +1,138 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite LEDs via PWM
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+#pragma once
+// clang-format off
+#include "RGBWWconst.h"
+// clang-format on
+
+/**
+ * Time spent in one stage of RGBWWLed::show(), in ticks of RGBWW_PROFILE_TICKS()
+ */
+struct ProfileStats {
+    uint32_t count = 0; // measurements
+    uint32_t min = 0;
+    uint32_t max = 0;
+    uint64_t total = 0;
+
+    uint32_t mean() const {
+        return (count > 0) ? uint32_t(total / count) : 0;
+    }
+};
+
+/**
+ * Timing counters of the stages of RGBWWLed::show(), see RGBWWLed::getProfiler().
+ * Part of RGBWWLed only when built with RGBWW_ENABLE_PROFILING.
+ *
+ * Every stage keeps min, max, total and a histogram with 4 buckets per power of 2,
+ * so percentiles are accurate to about 20%. The stages of a frame are measured one
+ * after the other, a frame costs one read of the tick counter per stage plus one.
+ *
+ * Only one of RGBWW_PROFILEINTERVAL frames is measured. Min, max and the percentiles
+ * are sampled: they are those of the measured frames, a spike in any other frame is
+ * not seen. With the default interval of 128 the profiler adds 0.6 - 1.7% to a frame
+ * of show() on the host (make profile in test/, ticks of the TSC). Measuring every
+ * frame (-DRGBWW_PROFILEINTERVAL=1) catches every spike but adds 45 - 80% there,
+ * mostly the reads of the tick counter
+ */
+class RGBWWLedProfiler {
+  public:
+    enum class Stage {
+        Channels,     // animations of the channels and the next frame interval
+        HsvToRgb,     // reading the HSV channels and RGBWWColorUtils::HSVtoRGB()
+        WhiteBalance, // RGBWWColorUtils::whiteBalance() or reading the raw channels
+        Brightness,   // RGBWWColorUtils::correctBrightness() and rebuilding the duty tables
+        Output,       // write to the PWM output
+        Frame,        // whole frame, including frames without changes
+    };
+
+    static const int StageCount = static_cast<int>(Stage::Frame) + 1;
+
+    /**
+     * Add a measurement
+     *
+     * @param ticks time spent in the stage
+     */
+    void add(Stage stage, uint32_t ticks);
+
+    /**
+     * Start the measurement of a frame, only one of RGBWW_PROFILEINTERVAL frames is measured
+     */
+    void beginFrame() {
+        if (_skipFrames > 0) {
+            --_skipFrames;
+            return;
+        }
+        _skipFrames = RGBWW_PROFILEINTERVAL - 1;
+        _lapStart = RGBWW_PROFILE_TICKS();
+        _frameStart = _lapStart;
+        _inFrame = true;
+    }
+
+    /**
+     * Add the time since the end of the previous stage of the frame. Ignored outside
+     * of a frame, i.e. for RGBWWLed::setOutput()
+     */
+    void lap(Stage stage) {
+        if (!_inFrame)
+            return;
+        const uint32_t now = RGBWW_PROFILE_TICKS();
+        add(stage, now - _lapStart);
+        _lapStart = now;
+    }
+
+    /**
+     * Add the frame up to the end of its last stage
+     */
+    void endFrame() {
+        if (!_inFrame)
+            return;
+        add(Stage::Frame, _lapStart - _frameStart);
+        _inFrame = false;
+    }
+
+    const ProfileStats& getStats(Stage stage) const {
+        return _stats[static_cast<int>(stage)];
+    }
+
+    /**
+     * Estimated time the given percentage of the measurements did not exceed
+     *
+     * @param percent   1 .. 100, i.e. 50 for the median
+     * @return uint32_t ticks, 0 without measurements
+     */
+    uint32_t getPercentile(Stage stage, int percent) const;
+
+    static const char* getStageName(Stage stage);
+
+    void reset();
+
+  private:
+    // 4 buckets per power of 2 up to 2^17 ticks, longer times go into the last bucket
+    static const int BucketCount = 64;
+
+    static int getBucket(uint32_t ticks);
+    static uint32_t getBucketLimit(int bucket);
+
+    ProfileStats _stats[StageCount];
+    uint32_t _histogram[StageCount][BucketCount] = {};
+
+    int _skipFrames = 0;
+    bool _inFrame = false;
+    uint32_t _frameStart = 0;
+    uint32_t _lapStart = 0; // end of the previous stage
+};
+
+#ifdef RGBWW_ENABLE_PROFILING
+#define RGBWW_PROFILE_BEGIN() _profiler.beginFrame()
+#define RGBWW_PROFILE_LAP(stage) _profiler.lap(RGBWWLedProfiler::Stage::stage)
+#define RGBWW_PROFILE_END() _profiler.endFrame()
+#else
+#define RGBWW_PROFILE_BEGIN()
+#define RGBWW_PROFILE_LAP(stage)
+#define RGBWW_PROFILE_END()
+#endif
@@ -0,0 +1,121 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include "RGBWWLedRenderer.h"
+// clang-format on
+
+/**
+ * Append the decimal digits of value, returns the end of the digits
+ */
+static char* appendInt(char* p, int value) {
+    unsigned int u = value;
+    if (value < 0) {
+        *p++ = '-';
+        u = 0u - u;
+    }
+
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = char('0' + u % 10);
+        u /= 10;
+    } while (u > 0);
+
+    while (n > 0)
+        *p++ = digits[--n];
+    return p;
+}
+
+static uint8_t* appendUint16(uint8_t* p, int value) {
+    const uint16_t v = constrain(value, 0, 0xFFFF);
+    *p++ = v & 0xFF;
+    *p++ = v >> 8;
+    return p;
+}
+
+bool RGBWWLedCsvSink::begin(int frameInterval) {
+    _out.print("time,h,s,v,ct,r,g,b,ww,cw,dim_r,dim_g,dim_b,dim_ww,dim_cw\n");
+    return true;
+}
+
+bool RGBWWLedCsvSink::write(const RenderFrame& frame) {
+    const int values[] = {frame.color.h,  frame.color.s,  frame.color.v,   frame.color.ct,  frame.output.r,
+                          frame.output.g, frame.output.b, frame.output.ww, frame.output.cw, frame.dimmed.r,
+                          frame.dimmed.g, frame.dimmed.b, frame.dimmed.ww, frame.dimmed.cw};
+
+    // formatted into one line, a call of Print per value would take most of the time
+    char line[16 * 12];
+    char* p = appendInt(line, int(frame.time));
+    for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        *p++ = ',';
+        p = appendInt(p, values[i]);
+    }
+    *p++ = '\n';
+
+    const size_t size = p - line;
+    return _out.write(reinterpret_cast<const uint8_t*>(line), size) == size;
+}
+
+bool RGBWWLedBinarySink::begin(int frameInterval) {
+    uint8_t header[7] = {'R', 'G', 'B', 'R', Version};
+    appendUint16(header + 5, frameInterval);
+    return _out.write(header, sizeof(header)) == sizeof(header);
+}
+
+bool RGBWWLedBinarySink::write(const RenderFrame& frame) {
+    uint8_t record[RecordSize];
+    uint8_t* p = record;
+    p = appendUint16(p, frame.color.h);
+    p = appendUint16(p, frame.color.s);
+    p = appendUint16(p, frame.color.v);
+    p = appendUint16(p, frame.color.ct);
+    for (const ChannelOutput* o : {&frame.output, &frame.dimmed}) {
+        p = appendUint16(p, o->r);
+        p = appendUint16(p, o->g);
+        p = appendUint16(p, o->b);
+        p = appendUint16(p, o->ww);
+        p = appendUint16(p, o->cw);
+    }
+
+    return _out.write(record, sizeof(record)) == sizeof(record);
+}
+
+RGBWWLedRenderer::RGBWWLedRenderer(RGBWWLed& rgbled, int frameInterval)
+    : _rgbled(rgbled), _frameInterval(max(frameInterval, RGBWW_STEPTIME)) {}
+
+uint32_t RGBWWLedRenderer::render(RGBWWLedRenderSink& sink, uint32_t duration, bool stopWhenIdle) {
+    if (!_started) {
+        if (!sink.begin(_frameInterval))
+            return 0;
+        _started = true;
+    }
+
+    const uint32_t end = _time + duration;
+    uint32_t frames = 0;
+    RenderFrame frame;
+    while (int32_t(end - _time) > 0) {
+        const RGBWWLed::FrameResult result = _rgbled.show(_time);
+
+        frame.time = _time;
+        frame.color = _rgbled.getCurrentColor();
+        const ChannelOutput& o = _rgbled.getCurrentOutput();
+        frame.output = o;
+        frame.dimmed = ChannelOutput(RGBWW_dim_curve[o.r], RGBWW_dim_curve[o.g], RGBWW_dim_curve[o.b],
+                                     RGBWW_dim_curve[o.ww], RGBWW_dim_curve[o.cw]);
+
+        _time += _frameInterval;
+        ++frames;
+        if (!sink.write(frame))
+            break;
+
+        if (stopWhenIdle && result.nextFrame == 0)
+            break;
+    }
+
+    return frames;
+}
@@ -0,0 +1,128 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite LEDs via PWM
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+#pragma once
+// clang-format off
+#include "RGBWWLed.h"
+#include "RGBWWconst.h"
+// clang-format on
+
+/**
+ * One frame of RGBWWLedRenderer
+ */
+struct RenderFrame {
+    uint32_t time = 0;    // ms since the start of the rendering
+    HSVCT color;          // current color, kept from the last HSV frame in raw mode
+    ChannelOutput output; // channel values after color conversion and brightness correction
+    ChannelOutput dimmed; // output after the dim curve (RGBWW_dim_curve), before scaling to the PWM duty
+};
+
+/**
+ * Receives the frames of RGBWWLedRenderer
+ */
+class RGBWWLedRenderSink {
+  public:
+    virtual ~RGBWWLedRenderSink() {}
+
+    /**
+     * Called once before the first frame
+     *
+     * @param frameInterval ms between two frames
+     */
+    virtual bool begin(int frameInterval) {
+        return true;
+    }
+
+    /**
+     * @retval false    stop rendering
+     */
+    virtual bool write(const RenderFrame& frame) = 0;
+};
+
+/**
+ * Frames as CSV, one line per frame:
+ * time,h,s,v,ct,r,g,b,ww,cw,dim_r,dim_g,dim_b,dim_ww,dim_cw
+ */
+class RGBWWLedCsvSink : public RGBWWLedRenderSink {
+  public:
+    RGBWWLedCsvSink(Print& out) : _out(out) {}
+
+    virtual bool begin(int frameInterval) override;
+    virtual bool write(const RenderFrame& frame) override;
+
+  private:
+    Print& _out;
+};
+
+/**
+ * Frames as binary records, for baselines of regression tests.
+ *
+ * Header: "RGBR", version (1 byte), frame interval in ms (2 bytes).
+ * Followed by one record of 30 bytes per frame, all values 16 bit little endian:
+ * h, s, v, ct, r, g, b, ww, cw and the dimmed r, g, b, ww, cw.
+ * The time of a frame follows from its index and the frame interval
+ */
+class RGBWWLedBinarySink : public RGBWWLedRenderSink {
+  public:
+    static const uint8_t Version = 1;
+    static const int RecordSize = 30;
+
+    RGBWWLedBinarySink(Print& out) : _out(out) {}
+
+    virtual bool begin(int frameInterval) override;
+    virtual bool write(const RenderFrame& frame) override;
+
+  private:
+    Print& _out;
+};
+
+/**
+ * Runs the animations of a controller with a virtual clock as fast as possible and passes
+ * every frame to a sink, i.e. to preview a queue of fades or to record a baseline for tests.
+ *
+ * Use a controller without init(): it calculates the output without writing it to a PWM output.
+ * The animations advance like with RGBWWLed::show(now) called every frameInterval ms.
+ *
+ *   RGBWWLed preview;
+ *   preview.fadeHSV(...);
+ *   RGBWWLedRenderer renderer(preview);
+ *   RGBWWLedCsvSink sink(Serial);
+ *   renderer.render(sink, 60000);
+ */
+class RGBWWLedRenderer {
+  public:
+    /**
+     * @param frameInterval ms between two frames, at least RGBWW_STEPTIME (default 50 Hz)
+     */
+    RGBWWLedRenderer(RGBWWLed& rgbled, int frameInterval = RGBWW_MINTIMEDIFF);
+
+    /**
+     * Render the next frames. Can be called several times, i.e. after queuing further animations
+     *
+     * @param duration      ms to render
+     * @param stopWhenIdle  stop after the first frame without running or queued animations
+     * @return uint32_t     frames passed to the sink
+     */
+    uint32_t render(RGBWWLedRenderSink& sink, uint32_t duration, bool stopWhenIdle = false);
+
+    /**
+     * Virtual time of the next frame, ms since the start
+     */
+    uint32_t getTime() const {
+        return _time;
+    }
+
+    int getFrameInterval() const {
+        return _frameInterval;
+    }
+
+  private:
+    RGBWWLed& _rgbled;
+    int _frameInterval;
+    uint32_t _time = 0;
+    bool _started = false;
+};
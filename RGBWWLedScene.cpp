@@ -0,0 +1,612 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include "RGBWWLedScene.h"
+// clang-format on
+
+namespace {
+
+// tokens of one statement: keyword, label and up to 10 fade options
+const int MaxTokens = 12;
+
+// input range of the channel values, indexed by CtrlChannel
+const AbsOrRelValue::Type valueTypes[] = {
+    AbsOrRelValue::Type::Raw,     AbsOrRelValue::Type::Hue, AbsOrRelValue::Type::Percent,
+    AbsOrRelValue::Type::Percent, AbsOrRelValue::Type::Ct,  AbsOrRelValue::Type::Raw,
+    AbsOrRelValue::Type::Raw,     AbsOrRelValue::Type::Raw, AbsOrRelValue::Type::Raw,
+    AbsOrRelValue::Type::Raw,
+};
+
+// in the order of Easing
+const char* const easingNames[] = {"linear", "in", "out", "inout", "exp", "sine"};
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool equals(const char* token, int length, const char* str) {
+    return strncmp(token, str, length) == 0 && str[length] == '\0';
+}
+
+// decimal number >= 0
+bool parseNumber(const char* token, int length, int& value) {
+    if (length <= 0 || length > 9)
+        return false;
+
+    value = 0;
+    for (int i = 0; i < length; ++i) {
+        if (token[i] < '0' || token[i] > '9')
+            return false;
+        value = value * 10 + (token[i] - '0');
+    }
+    return true;
+}
+
+void emit(int32_t* code, int& size, int32_t word) {
+    if (code != nullptr)
+        code[size] = word;
+    ++size;
+}
+
+} // namespace
+
+RGBWWLedScene::~RGBWWLedScene() {
+    delete[] _code;
+}
+
+bool RGBWWLedScene::compile(const char* text) {
+    delete[] _code;
+    _code = nullptr;
+    _size = 0;
+    _counters = 0;
+    _mode = RGBWWLed::ColorMode::Hsv;
+    _error = Error::None;
+    _errorLine = 0;
+    _labelCount = 0;
+
+    // the first pass collects the labels and the size
+    _loopCount = 0;
+    _hasHsv = _hasRaw = false;
+    const int size = translate(text, nullptr);
+    if (size < 0)
+        return false;
+
+    int32_t* code = new int32_t[size];
+    if (code == nullptr) {
+        _error = Error::OutOfMemory;
+        return false;
+    }
+
+    _loopCount = 0;
+    _hasHsv = _hasRaw = false;
+    if (translate(text, code) < 0) {
+        delete[] code;
+        return false;
+    }
+
+    _code = code;
+    _size = size;
+    _counters = _loopCount;
+    _mode = _hasRaw ? RGBWWLed::ColorMode::Raw : RGBWWLed::ColorMode::Hsv;
+    return true;
+}
+
+int RGBWWLedScene::translate(const char* text, int32_t* code) {
+    int size = 0;
+    int line = 1;
+    const char* p = text;
+    while (true) {
+        const char* tokens[MaxTokens];
+        int lengths[MaxTokens];
+        int count = 0;
+
+        while (*p != '\0' && *p != '\n' && *p != ';') {
+            if (*p == '#') {
+                while (*p != '\0' && *p != '\n')
+                    ++p;
+                break;
+            }
+            if (isSpace(*p)) {
+                ++p;
+                continue;
+            }
+
+            const char* start = p;
+            while (*p != '\0' && !isSpace(*p) && *p != ';' && *p != '#')
+                ++p;
+            if (count == MaxTokens) {
+                _error = Error::Syntax;
+                _errorLine = line;
+                return -1;
+            }
+            tokens[count] = start;
+            lengths[count++] = p - start;
+        }
+
+        if (count > 0 && !translateStatement(tokens, lengths, count, code, size)) {
+            _errorLine = line;
+            return -1;
+        }
+
+        if (*p == '\0')
+            break;
+        if (*p == '\n')
+            ++line;
+        ++p;
+    }
+
+    emit(code, size, static_cast<int32_t>(Op::End));
+    return size;
+}
+
+bool RGBWWLedScene::translateStatement(const char** tokens, const int* lengths, int count, int32_t* code,
+                                       int& size) {
+    // label, optionally followed by a statement
+    if (lengths[0] > 1 && tokens[0][lengths[0] - 1] == ':') {
+        const int length = lengths[0] - 1;
+        if (code == nullptr) {
+            if (findLabel(tokens[0], length) >= 0) {
+                _error = Error::Label;
+                return false;
+            }
+            if (_labelCount == MaxLabels) {
+                _error = Error::TooManyLabels;
+                return false;
+            }
+            _labels[_labelCount++] = {tokens[0], length, size};
+        }
+        return count == 1 || translateStatement(tokens + 1, lengths + 1, count - 1, code, size);
+    }
+
+    const char* keyword = tokens[0];
+    const int length = lengths[0];
+    int value;
+
+    if (equals(keyword, length, "fade"))
+        return translateFade(tokens, lengths, count, code, size);
+
+    if (equals(keyword, length, "stay") || equals(keyword, length, "blink")) {
+        if (count != 2 || !parseNumber(tokens[1], lengths[1], value)) {
+            _error = Error::Syntax;
+            return false;
+        }
+        emit(code, size, static_cast<int32_t>(equals(keyword, length, "stay") ? Op::Stay : Op::Blink));
+        emit(code, size, value);
+        return true;
+    }
+
+    if (equals(keyword, length, "loop") || equals(keyword, length, "jump")) {
+        const bool loop = equals(keyword, length, "loop");
+        if (count != (loop ? 3 : 2) || (loop && (!parseNumber(tokens[2], lengths[2], value) || value < 1))) {
+            _error = Error::Syntax;
+            return false;
+        }
+
+        // labels are known in the second pass
+        int target = 0;
+        if (code != nullptr) {
+            target = findLabel(tokens[1], lengths[1]);
+            if (target < 0) {
+                _error = Error::Label;
+                return false;
+            }
+        }
+
+        if (loop) {
+            emit(code, size, static_cast<int32_t>(Op::Loop) | (_loopCount++ << 8));
+            emit(code, size, target);
+            emit(code, size, value);
+        } else {
+            emit(code, size, static_cast<int32_t>(Op::Jump));
+            emit(code, size, target);
+        }
+        return true;
+    }
+
+    if (equals(keyword, length, "wait") && count == 1) {
+        emit(code, size, static_cast<int32_t>(Op::Wait));
+        return true;
+    }
+
+    _error = Error::Syntax;
+    return false;
+}
+
+bool RGBWWLedScene::translateFade(const char** tokens, const int* lengths, int count, int32_t* code, int& size) {
+    int32_t values[AnimJoint::MaxChannels] = {};
+    int channels = 0;
+    int relative = 0;
+    bool hsv = false;
+    bool raw = false;
+    int rampValue = 0;
+    bool speed = false;
+    int stay = 0;
+    int easing = 0;
+    bool longDirection = false;
+
+    for (int t = 1; t < count; ++t) {
+        const char* separator = static_cast<const char*>(memchr(tokens[t], '=', lengths[t]));
+        if (separator == nullptr) {
+            _error = Error::Syntax;
+            return false;
+        }
+        const char* key = tokens[t];
+        const int keyLength = separator - key;
+        const char* val = separator + 1;
+        const int valLength = lengths[t] - keyLength - 1;
+
+        bool numeric = true;
+        if (equals(key, keyLength, "time") || equals(key, keyLength, "speed")) {
+            numeric = parseNumber(val, valLength, rampValue);
+            speed = equals(key, keyLength, "speed");
+        } else if (equals(key, keyLength, "stay")) {
+            numeric = parseNumber(val, valLength, stay);
+        } else if (equals(key, keyLength, "dir")) {
+            longDirection = equals(val, valLength, "long");
+            numeric = longDirection || equals(val, valLength, "short");
+        } else if (equals(key, keyLength, "ease")) {
+            for (easing = 0; easing < static_cast<int>(sizeof(easingNames) / sizeof(easingNames[0])); ++easing) {
+                if (equals(val, valLength, easingNames[easing]))
+                    break;
+            }
+            numeric = easing <= static_cast<int>(Easing::Sine);
+        } else {
+            const CtrlChannel ch = ctrlChannelFromString(key, keyLength);
+            if (ch == CtrlChannel::None) {
+                _error = Error::Channel;
+                return false;
+            }
+
+            const bool isHsv = ch <= CtrlChannel::ColorTemp;
+            const int index = static_cast<int>(ch) - static_cast<int>(isHsv ? CtrlChannel::Hue : CtrlChannel::Red);
+            hsv |= isHsv;
+            raw |= !isHsv;
+
+            AbsOrRelValue value;
+            numeric = AbsOrRelValue::parse(val, valLength, valueTypes[static_cast<int>(ch)], value);
+            values[index] = value.getValue();
+            channels |= 1 << index;
+            if (value.getMode() == AbsOrRelValue::Mode::Relative)
+                relative |= 1 << index;
+        }
+
+        if (!numeric) {
+            _error = Error::Syntax;
+            return false;
+        }
+    }
+
+    // one scene controls the channels of one color mode
+    _hasHsv |= hsv;
+    _hasRaw |= raw;
+    if (_hasHsv && _hasRaw) {
+        _error = Error::Channel;
+        return false;
+    }
+
+    emit(code, size,
+         static_cast<int32_t>(Op::Fade) | (channels << 8) | (relative << 13) | (longDirection ? 1 << 18 : 0) |
+             (speed ? 1 << 19 : 0) | (easing << 20));
+    emit(code, size, rampValue);
+    emit(code, size, stay);
+    for (int i = 0; i < AnimJoint::MaxChannels; ++i) {
+        if (channels & (1 << i))
+            emit(code, size, values[i]);
+    }
+    return true;
+}
+
+int RGBWWLedScene::findLabel(const char* name, int length) const {
+    for (int i = 0; i < _labelCount; ++i) {
+        if (_labels[i].length == length && strncmp(_labels[i].name, name, length) == 0)
+            return _labels[i].offset;
+    }
+    return -1;
+}
+
+int RGBWWLedScene::getInstructionSize(int32_t header) {
+    switch (getOp(header)) {
+    case Op::End:
+    case Op::Wait:
+        return 1;
+    case Op::Fade:
+        return 3 + __builtin_popcount(getFadeChannels(header));
+    case Op::Stay:
+    case Op::Blink:
+    case Op::Jump:
+        return 2;
+    case Op::Loop:
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+bool RGBWWLedScene::isInstruction(const int32_t* code, int size, int offset) {
+    int pc = 0;
+    while (pc < offset && pc < size) {
+        const int length = getInstructionSize(code[pc]);
+        if (length == 0)
+            return false;
+        pc += length;
+    }
+    return pc == offset && offset < size;
+}
+
+bool RGBWWLedScene::verify(const int32_t* code, int size, int counters, RGBWWLed::ColorMode mode) {
+    const bool hsv = (mode == RGBWWLed::ColorMode::Hsv);
+    const int channels = hsv ? 4 : 5;
+    const int first = static_cast<int>(hsv ? CtrlChannel::Hue : CtrlChannel::Red);
+
+    bool ended = false;
+    int pc = 0;
+    while (pc < size) {
+        const int32_t header = code[pc];
+        const int length = getInstructionSize(header);
+        if (length == 0 || length > size - pc)
+            return false;
+
+        const int32_t* instruction = code + pc;
+        switch (getOp(header)) {
+        case Op::End:
+            ended = true;
+            if (pc != size - 1)
+                return false;
+            break;
+        case Op::Fade: {
+            const int mask = getFadeChannels(header);
+            if ((mask >> channels) != 0 || (getFadeRelative(header) & ~mask) != 0 ||
+                getFadeEasing(header) > Easing::Sine || (header >> 23) != 0 || instruction[1] < 0 ||
+                instruction[2] < 0)
+                return false;
+
+            int word = 3;
+            for (int i = 0; i < channels; ++i) {
+                if (!(mask & (1 << i)))
+                    continue;
+                const AbsOrRelValue::Mode valueMode = (getFadeRelative(header) & (1 << i))
+                                                          ? AbsOrRelValue::Mode::Relative
+                                                          : AbsOrRelValue::Mode::Absolute;
+                const AbsOrRelValue::Type type = valueTypes[first + i];
+                if (!AbsOrRelValue(instruction[word++], valueMode, type).isValid(AbsOrRelValue::getMaxValue(type)))
+                    return false;
+            }
+            break;
+        }
+        case Op::Stay:
+        case Op::Blink:
+            if (instruction[1] < 0)
+                return false;
+            break;
+        case Op::Loop:
+            if (getLoopCounter(header) < 0 || getLoopCounter(header) >= counters || instruction[2] < 1 ||
+                !isInstruction(code, size, instruction[1]))
+                return false;
+            break;
+        case Op::Jump:
+            if (!isInstruction(code, size, instruction[1]))
+                return false;
+            break;
+        case Op::Wait:
+            if (header != static_cast<int32_t>(Op::Wait))
+                return false;
+            break;
+        }
+        pc += length;
+    }
+
+    return ended;
+}
+
+/**************************************************************
+ *                     AnimScene
+ **************************************************************/
+
+AnimScene::AnimScene(RGBWWLed const* rgbled, RGBWWLed::ColorMode mode, bool requeue, const String& name)
+    : AnimJoint(rgbled, (mode == RGBWWLed::ColorMode::Hsv) ? CtrlChannel::Hue : CtrlChannel::Red,
+                (mode == RGBWWLed::ColorMode::Hsv) ? 4 : 5, Type::Scene, requeue, name) {}
+
+AnimScene::AnimScene(RGBWWLed const* rgbled, const RGBWWLedScene& scene, bool requeue, const String& name)
+    : AnimScene(rgbled, scene.getMode(), requeue, name) {
+    if (scene.getSize() == 0)
+        return;
+
+    _code = new int32_t[scene.getSize() + scene.getCounters()];
+    if (_code == nullptr)
+        return;
+    memcpy(_code, scene.getCode(), scene.getSize() * sizeof(int32_t));
+    _counters = scene.getSize();
+    _counterCount = scene.getCounters();
+    reset();
+}
+
+AnimScene::~AnimScene() {
+    delete[] _code;
+}
+
+bool AnimScene::trigger() {
+    if (_state != State::Waiting)
+        return false;
+
+    _state = State::Idle;
+    return true;
+}
+
+bool AnimScene::seekInstruction() {
+    for (int jumps = 0; jumps <= MaxJumps; ++jumps) {
+        const int32_t header = _code[_pc];
+        switch (RGBWWLedScene::getOp(header)) {
+        case RGBWWLedScene::Op::End:
+            return false;
+        case RGBWWLedScene::Op::Loop: {
+            int32_t& counter = _code[_counters + RGBWWLedScene::getLoopCounter(header)];
+            if (++counter < _code[_pc + 2]) {
+                _pc = _code[_pc + 1];
+            } else {
+                // ready for the next time the loop is entered
+                counter = 0;
+                _pc += 3;
+            }
+            break;
+        }
+        case RGBWWLedScene::Op::Jump:
+            _pc = _code[_pc + 1];
+            break;
+        default:
+            return true;
+        }
+    }
+
+    debug_w("AnimScene: no timed instruction after %d jumps, stopping\n", MaxJumps);
+    return false;
+}
+
+bool AnimScene::startInstruction() {
+    if (_code == nullptr || !seekInstruction())
+        return false;
+
+    const bool hsv = (_ctrlChannel == CtrlChannel::Hue);
+    const int32_t* instruction = _code + _pc;
+    const int32_t header = instruction[0];
+    switch (RGBWWLedScene::getOp(header)) {
+    case RGBWWLedScene::Op::Fade: {
+        static const AbsOrRelValue::Type hsvTypes[] = {AbsOrRelValue::Type::Hue, AbsOrRelValue::Type::Percent,
+                                                       AbsOrRelValue::Type::Percent, AbsOrRelValue::Type::Ct};
+        const int channels = RGBWWLedScene::getFadeChannels(header);
+        const int relative = RGBWWLedScene::getFadeRelative(header);
+
+        Optional<AbsOrRelValue> values[MaxChannels];
+        int word = 3;
+        for (int i = 0; i < _channelCount; ++i) {
+            if (!(channels & (1 << i)))
+                continue;
+            const AbsOrRelValue::Mode mode =
+                (relative & (1 << i)) ? AbsOrRelValue::Mode::Relative : AbsOrRelValue::Mode::Absolute;
+            values[i] = AbsOrRelValue(instruction[word++], mode, hsv ? hsvTypes[i] : AbsOrRelValue::Type::Raw);
+        }
+
+        const RampTimeOrSpeed ramp(instruction[1], RGBWWLedScene::getFadeRampType(header),
+                                   RGBWWLedScene::getFadeEasing(header));
+        initFade(values, nullptr, ramp, instruction[2], RGBWWLedScene::getFadeDirection(header));
+        _state = State::Fading;
+        _pc += word;
+        break;
+    }
+    case RGBWWLedScene::Op::Blink: {
+        // brightness channels: v or ww and cw
+        const int first = hsv ? 2 : 3;
+        const int last = hsv ? 2 : 4;
+        for (int i = first; i <= last; ++i) {
+            _blinkSaved[i - first] = getChannelValue(i);
+            setChannelValue(i, (_blinkSaved[i - first] > (RGBWW_CALC_MAXVAL / 2)) ? 0 : RGBWW_CALC_MAXVAL);
+        }
+        _holdLeft = max(instruction[1] / RGBWW_STEPTIME, 1);
+        _state = State::Blinking;
+        _pc += 2;
+        break;
+    }
+    case RGBWWLedScene::Op::Stay:
+        _holdLeft = max(instruction[1] / RGBWW_STEPTIME, 1);
+        _state = State::Holding;
+        _pc += 2;
+        break;
+    default:
+        _state = State::Waiting;
+        _pc += 1;
+        break;
+    }
+    return true;
+}
+
+void AnimScene::finishInstruction() {
+    if (_state == State::Blinking) {
+        const bool hsv = (_ctrlChannel == CtrlChannel::Hue);
+        const int first = hsv ? 2 : 3;
+        const int last = hsv ? 2 : 4;
+        for (int i = first; i <= last; ++i)
+            setChannelValue(i, _blinkSaved[i - first]);
+    }
+    _state = State::Idle;
+}
+
+bool AnimScene::run() {
+    if (_state == State::Idle && !startInstruction())
+        return true;
+
+    switch (_state) {
+    case State::Fading:
+        if (!runFade())
+            return false;
+        break;
+    case State::Holding:
+    case State::Blinking:
+        if (--_holdLeft > 0)
+            return false;
+        break;
+    default:
+        return false;
+    }
+
+    finishInstruction();
+    return !seekInstruction();
+}
+
+bool AnimScene::advance(int& steps) {
+    while (steps > 0) {
+        if (_state == State::Idle && !startInstruction())
+            return true;
+
+        switch (_state) {
+        case State::Fading:
+            if (!advanceFade(steps))
+                return false;
+            break;
+        case State::Holding:
+        case State::Blinking:
+            if (steps < _holdLeft) {
+                _holdLeft -= steps;
+                steps = 0;
+                return false;
+            }
+            steps -= _holdLeft;
+            _holdLeft = 0;
+            break;
+        default:
+            steps = 0;
+            return false;
+        }
+
+        finishInstruction();
+        if (!seekInstruction())
+            return true;
+    }
+    return false;
+}
+
+int AnimScene::stepsToNextChange() const {
+    switch (_state) {
+    case State::Fading:
+        return fadeStepsToNextChange();
+    case State::Holding:
+    case State::Blinking:
+        return _holdLeft;
+    case State::Waiting:
+        // idle until triggered
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+void AnimScene::reset() {
+    _pc = 0;
+    _state = State::Idle;
+    resetFade();
+    if (_code != nullptr)
+        memset(_code + _counters, 0, _counterCount * sizeof(int32_t));
+}
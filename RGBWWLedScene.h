@@ -0,0 +1,255 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite LEDs via PWM
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+#pragma once
+// clang-format off
+#include "RGBWWLed.h"
+#include "RGBWWLedAnimation.h"
+// clang-format on
+
+/**
+ * Scene compiled from a text description into a flat bytecode program.
+ *
+ * One statement per line (or separated by ';'), '#' starts a comment:
+ *
+ *   start:                                  label, target of loop and jump
+ *   fade h=120 s=100 v=+10 time=2000        fade, see below
+ *   stay 500                                keep the current values for 500 ms
+ *   blink 200                               invert the brightness for 200 ms (v or ww and cw)
+ *   loop start 3                            run the statements from start 3 times
+ *   jump start                              continue at start
+ *   wait                                    wait for RGBWWLed::triggerScene()
+ *
+ * fade takes the channels of one color mode (h s v ct or r g b cw ww) with the
+ * value syntax of AbsOrRelValue::parse() (h in degree, s and v in percent, ct and raw
+ * channels as is, '+' and '-' for relative values) and the options
+ * time=ms or speed=n, stay=ms, ease=linear|in|out|inout|exp|sine, dir=short|long.
+ *
+ * The program is one array of words, jumps are resolved by the compiler.
+ * It is run with AnimScene or RGBWWLed::playScene().
+ */
+class RGBWWLedScene {
+  public:
+    enum class Error {
+        None,
+        Syntax,             // unknown statement, option or malformed number
+        Channel,            // unknown channel or channels of both color modes
+        Label,              // unknown or duplicate label
+        TooManyLabels,      // more than MaxLabels labels
+        OutOfMemory,
+    };
+
+    enum class Op : uint8_t {
+        End,
+        Fade,  // header, ramp value, stay, one word per channel value
+        Stay,  // header, ms
+        Blink, // header, ms
+        Loop,  // header (counter index), target, count
+        Jump,  // header, target
+        Wait,  // header
+    };
+
+    static const int MaxLabels = 16;
+
+    RGBWWLedScene() {}
+    RGBWWLedScene(const RGBWWLedScene&) = delete;
+    RGBWWLedScene& operator=(const RGBWWLedScene&) = delete;
+    ~RGBWWLedScene();
+
+    /**
+     * Compile a scene, replaces a previously compiled program
+     *
+     * @param text  scene description, see above
+     * @retval true compiled
+     * @retval false see getError() and getErrorLine()
+     */
+    bool compile(const char* text);
+
+    Error getError() const {
+        return _error;
+    }
+
+    /**
+     * Line of the error, starting with 1
+     */
+    int getErrorLine() const {
+        return _errorLine;
+    }
+
+    /**
+     * Color mode of the channels faded by the scene, Hsv if it fades none
+     */
+    RGBWWLed::ColorMode getMode() const {
+        return _mode;
+    }
+
+    const int32_t* getCode() const {
+        return _code;
+    }
+
+    /**
+     * Size of the program in words, including the closing Op::End
+     */
+    int getSize() const {
+        return _size;
+    }
+
+    /**
+     * Number of loop counters needed to run the program
+     */
+    int getCounters() const {
+        return _counters;
+    }
+
+    static Op getOp(int32_t header) {
+        return static_cast<Op>(header & 0xff);
+    }
+
+    // fields of the header of Op::Fade
+    static int getFadeChannels(int32_t header) {
+        return (header >> 8) & 0x1f;
+    }
+    static int getFadeRelative(int32_t header) {
+        return (header >> 13) & 0x1f;
+    }
+    static HueTransitionDirection getFadeDirection(int32_t header) {
+        return ((header >> 18) & 1) ? HueTransitionDirection::dir_long : HueTransitionDirection::dir_short;
+    }
+    static RampTimeOrSpeed::Type getFadeRampType(int32_t header) {
+        return ((header >> 19) & 1) ? RampTimeOrSpeed::Type::Speed : RampTimeOrSpeed::Type::Time;
+    }
+    static Easing getFadeEasing(int32_t header) {
+        return static_cast<Easing>((header >> 20) & 0x7);
+    }
+
+    // counter index of Op::Loop
+    static int getLoopCounter(int32_t header) {
+        return header >> 8;
+    }
+
+    /**
+     * Check a program that was not compiled here, i.e. one restored from a snapshot.
+     * Every instruction has to be complete, jumps and loops have to target an instruction
+     * and use one of the loop counters, fades the channels and value ranges of the color
+     * mode. The last instruction is Op::End
+     *
+     * @param size      words of the program
+     * @param counters  number of loop counters
+     */
+    static bool verify(const int32_t* code, int size, int counters, RGBWWLed::ColorMode mode);
+
+    /**
+     * Check if an offset is the start of an instruction of a verified program
+     */
+    static bool isInstruction(const int32_t* code, int size, int offset);
+
+  private:
+    struct Label {
+        const char* name;
+        int length;
+        int offset;
+    };
+
+    /**
+     * Translate the text. Without code only the size and the labels are collected
+     *
+     * @param code  output or nullptr
+     * @return int  size of the program in words, -1 on error
+     */
+    int translate(const char* text, int32_t* code);
+    bool translateStatement(const char** tokens, const int* lengths, int count, int32_t* code, int& size);
+    bool translateFade(const char** tokens, const int* lengths, int count, int32_t* code, int& size);
+    int findLabel(const char* name, int length) const;
+
+    /**
+     * Words of an instruction, 0 for an unknown op
+     */
+    static int getInstructionSize(int32_t header);
+
+    int32_t* _code = nullptr;
+    int _size = 0;
+    int _counters = 0;
+    RGBWWLed::ColorMode _mode = RGBWWLed::ColorMode::Hsv;
+
+    Error _error = Error::None;
+    int _errorLine = 0;
+
+    // state of the compiler
+    Label _labels[MaxLabels];
+    int _labelCount = 0;
+    int _loopCount = 0;
+    bool _hasHsv = false;
+    bool _hasRaw = false;
+};
+
+/**
+ * Runs a compiled RGBWWLedScene on all channels of its color mode.
+ *
+ * The animation holds a copy of the program followed by the loop counters in a
+ * single buffer, so the scene can be queued several times and on several controllers.
+ * The cost per frame is one instruction (plus the loops and jumps in front of it),
+ * independent of the length of the scene.
+ */
+class AnimScene : public AnimJoint {
+  public:
+    AnimScene(RGBWWLed const* rgbled, const RGBWWLedScene& scene, bool requeue = false, const String& name = "");
+
+    /**
+     * Scene without program, used to restore a snapshot
+     */
+    AnimScene(RGBWWLed const* rgbled, RGBWWLed::ColorMode mode, bool requeue = false, const String& name = "");
+    virtual ~AnimScene();
+
+    /**
+     * Check if the program was copied, false if the scene is empty or out of memory
+     */
+    bool isValid() const {
+        return _code != nullptr;
+    }
+
+    /**
+     * Continue a scene waiting at Op::Wait
+     *
+     * @retval true the scene was waiting
+     */
+    bool trigger();
+
+    virtual bool run() override;
+    virtual bool advance(int& steps) override;
+    virtual int stepsToNextChange() const override;
+    virtual void reset() override;
+
+  protected:
+    virtual SnapshotClass getSnapshotClass() const override {
+        return SnapshotClass::Scene;
+    }
+    virtual void saveState(RGBWWLedSnapshotWriter& writer) const override;
+    virtual void loadState(RGBWWLedSnapshotReader& reader) override;
+
+  private:
+    enum class State : uint8_t { Idle, Fading, Holding, Blinking, Waiting };
+
+    // consecutive loops and jumps without a timed instruction before the scene is stopped
+    static const int MaxJumps = 16;
+
+    /**
+     * Execute loops and jumps up to the next timed instruction
+     *
+     * @retval false the scene ended
+     */
+    bool seekInstruction();
+    bool startInstruction();
+    void finishInstruction();
+
+    int32_t* _code = nullptr; // program followed by the loop counters
+    int _counters = 0;        // index of the first loop counter
+    int _counterCount = 0;
+    int _pc = 0;              // next instruction
+    int _holdLeft = 0;        // steps left of Op::Stay and Op::Blink
+    int _blinkSaved[2] = {};  // values before Op::Blink
+    State _state = State::Idle;
+};
@@ -0,0 +1,724 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ *
+ * Snapshot of the animation state. Every class saves the members it needs to
+ * continue at the current step, the animations are recreated with their
+ * constructors and overwrite their state afterwards.
+ */
+// clang-format off
+#include "RGBWWLedSnapshot.h"
+#include "RGBWWLed.h"
+#include "RGBWWLedAnimation.h"
+#include "RGBWWLedScene.h"
+#include "RGBWWLedTimeline.h"
+// clang-format on
+
+namespace {
+
+const char SnapshotMagic[4] = {'R', 'G', 'B', 'S'};
+
+// largest value of a channel, see AbsOrRelValue::getMaxValue()
+int getChannelMax(CtrlChannel ch) {
+    switch (ch) {
+    case CtrlChannel::Hue:
+        return AbsOrRelValue::getMaxValue(AbsOrRelValue::Type::Hue);
+    case CtrlChannel::ColorTemp:
+        return AbsOrRelValue::getMaxValue(AbsOrRelValue::Type::Ct);
+    default:
+        return RGBWW_CALC_MAXVAL;
+    }
+}
+
+// largest value of the channel index of a joint animation
+int getChannelMax(CtrlChannel first, int index) {
+    return getChannelMax(static_cast<CtrlChannel>(static_cast<int>(first) + index));
+}
+
+int getChannelValue(RGBWWLedSnapshotReader& reader, CtrlChannel ch) {
+    return reader.getInt(0, getChannelMax(ch));
+}
+
+} // namespace
+
+uint32_t RGBWWLedSnapshot::checksum(const uint8_t* data, size_t size) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**************************************************************
+ *                     RGBWWLedSnapshotWriter
+ **************************************************************/
+
+void RGBWWLedSnapshotWriter::putByte(uint8_t value) {
+    if (_data != nullptr && _size < _capacity)
+        _data[_size] = value;
+    ++_size;
+}
+
+void RGBWWLedSnapshotWriter::putUint32(uint32_t value) {
+    for (int i = 0; i < 4; ++i)
+        putByte(uint8_t(value >> (8 * i)));
+}
+
+void RGBWWLedSnapshotWriter::putInt(int32_t value) {
+    // zigzag: small negative values get small codes as well
+    uint32_t code = (uint32_t(value) << 1) ^ uint32_t(value >> 31);
+    while (code >= 0x80) {
+        putByte(uint8_t(code | 0x80));
+        code >>= 7;
+    }
+    putByte(uint8_t(code));
+}
+
+void RGBWWLedSnapshotWriter::putDouble(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    putUint32(uint32_t(bits));
+    putUint32(uint32_t(bits >> 32));
+}
+
+void RGBWWLedSnapshotWriter::putString(const String& value) {
+    putInt(value.length());
+    putBytes(value.c_str(), value.length());
+}
+
+void RGBWWLedSnapshotWriter::putBytes(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i)
+        putByte(bytes[i]);
+}
+
+void RGBWWLedSnapshotWriter::putValue(const AbsOrRelValue& value) {
+    putInt(value.getValue());
+    putByte((static_cast<uint8_t>(value.getMode()) << 4) | static_cast<uint8_t>(value.getType()));
+}
+
+void RGBWWLedSnapshotWriter::putValue(const Optional<AbsOrRelValue>& value) {
+    putBool(value.hasValue());
+    if (value.hasValue())
+        putValue(value.getValue());
+}
+
+void RGBWWLedSnapshotWriter::putRamp(const RampTimeOrSpeed& ramp) {
+    // ramps are usually whole numbers, which are saved as varint
+    const bool integral = (ramp.value >= INT32_MIN && ramp.value <= INT32_MAX &&
+                           double(int32_t(ramp.value)) == ramp.value);
+    putByte((integral ? 0x80 : 0) | (static_cast<uint8_t>(ramp.type) << 4) | static_cast<uint8_t>(ramp.easing));
+    if (integral)
+        putInt(int32_t(ramp.value));
+    else
+        putDouble(ramp.value);
+}
+
+/**************************************************************
+ *                     RGBWWLedSnapshotReader
+ **************************************************************/
+
+uint8_t RGBWWLedSnapshotReader::getByte() {
+    if (_pos >= _size) {
+        _error = true;
+        return 0;
+    }
+    return _data[_pos++];
+}
+
+uint32_t RGBWWLedSnapshotReader::getUint32() {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+        value |= uint32_t(getByte()) << (8 * i);
+    return value;
+}
+
+int32_t RGBWWLedSnapshotReader::getInt() {
+    uint32_t code = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        const uint8_t b = getByte();
+        code |= uint32_t(b & 0x7f) << shift;
+        if ((b & 0x80) == 0)
+            return int32_t(code >> 1) ^ -int32_t(code & 1);
+    }
+
+    // more than 5 bytes
+    _error = true;
+    return 0;
+}
+
+int32_t RGBWWLedSnapshotReader::getInt(int32_t min, int32_t max) {
+    const int32_t value = getInt();
+    if (value < min || value > max) {
+        _error = true;
+        return min;
+    }
+    return value;
+}
+
+double RGBWWLedSnapshotReader::getDouble() {
+    uint64_t bits = getUint32();
+    bits |= uint64_t(getUint32()) << 32;
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+String RGBWWLedSnapshotReader::getString() {
+    const int length = getInt(0, getRemaining());
+    if (_error || length == 0)
+        return String();
+
+    const char* str = reinterpret_cast<const char*>(_data + _pos);
+    _pos += length;
+    return String(str, length);
+}
+
+void RGBWWLedSnapshotReader::getBytes(void* data, size_t size) {
+    uint8_t* bytes = static_cast<uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i)
+        bytes[i] = getByte();
+}
+
+AbsOrRelValue RGBWWLedSnapshotReader::getValue(int max) {
+    const int value = getInt();
+    const uint8_t modeAndType = getByte();
+    if ((modeAndType >> 4) > static_cast<int>(AbsOrRelValue::Mode::Relative) ||
+        (modeAndType & 0xf) > static_cast<int>(AbsOrRelValue::Type::Ct)) {
+        _error = true;
+        return AbsOrRelValue();
+    }
+
+    const AbsOrRelValue result(value, static_cast<AbsOrRelValue::Mode>(modeAndType >> 4),
+                               static_cast<AbsOrRelValue::Type>(modeAndType & 0xf));
+    if (!result.isValid(max))
+        _error = true;
+    return result;
+}
+
+Optional<AbsOrRelValue> RGBWWLedSnapshotReader::getOptionalValue(int max) {
+    if (!getBool())
+        return Optional<AbsOrRelValue>();
+    return getValue(max);
+}
+
+RampTimeOrSpeed RGBWWLedSnapshotReader::getRamp() {
+    const uint8_t flags = getByte();
+    const double value = (flags & 0x80) ? getInt() : getDouble();
+    const int type = (flags >> 4) & 0x7;
+    const int easing = flags & 0xf;
+    // the steps of a fade are calculated from the value, also NaN fails here
+    if (type > static_cast<int>(RampTimeOrSpeed::Type::Time) || easing > static_cast<int>(Easing::Sine) ||
+        !(value >= 0 && value <= INT32_MAX)) {
+        _error = true;
+        return RampTimeOrSpeed();
+    }
+
+    return RampTimeOrSpeed(value, static_cast<RampTimeOrSpeed::Type>(type), static_cast<Easing>(easing));
+}
+
+/**************************************************************
+ *                     Animations
+ **************************************************************/
+
+void RGBWWLedAnimation::saveSnapshot(RGBWWLedSnapshotWriter& writer) const {
+    // needed by the constructor
+    writer.putInt(static_cast<int>(getSnapshotClass()));
+    writer.putInt(static_cast<int>(_ctrlChannel));
+    writer.putBool(_requeue);
+    writer.putString(getName());
+
+    writer.putInt(_value);
+    writer.putInt(_request.id);
+    writer.putInt(_request.channels);
+    writer.putInt(_request.cycle);
+    writer.putBool(_hasBaseOverride);
+    writer.putInt(_baseOverride);
+
+    saveState(writer);
+}
+
+RGBWWLedAnimation* RGBWWLedAnimation::restoreSnapshot(RGBWWLedSnapshotReader& reader, RGBWWLed const* rgbled,
+                                                      CtrlChannel ch, RGBWWAnimatedChannel* channels) {
+    const SnapshotClass snapshotClass = static_cast<SnapshotClass>(
+        reader.getInt(static_cast<int>(SnapshotClass::Transition), static_cast<int>(SnapshotClass::Scene)));
+    const CtrlChannel savedCh = static_cast<CtrlChannel>(
+        reader.getInt(static_cast<int>(CtrlChannel::Hue), static_cast<int>(CtrlChannel::WarmWhite)));
+    const bool requeue = reader.getBool();
+    const String name = reader.getString();
+
+    const bool joint = (snapshotClass == SnapshotClass::Timeline || snapshotClass == SnapshotClass::JointTransition ||
+                        snapshotClass == SnapshotClass::Scene);
+    if (savedCh != ch || joint != (channels != nullptr))
+        reader.setError();
+    if (reader.hasError())
+        return nullptr;
+
+    const RGBWWLed::ColorMode mode = (ch == CtrlChannel::Hue) ? RGBWWLed::ColorMode::Hsv : RGBWWLed::ColorMode::Raw;
+    RGBWWLedAnimation* pAnim = nullptr;
+    switch (snapshotClass) {
+    case SnapshotClass::Transition:
+        pAnim = new AnimTransition(rgbled, AbsOrRelValue(), RampTimeOrSpeed(), 0, ch, requeue, name);
+        break;
+    case SnapshotClass::TransitionCircularHue:
+        pAnim = new AnimTransitionCircularHue(rgbled, AbsOrRelValue(), RampTimeOrSpeed(), 0,
+                                              HueTransitionDirection::dir_short, ch, requeue, name);
+        break;
+    case SnapshotClass::Blink:
+        pAnim = new AnimBlink(rgbled, 0, ch, requeue, name);
+        break;
+    case SnapshotClass::Timeline:
+        pAnim = new AnimTimeline(rgbled, mode, 0, requeue, name);
+        break;
+    case SnapshotClass::JointTransition:
+        if (mode == RGBWWLed::ColorMode::Hsv)
+            pAnim = new AnimJointTransition(rgbled, RequestHSVCT(), RampTimeOrSpeed(), 0,
+                                            HueTransitionDirection::dir_short, requeue, name);
+        else
+            pAnim = new AnimJointTransition(rgbled, RequestChannelOutput(), RampTimeOrSpeed(), 0, requeue, name);
+        break;
+    case SnapshotClass::Scene:
+        pAnim = new AnimScene(rgbled, mode, requeue, name);
+        break;
+    default:
+        break;
+    }
+    if (pAnim == nullptr)
+        return nullptr;
+
+    if (joint)
+        static_cast<AnimJoint*>(pAnim)->attach(channels);
+
+    pAnim->_value = getChannelValue(reader, ch);
+    pAnim->_request.id = reader.getInt(0, UINT16_MAX);
+    pAnim->_request.channels = reader.getInt(0, UINT16_MAX);
+    pAnim->_request.cycle = reader.getInt(0, UINT8_MAX);
+    pAnim->_hasBaseOverride = reader.getBool();
+    pAnim->_baseOverride = getChannelValue(reader, ch);
+    pAnim->loadState(reader);
+
+    if (reader.hasError()) {
+        delete pAnim;
+        return nullptr;
+    }
+    return pAnim;
+}
+
+void AnimTransition::saveState(RGBWWLedSnapshotWriter& writer) const {
+    writer.putInt(_baseval);
+    writer.putInt(_currentval);
+    writer.putInt(_finalval);
+    writer.putBool(_hasfromval);
+    writer.putInt(_currentstep);
+    writer.putInt(_stepsNeededFade);
+    writer.putInt(_stepsNeededFadeAndStay);
+    writer.putInt(_bresenham.delta);
+    writer.putInt(_bresenham.error);
+    writer.putInt(_bresenham.count);
+    writer.putInt(_bresenham.step);
+    writer.putInt(_easeProgress);
+    writer.putInt(_easeIncrement);
+    writer.putInt(_distance);
+    writer.putValue(_initEndVal);
+    writer.putValue(_initStartVal);
+    writer.putRamp(_ramp);
+    writer.putInt(_stay);
+}
+
+void AnimTransition::loadState(RGBWWLedSnapshotReader& reader) {
+    const int maxValue = getChannelMax(_ctrlChannel);
+    _baseval = reader.getInt(0, maxValue);
+    _currentval = reader.getInt(0, maxValue);
+    _finalval = reader.getInt(0, maxValue);
+    _hasfromval = reader.getBool();
+    _currentstep = reader.getInt(0, INT32_MAX);
+    _stepsNeededFade = reader.getInt(0, INT32_MAX);
+    _stepsNeededFadeAndStay = reader.getInt(_stepsNeededFade, INT32_MAX);
+    _bresenham.delta = reader.getInt(0, maxValue);
+    _bresenham.error = reader.getInt();
+    _bresenham.count = reader.getInt();
+    _bresenham.step = reader.getInt();
+    _easeProgress = reader.getInt(0, 1 << 24);
+    _easeIncrement = reader.getInt(0, 1 << 24);
+    _distance = reader.getInt(-maxValue, maxValue);
+    _initEndVal = reader.getValue(maxValue);
+    _initStartVal = reader.getValue(maxValue);
+    _ramp = reader.getRamp();
+    _stay = reader.getInt(0, INT32_MAX);
+    if (reader.hasError() || _currentstep == 0)
+        return;
+
+    // The fade state follows from the steps done and the distance. Other values would
+    // move the channel out of its range: check it against the state of a fade seeked to
+    // the current step, like advance() does
+    BresenhamValues expected;
+    initBresenham(expected, abs(_distance), (_distance < 0) ? -1 : 1, max(_stepsNeededFade, 1));
+    const int fadeSteps = min(_currentstep, _stepsNeededFade - 1);
+    int easeProgress = 0;
+    if (_ramp.easing == Easing::Linear && fadeSteps > 0)
+        bresenhamSeek(expected, _stepsNeededFade, _baseval, fadeSteps);
+    else if (_ramp.easing != Easing::Linear)
+        easeProgress = (1 << 24) / max(_stepsNeededFade, 1) * max(fadeSteps, 0);
+
+    if (_stepsNeededFade == 0 || _currentstep > _stepsNeededFadeAndStay || expected.delta != _bresenham.delta ||
+        expected.error != _bresenham.error || expected.count != _bresenham.count ||
+        (expected.delta > 0 && expected.step != _bresenham.step) ||
+        _easeIncrement != (1 << 24) / _stepsNeededFade || _easeProgress != easeProgress)
+        reader.setError();
+
+    // the target of a straight fade, AnimTransitionCircularHue checks its direction
+    if (getSnapshotClass() == SnapshotClass::Transition && _baseval + _distance != _finalval)
+        reader.setError();
+}
+
+void AnimTransitionCircularHue::saveState(RGBWWLedSnapshotWriter& writer) const {
+    AnimTransition::saveState(writer);
+    writer.putInt(static_cast<int>(_direction));
+}
+
+void AnimTransitionCircularHue::loadState(RGBWWLedSnapshotReader& reader) {
+    AnimTransition::loadState(reader);
+    _direction = static_cast<HueTransitionDirection>(reader.getInt(0, 1));
+
+    int delta;
+    const int direction = calcDirection(_baseval, _finalval, _direction, delta);
+    if (_currentstep > 0 && _distance != delta * direction)
+        reader.setError();
+}
+
+void AnimBlink::saveState(RGBWWLedSnapshotWriter& writer) const {
+    writer.putInt(_currentstep);
+    writer.putInt(_stepsNeeded);
+    writer.putInt(_prevvalue);
+}
+
+void AnimBlink::loadState(RGBWWLedSnapshotReader& reader) {
+    _currentstep = reader.getInt(0, INT32_MAX);
+    _stepsNeeded = reader.getInt(0, INT32_MAX);
+    _prevvalue = getChannelValue(reader, _ctrlChannel);
+}
+
+void AnimJoint::saveState(RGBWWLedSnapshotWriter& writer) const {
+    writer.putInt(static_cast<int>(_easing));
+    writer.putInt(_currentstep);
+    writer.putInt(_stepsNeededFade);
+    writer.putInt(_stepsNeededFadeAndStay);
+    writer.putInt(_easeProgress);
+    writer.putInt(_easeIncrement);
+    for (int i = 0; i < _channelCount; ++i) {
+        writer.putInt(_baseval[i]);
+        writer.putInt(_distance[i]);
+    }
+}
+
+void AnimJoint::loadState(RGBWWLedSnapshotReader& reader) {
+    _easing = static_cast<Easing>(reader.getInt(0, static_cast<int>(Easing::Sine)));
+    _currentstep = reader.getInt(0, INT32_MAX);
+    _stepsNeededFade = reader.getInt(0, INT32_MAX);
+    _stepsNeededFadeAndStay = reader.getInt(_stepsNeededFade, INT32_MAX);
+    _easeProgress = reader.getInt(0, 1 << 24);
+    _easeIncrement = reader.getInt(0, 1 << 24);
+    for (int i = 0; i < _channelCount; ++i) {
+        const CtrlChannel ch = static_cast<CtrlChannel>(static_cast<int>(_ctrlChannel) + i);
+        const int maxValue = getChannelMax(ch);
+        _baseval[i] = reader.getInt(0, maxValue);
+        // the hue turns around the wheel, the other channels stay in their range
+        if (ch == CtrlChannel::Hue)
+            _distance[i] = reader.getInt(-maxValue, maxValue);
+        else
+            _distance[i] = reader.getInt(-_baseval[i], maxValue - _baseval[i]);
+    }
+    if (reader.hasError() || _currentstep == 0)
+        return;
+
+    // a started fade: the easing state follows from the steps done, see runFade()
+    if (_stepsNeededFade == 0 || _currentstep >= _stepsNeededFadeAndStay ||
+        _easeIncrement != (1 << 24) / _stepsNeededFade ||
+        _easeProgress != _easeIncrement * min(_currentstep, _stepsNeededFade - 1))
+        reader.setError();
+}
+
+void AnimJointTransition::saveState(RGBWWLedSnapshotWriter& writer) const {
+    AnimJoint::saveState(writer);
+    for (int i = 0; i < _channelCount; ++i) {
+        writer.putValue(_initEndVal[i]);
+        writer.putValue(_initStartVal[i]);
+    }
+    writer.putBool(_hasfromval);
+    writer.putRamp(_ramp);
+    writer.putInt(_stay);
+    writer.putInt(static_cast<int>(_direction));
+}
+
+void AnimJointTransition::loadState(RGBWWLedSnapshotReader& reader) {
+    AnimJoint::loadState(reader);
+    for (int i = 0; i < _channelCount; ++i) {
+        _initEndVal[i] = reader.getOptionalValue(getChannelMax(_ctrlChannel, i));
+        _initStartVal[i] = reader.getOptionalValue(getChannelMax(_ctrlChannel, i));
+    }
+    _hasfromval = reader.getBool();
+    _ramp = reader.getRamp();
+    _stay = reader.getInt(0, INT32_MAX);
+    _direction = static_cast<HueTransitionDirection>(reader.getInt(0, 1));
+}
+
+void AnimTimeline::saveState(RGBWWLedSnapshotWriter& writer) const {
+    AnimJoint::saveState(writer);
+    writer.putInt(_count);
+    writer.putInt(_keyframe);
+    for (int k = 0; k < _count; ++k) {
+        const Keyframe& keyframe = _keyframes[k];
+        for (int i = 0; i < _channelCount; ++i)
+            writer.putValue(keyframe.values[i]);
+        writer.putRamp(keyframe.ramp);
+        writer.putInt(keyframe.stay);
+        writer.putInt(static_cast<int>(keyframe.direction));
+    }
+}
+
+void AnimTimeline::loadState(RGBWWLedSnapshotReader& reader) {
+    AnimJoint::loadState(reader);
+    // every keyframe takes more than one byte
+    const int count = reader.getInt(0, reader.getRemaining());
+    _keyframe = reader.getInt(0, count);
+    if (reader.hasError())
+        return;
+
+    delete[] _keyframes;
+    _keyframes = (count > 0) ? new Keyframe[count] : nullptr;
+    _capacity = (_keyframes != nullptr) ? count : 0;
+    _count = _capacity;
+    if (_count < count) {
+        reader.setError();
+        return;
+    }
+
+    for (int k = 0; k < _count; ++k) {
+        Keyframe& keyframe = _keyframes[k];
+        for (int i = 0; i < _channelCount; ++i)
+            keyframe.values[i] = reader.getOptionalValue(getChannelMax(_ctrlChannel, i));
+        keyframe.ramp = reader.getRamp();
+        keyframe.stay = reader.getInt(0, INT32_MAX);
+        keyframe.direction = static_cast<HueTransitionDirection>(reader.getInt(0, 1));
+    }
+}
+
+void AnimScene::saveState(RGBWWLedSnapshotWriter& writer) const {
+    AnimJoint::saveState(writer);
+    writer.putInt(_counters);
+    writer.putInt(_counterCount);
+    for (int i = 0; i < _counters + _counterCount; ++i)
+        writer.putInt(_code[i]);
+    writer.putInt(_pc);
+    writer.putInt(_holdLeft);
+    writer.putInt(_blinkSaved[0]);
+    writer.putInt(_blinkSaved[1]);
+    writer.putInt(static_cast<int>(_state));
+}
+
+void AnimScene::loadState(RGBWWLedSnapshotReader& reader) {
+    AnimJoint::loadState(reader);
+    // every word takes at least one byte
+    const int size = reader.getInt(1, reader.getRemaining());
+    const int counters = reader.getInt(0, reader.getRemaining());
+    if (reader.hasError())
+        return;
+
+    delete[] _code;
+    _code = new int32_t[size + counters];
+    if (_code == nullptr) {
+        reader.setError();
+        return;
+    }
+    _counters = size;
+    _counterCount = counters;
+    for (int i = 0; i < size; ++i)
+        _code[i] = reader.getInt();
+    for (int i = size; i < size + counters; ++i)
+        _code[i] = reader.getInt(0, INT32_MAX);
+    _pc = reader.getInt(0, size - 1);
+    _holdLeft = reader.getInt(0, INT32_MAX);
+    _blinkSaved[0] = reader.getInt(0, RGBWW_CALC_MAXVAL);
+    _blinkSaved[1] = reader.getInt(0, RGBWW_CALC_MAXVAL);
+    _state = static_cast<State>(reader.getInt(0, static_cast<int>(State::Waiting)));
+
+    // the program runs without checks of its own, the loops and jumps have to stay within it
+    const RGBWWLed::ColorMode mode =
+        (_ctrlChannel == CtrlChannel::Hue) ? RGBWWLed::ColorMode::Hsv : RGBWWLed::ColorMode::Raw;
+    if (!reader.hasError() &&
+        (!RGBWWLedScene::verify(_code, size, counters, mode) || !RGBWWLedScene::isInstruction(_code, size, _pc)))
+        reader.setError();
+}
+
+/**************************************************************
+ *                     Channels
+ **************************************************************/
+
+void RGBWWAnimatedChannel::saveSnapshot(RGBWWLedSnapshotWriter& writer) const {
+    writer.putInt(_value);
+    writer.putInt((_isAnimationPaused ? 1 : 0) | (_cancelAnimation ? 2 : 0) | (_clearAnimationQueue ? 4 : 0));
+
+    const RGBWWLedAnimation* current = getCurrentAnimation();
+    const bool hasCurrent = (current != nullptr && current->isSnapshotSupported());
+    writer.putBool(hasCurrent);
+    if (hasCurrent)
+        current->saveSnapshot(writer);
+
+    int count = 0;
+    for (RGBWWLedAnimation* anim = _animationQ.peek(); anim != nullptr; anim = RGBWWLedAnimationQ::next(anim)) {
+        if (anim->isSnapshotSupported())
+            ++count;
+    }
+    writer.putInt(count);
+    for (RGBWWLedAnimation* anim = _animationQ.peek(); anim != nullptr; anim = RGBWWLedAnimationQ::next(anim)) {
+        if (anim->isSnapshotSupported())
+            anim->saveSnapshot(writer);
+    }
+}
+
+bool RGBWWAnimatedChannel::restoreSnapshot(RGBWWLedSnapshotReader& reader, CtrlChannel ch,
+                                           RGBWWAnimatedChannel* channels) {
+    removeAnimations();
+
+    _value = getChannelValue(reader, ch);
+    _valueChanged = true;
+    const int flags = reader.getInt(0, 7);
+    _isAnimationPaused = (flags & 1) != 0;
+    _cancelAnimation = (flags & 2) != 0;
+    _clearAnimationQueue = (flags & 4) != 0;
+
+    if (reader.getBool()) {
+        _currentAnimation = RGBWWLedAnimation::restoreSnapshot(reader, _rgbled, ch, channels);
+        if (_currentAnimation == nullptr) {
+            removeAnimations();
+            return false;
+        }
+        _isAnimationActive = true;
+    }
+
+    const int count = reader.getInt(0, reader.getRemaining());
+    for (int i = 0; i < count && !reader.hasError(); ++i) {
+        RGBWWLedAnimation* pAnim = RGBWWLedAnimation::restoreSnapshot(reader, _rgbled, ch, channels);
+        if (pAnim == nullptr || !_animationQ.push(pAnim)) {
+            delete pAnim;
+            removeAnimations();
+            return false;
+        }
+    }
+    return !reader.hasError();
+}
+
+void RGBWWAnimatedChannel::removeAnimations() {
+    delete _currentAnimation;
+    _currentAnimation = nullptr;
+    _isAnimationActive = false;
+    _cancelAnimation = false;
+    _clearAnimationQueue = false;
+    _animationQ.clear();
+}
+
+/**************************************************************
+ *                     RGBWWLed
+ **************************************************************/
+
+size_t RGBWWLed::saveSnapshot(uint8_t* buffer, size_t size) const {
+    const bool hasHeader = (buffer != nullptr && size >= RGBWWLedSnapshot::HeaderSize);
+    RGBWWLedSnapshotWriter payload(hasHeader ? buffer + RGBWWLedSnapshot::HeaderSize : nullptr,
+                                   hasHeader ? size - RGBWWLedSnapshot::HeaderSize : 0);
+
+    payload.putInt(static_cast<int>(_mode));
+    payload.putInt(_current_color.h);
+    payload.putInt(_current_color.s);
+    payload.putInt(_current_color.v);
+    payload.putInt(_current_color.ct);
+    payload.putInt(_current_output.r);
+    payload.putInt(_current_output.g);
+    payload.putInt(_current_output.b);
+    payload.putInt(_current_output.cw);
+    payload.putInt(_current_output.ww);
+    payload.putInt(_request.id);
+    for (const RGBWWAnimatedChannel& ch : _animChannels)
+        ch.saveSnapshot(payload);
+    for (const RGBWWAnimatedChannel& ch : _jointChannels)
+        ch.saveSnapshot(payload);
+
+    const size_t snapshotSize = RGBWWLedSnapshot::HeaderSize + payload.getSize();
+    if (buffer == nullptr)
+        return snapshotSize;
+    if (!payload.isComplete())
+        return 0;
+
+    RGBWWLedSnapshotWriter header(buffer, RGBWWLedSnapshot::HeaderSize);
+    header.putBytes(SnapshotMagic, sizeof(SnapshotMagic));
+    header.putByte(RGBWWLedSnapshot::Version);
+    header.putUint32(payload.getSize());
+    header.putUint32(RGBWWLedSnapshot::checksum(payload.getData(), payload.getSize()));
+    return snapshotSize;
+}
+
+bool RGBWWLed::restoreSnapshot(const uint8_t* data, size_t size) {
+    if (data == nullptr || size < RGBWWLedSnapshot::HeaderSize)
+        return false;
+
+    RGBWWLedSnapshotReader header(data, RGBWWLedSnapshot::HeaderSize);
+    char magic[sizeof(SnapshotMagic)];
+    header.getBytes(magic, sizeof(magic));
+    const uint8_t version = header.getByte();
+    const uint32_t payloadSize = header.getUint32();
+    const uint32_t checksum = header.getUint32();
+    const uint8_t* payload = data + RGBWWLedSnapshot::HeaderSize;
+    if (memcmp(magic, SnapshotMagic, sizeof(magic)) != 0 || version != RGBWWLedSnapshot::Version ||
+        payloadSize != size - RGBWWLedSnapshot::HeaderSize ||
+        checksum != RGBWWLedSnapshot::checksum(payload, payloadSize)) {
+        debug_w("RGBWWLed::restoreSnapshot: Invalid snapshot (version %d)\n", version);
+        return false;
+    }
+
+    RGBWWLedSnapshotReader reader(payload, payloadSize);
+    _mode = static_cast<ColorMode>(reader.getInt(0, static_cast<int>(ColorMode::Raw)));
+    _current_color.h = getChannelValue(reader, CtrlChannel::Hue);
+    _current_color.s = getChannelValue(reader, CtrlChannel::Sat);
+    _current_color.v = getChannelValue(reader, CtrlChannel::Val);
+    _current_color.ct = getChannelValue(reader, CtrlChannel::ColorTemp);
+    _current_output.r = getChannelValue(reader, CtrlChannel::Red);
+    _current_output.g = getChannelValue(reader, CtrlChannel::Green);
+    _current_output.b = getChannelValue(reader, CtrlChannel::Blue);
+    _current_output.cw = getChannelValue(reader, CtrlChannel::ColdWhite);
+    _current_output.ww = getChannelValue(reader, CtrlChannel::WarmWhite);
+    _request.id = reader.getInt(0, UINT16_MAX);
+
+    // free the shared queue entries before restoring the first channel
+    for (RGBWWAnimatedChannel& ch : _animChannels)
+        ch.removeAnimations();
+    for (RGBWWAnimatedChannel& ch : _jointChannels)
+        ch.removeAnimations();
+
+    bool restored = true;
+    for (int i = static_cast<int>(CtrlChannel::Hue); i <= static_cast<int>(CtrlChannel::WarmWhite); ++i) {
+        const CtrlChannel ch = static_cast<CtrlChannel>(i);
+        restored = restored && getAnimChannel(ch).restoreSnapshot(reader, ch, nullptr);
+    }
+    restored = restored && getJointChannel(CtrlChannel::Hue)
+                               .restoreSnapshot(reader, CtrlChannel::Hue, &getAnimChannel(CtrlChannel::Hue));
+    restored = restored && getJointChannel(CtrlChannel::Red)
+                               .restoreSnapshot(reader, CtrlChannel::Red, &getAnimChannel(CtrlChannel::Red));
+
+    // the output is written with the next frame, time based animations continue with one step
+    _outputInvalid = true;
+    _stepTimeValid = false;
+
+    if (!restored || !reader.isAtEnd()) {
+        debug_w("RGBWWLed::restoreSnapshot: Restoring the animations failed\n");
+        for (RGBWWAnimatedChannel& ch : _animChannels)
+            ch.removeAnimations();
+        for (RGBWWAnimatedChannel& ch : _jointChannels)
+            ch.removeAnimations();
+        return false;
+    }
+    return true;
+}
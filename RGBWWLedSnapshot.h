@@ -0,0 +1,138 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite LEDs via PWM
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+#pragma once
+// clang-format off
+#include <Arduino.h>
+#include "RGBWWTypes.h"
+// clang-format on
+
+/**
+ * Binary snapshot of the animation state, see RGBWWLed::saveSnapshot().
+ *
+ * Layout: magic "RGBS", version (1 byte), payload size and FNV-1a checksum of the
+ * payload (4 bytes each, little endian), followed by the payload. Integers of the payload
+ * are zigzag encoded varints (1 byte for -64 .. 63), so a running fade takes a few dozen bytes.
+ * The version is incremented with every change of the payload, snapshots of other
+ * versions are rejected.
+ */
+class RGBWWLedSnapshot {
+  public:
+    static const uint8_t Version = 1;
+    static const size_t HeaderSize = 13;
+
+    /**
+     * Checksum of the payload
+     */
+    static uint32_t checksum(const uint8_t* data, size_t size);
+};
+
+/**
+ * Writes a snapshot into a buffer. Without buffer, or once the buffer is full,
+ * only the size is counted
+ */
+class RGBWWLedSnapshotWriter {
+  public:
+    /**
+     * @param buffer    destination or nullptr to count the size only
+     * @param capacity  bytes of buffer
+     */
+    RGBWWLedSnapshotWriter(uint8_t* buffer, size_t capacity) : _data(buffer), _capacity(capacity) {}
+
+    void putByte(uint8_t value);
+    void putUint32(uint32_t value); // fixed size, little endian
+    void putBool(bool value) {
+        putByte(value ? 1 : 0);
+    }
+    void putInt(int32_t value);
+    void putDouble(double value);
+    void putString(const String& value);
+    void putBytes(const void* data, size_t size);
+
+    void putValue(const AbsOrRelValue& value);
+    void putValue(const Optional<AbsOrRelValue>& value);
+    void putRamp(const RampTimeOrSpeed& ramp);
+
+    /**
+     * Bytes written (or needed if the buffer is too small)
+     */
+    size_t getSize() const {
+        return _size;
+    }
+
+    /**
+     * Check if everything fit into the buffer
+     */
+    bool isComplete() const {
+        return _data != nullptr && _size <= _capacity;
+    }
+
+    uint8_t* getData() const {
+        return _data;
+    }
+
+  private:
+    uint8_t* _data;
+    size_t _capacity;
+    size_t _size = 0;
+};
+
+/**
+ * Reads a snapshot written by RGBWWLedSnapshotWriter. Reading past the end or an
+ * invalid value sets the error flag and returns 0, the caller checks hasError() once at the end
+ */
+class RGBWWLedSnapshotReader {
+  public:
+    RGBWWLedSnapshotReader(const uint8_t* data, size_t size) : _data(data), _size(size) {}
+
+    uint8_t getByte();
+    uint32_t getUint32();
+    bool getBool() {
+        return getByte() != 0;
+    }
+    int32_t getInt();
+
+    /**
+     * Integer in the range min .. max, sets the error flag otherwise
+     */
+    int32_t getInt(int32_t min, int32_t max);
+    double getDouble();
+    String getString();
+    void getBytes(void* data, size_t size);
+
+    /**
+     * Value for a channel with the largest value max, see AbsOrRelValue::isValid()
+     */
+    AbsOrRelValue getValue(int max);
+    Optional<AbsOrRelValue> getOptionalValue(int max);
+    RampTimeOrSpeed getRamp();
+
+    /**
+     * Mark the snapshot as invalid
+     */
+    void setError() {
+        _error = true;
+    }
+
+    bool hasError() const {
+        return _error;
+    }
+
+    bool isAtEnd() const {
+        return _pos == _size;
+    }
+
+    size_t getRemaining() const {
+        return _size - _pos;
+    }
+
+  private:
+    const uint8_t* _data;
+    size_t _size;
+    size_t _pos = 0;
+    bool _error = false;
+};
@@ -0,0 +1,96 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include "RGBWWLedTimeline.h"
+// clang-format on
+
+AnimTimeline::AnimTimeline(RGBWWLed const* rgbled, RGBWWLed::ColorMode mode, int capacity, bool requeue,
+                           const String& name)
+    : AnimJoint(rgbled, (mode == RGBWWLed::ColorMode::Hsv) ? CtrlChannel::Hue : CtrlChannel::Red,
+                (mode == RGBWWLed::ColorMode::Hsv) ? 4 : 5, Type::Timeline, requeue, name) {
+    if (capacity > 0)
+        _keyframes = new Keyframe[capacity];
+    if (_keyframes != nullptr)
+        _capacity = capacity;
+}
+
+AnimTimeline::~AnimTimeline() {
+    delete[] _keyframes;
+}
+
+bool AnimTimeline::addKeyframe(const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay,
+                               HueTransitionDirection direction) {
+    if (_count >= _capacity || _ctrlChannel != CtrlChannel::Hue)
+        return false;
+
+    Keyframe& k = _keyframes[_count++];
+    k.values[0] = color.h;
+    k.values[1] = color.s;
+    k.values[2] = color.v;
+    k.values[3] = color.ct;
+    k.ramp = ramp;
+    k.stay = stay;
+    k.direction = direction;
+    return true;
+}
+
+bool AnimTimeline::addKeyframe(const RequestChannelOutput& output, const RampTimeOrSpeed& ramp, int stay) {
+    if (_count >= _capacity || _ctrlChannel != CtrlChannel::Red)
+        return false;
+
+    // same order as CtrlChannel
+    Keyframe& k = _keyframes[_count++];
+    k.values[0] = output.r;
+    k.values[1] = output.g;
+    k.values[2] = output.b;
+    k.values[3] = output.cw;
+    k.values[4] = output.ww;
+    k.ramp = ramp;
+    k.stay = stay;
+    return true;
+}
+
+bool AnimTimeline::startKeyframe() {
+    if (_keyframe >= _count)
+        return false;
+
+    const Keyframe& k = _keyframes[_keyframe];
+    initFade(k.values, nullptr, k.ramp, k.stay, k.direction);
+    return true;
+}
+
+bool AnimTimeline::run() {
+    if (!isFadeStarted() && !startKeyframe())
+        return true;
+
+    if (!runFade())
+        return false;
+    return ++_keyframe >= _count;
+}
+
+bool AnimTimeline::advance(int& steps) {
+    while (steps > 0) {
+        if (!isFadeStarted() && !startKeyframe())
+            return true;
+
+        if (!advanceFade(steps))
+            return false;
+        if (++_keyframe >= _count)
+            return true;
+    }
+    return false;
+}
+
+int AnimTimeline::stepsToNextChange() const {
+    return isFadeStarted() ? fadeStepsToNextChange() : 1;
+}
+
+void AnimTimeline::reset() {
+    _keyframe = 0;
+    resetFade();
+}
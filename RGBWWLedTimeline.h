@@ -0,0 +1,91 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite LEDs via PWM
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+#pragma once
+// clang-format off
+#include "RGBWWLed.h"
+#include "RGBWWLedAnimation.h"
+// clang-format on
+
+/**
+ * Sequence of keyframes for all channels of a color mode.
+ *
+ * Replaces a chain of queued fades (i.e. fadeHSV() with QueuePolicy::Back):
+ * one animation with all keyframes in a single array, evaluated once per frame
+ * for all channels, instead of one animation per channel and keyframe.
+ *
+ * Each keyframe fades from the values of the previous one (the current values
+ * for the first keyframe) and stays for its stay time, see AnimJoint for the fade.
+ *
+ * Usage:
+ *   AnimTimeline* timeline = new AnimTimeline(&rgbled, RGBWWLed::ColorMode::Hsv, 3);
+ *   timeline->addKeyframe(RequestHSVCT(...), RampTimeOrSpeed(1000), 500);
+ *   ...
+ *   rgbled.pushJointAnimation(timeline);
+ */
+class AnimTimeline : public AnimJoint {
+  public:
+    struct Keyframe {
+        Optional<AbsOrRelValue> values[MaxChannels]; // in the order of CtrlChannel
+        RampTimeOrSpeed ramp;
+        int stay = 0; // ms
+        HueTransitionDirection direction = HueTransitionDirection::dir_short;
+    };
+
+    /**
+     * @param mode      channels of the timeline
+     * @param capacity  maximum number of keyframes, allocated at once
+     */
+    AnimTimeline(RGBWWLed const* rgbled, RGBWWLed::ColorMode mode, int capacity, bool requeue = false,
+                 const String& name = "");
+    virtual ~AnimTimeline();
+
+    /**
+     * Append a keyframe, channels without value keep their value
+     *
+     * @retval true     keyframe added
+     * @retval false    timeline is full or not in HSV mode
+     */
+    bool addKeyframe(const RequestHSVCT& color, const RampTimeOrSpeed& ramp, int stay = 0,
+                     HueTransitionDirection direction = HueTransitionDirection::dir_short);
+
+    /**
+     * Append a keyframe, channels without value keep their value
+     *
+     * @retval true     keyframe added
+     * @retval false    timeline is full or not in raw mode
+     */
+    bool addKeyframe(const RequestChannelOutput& output, const RampTimeOrSpeed& ramp, int stay = 0);
+
+    int getKeyframeCount() const {
+        return _count;
+    }
+
+    int getCapacity() const {
+        return _capacity;
+    }
+
+    virtual bool run() override;
+    virtual bool advance(int& steps) override;
+    virtual int stepsToNextChange() const override;
+    virtual void reset() override;
+
+  protected:
+    virtual SnapshotClass getSnapshotClass() const override {
+        return SnapshotClass::Timeline;
+    }
+    virtual void saveState(RGBWWLedSnapshotWriter& writer) const override;
+    virtual void loadState(RGBWWLedSnapshotReader& reader) override;
+
+  private:
+    bool startKeyframe();
+
+    Keyframe* _keyframes = nullptr;
+    int _capacity = 0;
+    int _count = 0;
+    int _keyframe = 0; // current keyframe
+};
@@ -2,3 +2,151 @@
 
 int AbsOrRelValue::colorTempWarm = 2700;
 int AbsOrRelValue::colorTempCold = 6500;
+
+CtrlChannel ctrlChannelFromString(const char* str, int length) {
+    // all names have one or two characters, see ctrlChannelNames
+    if (length == 1) {
+        switch (str[0]) {
+        case 'h':
+            return CtrlChannel::Hue;
+        case 's':
+            return CtrlChannel::Sat;
+        case 'v':
+            return CtrlChannel::Val;
+        case 'r':
+            return CtrlChannel::Red;
+        case 'g':
+            return CtrlChannel::Green;
+        case 'b':
+            return CtrlChannel::Blue;
+        default:
+            break;
+        }
+    } else if (length == 2) {
+        if (str[0] == 'c' && str[1] == 't')
+            return CtrlChannel::ColorTemp;
+        if (str[0] == 'c' && str[1] == 'w')
+            return CtrlChannel::ColdWhite;
+        if (str[0] == 'w' && str[1] == 'w')
+            return CtrlChannel::WarmWhite;
+    }
+    return CtrlChannel::None;
+}
+
+bool parseCtrlChannels(const char* str, int length, uint16_t& mask) {
+    mask = 0;
+    const char* end = str + length;
+    while (str < end) {
+        if (*str == ',' || *str == ' ') {
+            ++str;
+            continue;
+        }
+
+        const char* name = str;
+        while (str < end && *str != ',' && *str != ' ')
+            ++str;
+        const CtrlChannel ch = ctrlChannelFromString(name, str - name);
+        if (ch == CtrlChannel::None)
+            return false;
+        mask |= ctrlChannelBit(ch);
+    }
+    return true;
+}
+
+int AbsOrRelValue::getMaxValue(Type type) {
+    switch (type) {
+    case Type::Hue:
+        return RGBWW_CALC_HUEWHEELMAX - 1;
+    case Type::Ct:
+        return UINT16_MAX;
+    default:
+        return RGBWW_CALC_MAXVAL;
+    }
+}
+
+bool parseDecimal(const char* str, int length, int32_t& mantissa, int& decimals, int maxDecimals) {
+    mantissa = 0;
+    decimals = 0;
+    int digits = 0;
+    bool point = false;
+    for (int i = 0; i < length; ++i) {
+        const char c = str[i];
+        if (c == '.' && !point) {
+            point = true;
+            continue;
+        }
+        if (c < '0' || c > '9')
+            return false;
+        if (point && decimals == maxDecimals)
+            continue;
+        if (digits == 9)
+            return false;
+
+        mantissa = mantissa * 10 + (c - '0');
+        ++digits;
+        if (point)
+            ++decimals;
+    }
+    return digits > 0;
+}
+
+bool parseDecimalFloat(const char* str, int length, float& value) {
+    static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8};
+
+    int32_t mantissa;
+    int decimals;
+    if (!parseDecimal(str, length, mantissa, decimals, 8))
+        return false;
+
+    // decimals which do not fit into the mantissa would change the float
+    const char* point = static_cast<const char*>(memchr(str, '.', length));
+    if (point != nullptr && str + length - point - 1 > decimals)
+        return false;
+
+    // the decimal number rounded to double, as one division of exact values, then to float
+    value = float(mantissa / pow10[decimals]);
+    return true;
+}
+
+bool AbsOrRelValue::parse(const char* str, int length, Type type, AbsOrRelValue& value) {
+    while (length > 0 && *str == ' ') {
+        ++str;
+        --length;
+    }
+    while (length > 0 && str[length - 1] == ' ')
+        --length;
+
+    Mode mode = Mode::Absolute;
+    bool negative = false;
+    if (length > 0 && (*str == '+' || *str == '-')) {
+        mode = Mode::Relative;
+        negative = (*str == '-');
+        ++str;
+        --length;
+    }
+
+    float number;
+    if (!parseDecimalFloat(str, length, number))
+        return false;
+
+    // scaled and rounded like setValueByType()
+    switch (type) {
+    case Type::Hue:
+        number = (number / 360.0) * RGBWW_CALC_HUEWHEELMAX;
+        break;
+    case Type::Percent:
+        number = (number / 100.0) * RGBWW_CALC_MAXVAL;
+        break;
+    default:
+        break;
+    }
+
+    int result = static_cast<int>(number + 0.5f);
+    if (negative)
+        result = -result;
+
+    value._type = type;
+    value._mode = mode;
+    value._value = (mode == Mode::Relative) ? result : value.fixRangeLimits(result);
+    return true;
+}
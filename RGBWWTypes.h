@@ -1,6 +1,7 @@
 #pragma once
 
 #include "RGBWWconst.h"
+#include "RGBWWLedEasing.h"
 
 struct RampTimeOrSpeed {
     enum class Type { Speed, Time };
@@ -11,10 +12,35 @@ struct RampTimeOrSpeed {
 
     RampTimeOrSpeed(double v, Type t) : value(v), type(t) {}
 
-    double value = 0.0; // Speed: percent/degree per second
+    RampTimeOrSpeed(double v, Easing e) : value(v), easing(e) {}
+
+    RampTimeOrSpeed(double v, Type t, Easing e) : value(v), type(t), easing(e) {}
+
+    double value = 0.0; // Speed: percent/degree per second (average speed for eased ramps)
     Type type = Type::Time;
+    Easing easing = Easing::Linear;
 };
 
+/**
+ * Parse an unsigned decimal number without allocations, i.e. "12.5" gives mantissa 125
+ * and decimals 1. Up to maxDecimals decimals are used, further decimals are ignored
+ *
+ * @param str           number, does not need to be terminated
+ * @param length        characters of str
+ * @param maxDecimals   at most 8, the mantissa has at most 9 digits
+ * @retval false        empty, malformed or more than 9 digits
+ */
+bool parseDecimal(const char* str, int length, int32_t& mantissa, int& decimals, int maxDecimals = 3);
+
+/**
+ * Parse an unsigned decimal number to the same float as String::toFloat(), without allocations
+ *
+ * @param str       number, does not need to be terminated
+ * @param length    characters of str
+ * @retval false    empty, malformed or more than 9 digits
+ */
+bool parseDecimalFloat(const char* str, int length, float& value);
+
 class AbsOrRelValue {
   public:
     enum class Type {
@@ -65,6 +91,13 @@ class AbsOrRelValue {
         _value = value;
     }
 
+    /**
+     * Accepts CHANNEL output range value, the type limits the final value of relative values
+     */
+    AbsOrRelValue(int value, Mode mode, Type type) : _mode(mode), _type(type) {
+        _value = value;
+    }
+
     /**
      * Accepts INPUT range, will be converted to output range value
      */
@@ -72,6 +105,36 @@ class AbsOrRelValue {
         setValueByType(value);
     }
 
+    /**
+     * Parse a value like the String constructor, without allocations:
+     * [+|-]digits[.digits], '+' and '-' mark relative values, surrounding spaces are ignored.
+     * Relative values are rounded symmetrically ("-5" is -5)
+     *
+     * @param str       value in the input range of type, does not need to be terminated
+     * @param length    characters of str
+     * @param value     result, unchanged if the value is malformed
+     * @retval true     parsed
+     * @retval false    empty or malformed
+     */
+    static bool parse(const char* str, int length, Type type, AbsOrRelValue& value);
+
+    /**
+     * Largest absolute value of a type in the output range. Color temperatures
+     * are checked against the white points when used, they are only limited to 16 bit
+     */
+    static int getMaxValue(Type type);
+
+    /**
+     * Check if an absolute value is in the range of a channel and a relative value
+     * within the width of the range, i.e. for values read from a snapshot. Values
+     * constructed from an int keep the default type, so the range comes from the channel
+     *
+     * @param max   largest value of the channel, see getMaxValue()
+     */
+    bool isValid(int max) const {
+        return (_mode == Mode::Relative) ? (_value >= -max && _value <= max) : (_value >= 0 && _value <= max);
+    }
+
     bool operator==(const AbsOrRelValue& obj) const {
         return (_mode == obj.getMode()) && (this->_value == obj.getValue());
     }
@@ -221,25 +284,52 @@ enum class CtrlChannel {
     WarmWhite,
 };
 
+/**
+ * Names of the channels, indexed by CtrlChannel
+ */
+constexpr const char* const ctrlChannelNames[] = {"None", "h", "s", "v", "ct", "r", "g", "b", "cw", "ww"};
+
+/**
+ * Name of a channel, without allocation
+ */
+constexpr const char* ctrlChannelName(CtrlChannel ch) {
+    return ctrlChannelNames[static_cast<int>(ch)];
+}
+
 inline String ctrlChannelToString(CtrlChannel ch) {
-    HashMap<CtrlChannel, String> strMap;
-    strMap[CtrlChannel::None] = "None";
-    strMap[CtrlChannel::Hue] = "h";
-    strMap[CtrlChannel::Sat] = "s";
-    strMap[CtrlChannel::Val] = "v";
-    strMap[CtrlChannel::ColorTemp] = "ct";
-
-    strMap[CtrlChannel::Red] = "r";
-    strMap[CtrlChannel::Green] = "g";
-    strMap[CtrlChannel::Blue] = "b";
-    strMap[CtrlChannel::ColdWhite] = "cw";
-    strMap[CtrlChannel::WarmWhite] = "ww";
-
-    return strMap[ch];
+    return ctrlChannelName(ch);
 }
 
+/**
+ * Channel of a name, the inverse of ctrlChannelName()
+ *
+ * @param str       name, does not need to be terminated
+ * @param length    characters of str
+ * @return CtrlChannel, CtrlChannel::None for unknown names
+ */
+CtrlChannel ctrlChannelFromString(const char* str, int length);
+
+/**
+ * Bit of a channel in a channel mask
+ */
+inline uint16_t ctrlChannelBit(CtrlChannel ch) {
+    return uint16_t(1) << static_cast<int>(ch);
+}
+
+/**
+ * Parse a set of channel names like "h,s,v" (separated by ',' or ' ') without allocations
+ *
+ * @param mask      ctrlChannelBit() of the channels
+ * @retval false    unknown channel name, mask holds the channels before it
+ */
+bool parseCtrlChannels(const char* str, int length, uint16_t& mask);
+
+// zero until the fade starts, so a snapshot of a queued fade holds no stale values
 struct BresenhamValues {
-    int delta, error, count, step;
+    int delta = 0;
+    int error = 0;
+    int count = 0;
+    int step = 0;
 };
 
 enum class QueuePolicy {
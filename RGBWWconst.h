@@ -27,10 +27,32 @@
 #define RGBWW_UPDATEFREQUENCY 50
 #define RGBWW_MINTIMEDIFF int(1000 / RGBWW_UPDATEFREQUENCY)
 #define RGBWW_MINTIMEDIFF_US RGBWW_MINTIMEDIFF * 1000
-#define RGBWW_ANIMATIONQSIZE 100
+#define RGBWW_STEPTIME 5             // ms per animation step, shortest useful frame interval
+#define RGBWW_MAXFRAMEINTERVAL 1000  // longest frame interval suggested while animating
+#define RGBWW_FRAMELATETOLERANCE 5   // ms a frame may arrive after its deadline before it counts as late
+#define RGBWW_ANIMATIONQSIZE 100   // max. animations queued per channel
+#define RGBWW_ANIMATIONQBUDGET 100 // max. animations queued in all channels of one controller
+#define RGBWW_ANIMATIONPOOLSIZE RGBWW_ANIMATIONQBUDGET      // small animations (fades, blinks) shared by all controllers
+#define RGBWW_ANIMATIONPOOLLARGE (RGBWW_ANIMATIONQBUDGET / 5) // large animations (joint fades, timelines, scenes)
+#define RGBWW_ANIMATIONNAMES 16    // distinct animation names in use at the same time (max. 255)
+#define RGBWW_PERSISTQUIETPERIOD 3000 // ms without changes before RGBWWLedPersistence saves the state
+#define RGBWW_PERSISTMININTERVAL 10000 // min. ms between two saves of RGBWWLedPersistence
 #define RGBWW_WARMWHITEKELVIN 2700
 #define RGBWW_COLDWHITEKELVIN 6000
 
+// Build with -DRGBWW_ENABLE_PROFILING for the timing counters of RGBWWLed::getProfiler() and the
+// queue high water marks. Define RGBWW_PROFILE_TICKS() to measure with another counter
+#ifndef RGBWW_PROFILEINTERVAL
+#define RGBWW_PROFILEINTERVAL 128 // one of this many frames is measured, 1 measures every frame
+#endif
+#ifndef RGBWW_PROFILE_TICKS
+#ifdef SMING_VERSION
+#define RGBWW_PROFILE_TICKS() esp_get_ccount() // CPU cycles
+#else
+#define RGBWW_PROFILE_TICKS() micros()
+#endif
+#endif
+
 #if RGBWW_CALC_DEPTH == 8
 
 #if RGBWW_PWMRESOLUTION == 256
@@ -0,0 +1,724 @@
+#include <RGBWWLed.h>
+#include <RGBWWLedGroup.h>
+#include <RGBWWLedTimeline.h>
+#include <RGBWWLedScene.h>
+#include <RGBWWLedSnapshot.h>
+#include <RGBWWLedRenderer.h>
+
+// Measures the cost of RGBWWLed::show() per frame for a couple of typical
+// animation queues (RGBWWAnimatedChannel -> RGBWWColorUtils -> PWMOutput).
+// Results are printed to the serial console:
+//   ns/frame    average time spent in show()
+//   writes      frames which changed the PWM output
+//   heap/frame  average decrease of free heap per frame in bytes (above 0 means show()
+//               keeps allocations, below 0 that finished animations were freed)
+//   pool/frame  animations per frame which did not fit into the animation pool and were
+//               allocated on the heap, also those freed again within the frame, which
+//               the heap change does not see
+//
+// Only timing and memory of the device, the behavior is checked by the host tests in test/
+
+#define BLUEPIN 14
+#define GREENPIN 12
+#define REDPIN 13
+#define WWPIN 5
+#define CWPIN 4
+
+#define BENCH_FRAMES 2000
+
+RGBWWLed rgbled;
+
+typedef void (*SetupFunc)(RGBWWLed& led);
+
+void setupIdle(RGBWWLed& led) {
+  led.colorDirectHSV(RequestHSVCT(HSVCT(0, 1023, 1023)));
+}
+
+void setupFadeHSV(RGBWWLed& led) {
+  // long chain of hue fades, the queue never runs empty during the benchmark
+  for (int i = 0; i < 10; ++i) {
+    HSVCT c((i * RGBWW_CALC_HUEWHEELMAX) / 10, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL, 2700 + i * 300);
+    led.fadeHSV(RequestHSVCT(c), RampTimeOrSpeed(4000), 0, HueTransitionDirection::dir_short, QueuePolicy::Back);
+  }
+}
+
+void setupFadeHSVEased(RGBWWLed& led) {
+  for (int i = 0; i < 10; ++i) {
+    HSVCT c((i * RGBWW_CALC_HUEWHEELMAX) / 10, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL, 2700 + i * 300);
+    led.fadeHSV(RequestHSVCT(c), RampTimeOrSpeed(4000, Easing::InOut), 0, HueTransitionDirection::dir_short,
+                QueuePolicy::Back);
+  }
+}
+
+void setupFadeHSVJoint(RGBWWLed& led) {
+  for (int i = 0; i < 10; ++i) {
+    HSVCT c((i * RGBWW_CALC_HUEWHEELMAX) / 10, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL, 2700 + i * 300);
+    led.fadeHSVJoint(RequestHSVCT(c), RampTimeOrSpeed(4000), 0, HueTransitionDirection::dir_short, QueuePolicy::Back);
+  }
+}
+
+void setupTimeline(RGBWWLed& led) {
+  // the fades of setupFadeHSV as keyframes of one animation
+  AnimTimeline* timeline = new AnimTimeline(&led, RGBWWLed::ColorMode::Hsv, 10);
+  for (int i = 0; i < 10; ++i) {
+    HSVCT c((i * RGBWW_CALC_HUEWHEELMAX) / 10, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL, 2700 + i * 300);
+    timeline->addKeyframe(RequestHSVCT(c), RampTimeOrSpeed(4000));
+  }
+  led.pushJointAnimation(timeline, QueuePolicy::Back);
+}
+
+// the fades of setupFadeHSV as scene, compiled once in setup()
+RGBWWLedScene scene;
+
+bool compileScene() {
+  String text;
+  for (int i = 0; i < 10; ++i) {
+    text += "fade h=";
+    text += String(i * 36);
+    text += " s=100 v=100 ct=";
+    text += String(2700 + i * 300);
+    text += " time=4000\n";
+  }
+  return scene.compile(text.c_str());
+}
+
+void setupScene(RGBWWLed& led) {
+  led.playScene(scene, QueuePolicy::Back);
+}
+
+void setupFadeRAW(RGBWWLed& led) {
+  for (int i = 0; i < 10; ++i) {
+    const int v = (i % 2) ? RGBWW_CALC_MAXVAL : 0;
+    ChannelOutput o(v, RGBWW_CALC_MAXVAL - v, v, RGBWW_CALC_MAXVAL - v, v);
+    led.fadeRAW(RequestChannelOutput(o), RampTimeOrSpeed(4000), 0, QueuePolicy::Back);
+  }
+}
+
+void setupBlink(RGBWWLed& led) {
+  setupIdle(led);
+  led.blink(RGBWWLed::ChannelList(), 200, QueuePolicy::Back, true);
+}
+
+void runBenchmark(const char* name, SetupFunc setupFunc) {
+  rgbled.clearAnimationQueue();
+  rgbled.skipAnimation();
+  rgbled.show();
+
+  setupFunc(rgbled);
+  // let the first animations initialize
+  rgbled.show();
+
+  const AnimationPoolStats& pool = RGBWWLed::getAnimationPoolStats();
+  const int poolHeapBefore = pool.heap;
+  const int poolFailedBefore = pool.failed;
+  const uint32_t heapBefore = system_get_free_heap_size();
+  const uint32_t start = micros();
+  int writes = 0;
+  for (int i = 0; i < BENCH_FRAMES; ++i) {
+    if (rgbled.show().outputChanged)
+      ++writes;
+  }
+  const uint32_t elapsed = micros() - start;
+  const int32_t heapDiff = int32_t(heapBefore) - int32_t(system_get_free_heap_size());
+  const int poolHeap = pool.heap - poolHeapBefore;
+  const int poolFailed = pool.failed - poolFailedBefore;
+
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(uint32_t((uint64_t(elapsed) * 1000) / BENCH_FRAMES));
+  Serial.print(" ns/frame, ");
+  Serial.print(writes);
+  Serial.print(" writes, ");
+  Serial.print(float(heapDiff) / BENCH_FRAMES);
+  Serial.print(" heap/frame, ");
+  Serial.print(float(poolHeap) / BENCH_FRAMES);
+  Serial.print(" pool/frame");
+  if (poolFailed > 0) {
+    Serial.print(", ");
+    Serial.print(poolFailed);
+    Serial.print(" failed");
+  }
+  Serial.println();
+}
+
+#ifdef RGBWW_ENABLE_PROFILING
+// Time per stage of show() in ticks of RGBWW_PROFILE_TICKS() (CPU cycles with Sming) and
+// the cost of the measurement itself per frame, compared to the mean frame.
+// Only one of RGBWW_PROFILEINTERVAL frames is measured, max and percentiles are sampled
+void runProfile(const char* name, SetupFunc setupFunc) {
+  rgbled.clearAnimationQueue();
+  rgbled.skipAnimation();
+  rgbled.show();
+  setupFunc(rgbled);
+  rgbled.show();
+  rgbled.resetProfiling();
+
+  // queue the animations again whenever they finished
+  for (int i = 0; i < BENCH_FRAMES * RGBWW_PROFILEINTERVAL; ++i) {
+    if (rgbled.show().nextFrame == 0)
+      setupFunc(rgbled);
+    if ((i % 1000) == 0)
+      yield();
+  }
+
+  const RGBWWLedProfiler& profiler = rgbled.getProfiler();
+  for (int i = 0; i < RGBWWLedProfiler::StageCount; ++i) {
+    const RGBWWLedProfiler::Stage stage = static_cast<RGBWWLedProfiler::Stage>(i);
+    const ProfileStats& stats = profiler.getStats(stage);
+    Serial.print("profile ");
+    Serial.print(name);
+    Serial.print(" ");
+    Serial.print(RGBWWLedProfiler::getStageName(stage));
+    Serial.print(": mean ");
+    Serial.print(stats.mean());
+    Serial.print(", p50 ");
+    Serial.print(profiler.getPercentile(stage, 50));
+    Serial.print(", p99 ");
+    Serial.print(profiler.getPercentile(stage, 99));
+    Serial.print(", max ");
+    Serial.println(stats.max);
+  }
+
+  Serial.print("profile ");
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(profiler.getStats(RGBWWLedProfiler::Stage::Frame).count);
+  Serial.print(" of ");
+  Serial.print(BENCH_FRAMES * RGBWW_PROFILEINTERVAL);
+  Serial.println(" frames measured");
+
+  Serial.print("profile ");
+  Serial.print(name);
+  Serial.print(" queue high water: hue ");
+  Serial.print(rgbled.getQueueHighWater(CtrlChannel::Hue));
+  Serial.print(", red ");
+  Serial.print(rgbled.getQueueHighWater(CtrlChannel::Red));
+  Serial.print(", joint hsv ");
+  Serial.println(rgbled.getJointQueueHighWater(RGBWWLed::ColorMode::Hsv));
+
+  // the profiler calls of show() on their own, measured and skipped frames
+  RGBWWLedProfiler* probe = new RGBWWLedProfiler();
+  const int probeFrames = BENCH_FRAMES * RGBWW_PROFILEINTERVAL;
+  const uint32_t start = RGBWW_PROFILE_TICKS();
+  for (int i = 0; i < probeFrames; ++i) {
+    probe->beginFrame();
+    probe->lap(RGBWWLedProfiler::Stage::Channels);
+    probe->lap(RGBWWLedProfiler::Stage::HsvToRgb);
+    probe->lap(RGBWWLedProfiler::Stage::WhiteBalance);
+    probe->lap(RGBWWLedProfiler::Stage::Brightness);
+    probe->lap(RGBWWLedProfiler::Stage::Output);
+    probe->endFrame();
+  }
+  const uint32_t overhead = uint64_t(RGBWW_PROFILE_TICKS() - start) * 100 / probeFrames;
+  delete probe;
+
+  const uint32_t frame = profiler.getStats(RGBWWLedProfiler::Stage::Frame).mean();
+  Serial.print("profile ");
+  Serial.print(name);
+  Serial.print(" overhead: ");
+  Serial.print(overhead / 100.0f);
+  Serial.print(" ticks/frame, ");
+  Serial.print((frame > 0) ? float(overhead) / frame : 0.0f);
+  Serial.println("% of a frame");
+}
+#endif
+
+// Simulated clock of the day profile
+uint32_t simClock = 0;
+
+uint32_t getSimClock() {
+  return simClock;
+}
+
+// Typical day of a fixture: sunrise, a few quick scenes, a slow evening fade
+const uint32_t dayEventTimes[] = {6 * 3600, 7 * 3600, 7 * 3600 + 1800, 18 * 3600, 18 * 3600 + 300, 20 * 3600, 21 * 3600, 23 * 3600};
+const int dayEvents = sizeof(dayEventTimes) / sizeof(dayEventTimes[0]);
+
+void queueDayEvent(int event) {
+  const HueTransitionDirection dir = HueTransitionDirection::dir_short;
+  switch (event) {
+  case 0:
+    rgbled.fadeHSV(RequestHSVCT(HSVCT(0, 0, RGBWW_CALC_MAXVAL, 2700)), RampTimeOrSpeed(30 * 60000), 0, dir, QueuePolicy::Single);
+    break;
+  case 1:
+    rgbled.fadeHSV(RequestHSVCT(HSVCT(0, 0, RGBWW_CALC_MAXVAL, 5000)), RampTimeOrSpeed(5000), 0, dir, QueuePolicy::Single);
+    break;
+  case 2:
+  case 7:
+    rgbled.fadeHSV(RequestHSVCT(HSVCT(0, 0, 0, 5000)), RampTimeOrSpeed(event == 2 ? 10000 : 20 * 60000), 0, dir, QueuePolicy::Single);
+    break;
+  case 3:
+    rgbled.fadeHSV(RequestHSVCT(HSVCT(200, 800, RGBWW_CALC_MAXVAL, 4000)), RampTimeOrSpeed(2000), 0, dir, QueuePolicy::Single);
+    break;
+  case 4:
+    for (int i = 1; i <= 5; ++i) {
+      HSVCT c((i * RGBWW_CALC_HUEWHEELMAX) / 6, 800, RGBWW_CALC_MAXVAL, 4000);
+      rgbled.fadeHSV(RequestHSVCT(c), RampTimeOrSpeed(1000), 0, dir, QueuePolicy::Back);
+    }
+    break;
+  case 5:
+    rgbled.fadeHSV(RequestHSVCT(HSVCT(200, 300, 700, 2700)), RampTimeOrSpeed(2 * 3600000), 0, dir, QueuePolicy::Single);
+    break;
+  case 6:
+    rgbled.blink(RGBWWLed::ChannelList(), 500, QueuePolicy::Front, false);
+    break;
+  }
+}
+
+// CPU time spent in show() over a simulated day: fixed 50 Hz frames vs.
+// adaptive frames (time based, next frame after FrameResult::nextFrame ms, none while idle)
+// test/test_timing.cpp checks that both show the same colors
+void runDayProfile(bool adaptive) {
+  rgbled.clearAnimationQueue();
+  rgbled.skipAnimation();
+  rgbled.show();
+  rgbled.colorDirectHSV(RequestHSVCT(HSVCT(0, 0, 0, 2700)));
+  rgbled.setTimeBased(adaptive, getSimClock);
+  simClock = 0;
+
+  const uint32_t dayEnd = 24 * 3600 * 1000UL;
+  int event = 0;
+  uint32_t frames = 0;
+  uint32_t busy = 0;
+  while (simClock < dayEnd) {
+    if (event < dayEvents && simClock >= dayEventTimes[event] * 1000) {
+      queueDayEvent(event++);
+    }
+
+    const uint32_t start = micros();
+    const RGBWWLed::FrameResult result = rgbled.show();
+    busy += micros() - start;
+    if ((++frames % 1000) == 0)
+      yield();
+
+    uint32_t next = simClock + (adaptive ? result.nextFrame : RGBWW_MINTIMEDIFF);
+    if (adaptive && result.nextFrame == 0) {
+      // idle until the next event
+      next = (event < dayEvents) ? dayEventTimes[event] * 1000 : dayEnd;
+    } else if (event < dayEvents) {
+      next = min(next, dayEventTimes[event] * 1000);
+    }
+    simClock = next;
+  }
+
+  Serial.print(adaptive ? "day profile, adaptive: " : "day profile, 50 Hz: ");
+  Serial.print(frames);
+  Serial.print(" frames, ");
+  Serial.print(busy / 1000);
+  Serial.println(" ms in show()");
+
+  rgbled.setTimeBased(false);
+}
+
+// Memory needed by one controller instance
+void runFootprint() {
+  const uint32_t heapBefore = system_get_free_heap_size();
+  RGBWWLed* led = new RGBWWLed();
+  const uint32_t heapUsed = heapBefore - system_get_free_heap_size();
+  delete led;
+
+  Serial.print("footprint: ");
+  Serial.print(heapUsed);
+  Serial.print(" bytes per instance (sizeof ");
+  Serial.print(sizeof(RGBWWLed));
+  Serial.println(")");
+
+  // allocated once and shared by all instances
+  const RGBWWLedAnimationPool& pool = RGBWWLedAnimation::getPool();
+  Serial.print("animation pool: ");
+  Serial.print(pool.getStats().bytes);
+  Serial.print(" bytes, ");
+  Serial.print(pool.getSlots(RGBWWLedAnimationPool::Small));
+  Serial.print(" x ");
+  Serial.print(pool.getSlotSize(RGBWWLedAnimationPool::Small));
+  Serial.print(" + ");
+  Serial.print(pool.getSlots(RGBWWLedAnimationPool::Large));
+  Serial.print(" x ");
+  Serial.println(pool.getSlotSize(RGBWWLedAnimationPool::Large));
+}
+
+// Cost of RGBWWLedGroup::show() per fixture with all fixtures fading.
+// Big groups do not fit into the RAM of the ESP8266, they are meant for the host
+void runGroupBenchmark(int fixtures) {
+  RGBWWLedGroup group;
+  Serial.print("group ");
+  Serial.print(fixtures);
+  Serial.print(": ");
+  if (!group.init(fixtures)) {
+    Serial.println("out of memory");
+    return;
+  }
+
+  for (int i = 0; i < fixtures; ++i) {
+    HSVCT c((i * 97) % RGBWW_CALC_HUEWHEELMAX, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL, 2700 + i % 3000);
+    group.fadeHSV(i, RequestHSVCT(c), RampTimeOrSpeed(60000));
+  }
+
+  const int frames = 100;
+  const uint32_t start = micros();
+  for (int i = 0; i < frames; ++i) {
+    group.show();
+    yield();
+  }
+  const uint32_t elapsed = micros() - start;
+
+  Serial.print(uint32_t((uint64_t(elapsed) * 1000) / (uint64_t(frames) * fixtures)));
+  Serial.println(" ns/fixture/frame");
+}
+
+// Time per HSV to RGB conversion, calculated vs. table driven (RGBWWColorUtils::setHSVlut()).
+// test/test_color.cpp checks that both give the same colors
+void runConversionBenchmark(RGBWW_HSVMODEL model) {
+  RGBWWColorUtils calc;
+  RGBWWColorUtils lut;
+  calc.setHSVmodel(model);
+  lut.setHSVmodel(model);
+  lut.setHSVlut(true);
+
+  // volatile keeps the compiler from dropping the loops
+  volatile int sum = 0;
+  uint32_t timeCalc = 0;
+  uint32_t timeLut = 0;
+  uint32_t conversions = 0;
+  RGBWCT c;
+  for (int sat = 0; sat <= RGBWW_CALC_MAXVAL; sat += RGBWW_CALC_MAXVAL / 4) {
+    for (int val = 0; val <= RGBWW_CALC_MAXVAL; val += RGBWW_CALC_MAXVAL / 4) {
+      uint32_t start = micros();
+      for (int hue = 0; hue < RGBWW_CALC_HUEWHEELMAX; ++hue) {
+        calc.HSVtoRGB(HSVCT(hue, sat, val), c);
+        sum += c.r;
+      }
+      timeCalc += micros() - start;
+
+      start = micros();
+      for (int hue = 0; hue < RGBWW_CALC_HUEWHEELMAX; ++hue) {
+        lut.HSVtoRGB(HSVCT(hue, sat, val), c);
+        sum += c.r;
+      }
+      timeLut += micros() - start;
+      conversions += RGBWW_CALC_HUEWHEELMAX;
+      yield();
+    }
+  }
+
+  Serial.print("HSV model ");
+  Serial.print(model);
+  Serial.print(": calculated ");
+  Serial.print(uint32_t((uint64_t(timeCalc) * 1000) / conversions));
+  Serial.print(" ns, table ");
+  Serial.print(uint32_t((uint64_t(timeLut) * 1000) / conversions));
+  Serial.println(" ns");
+}
+
+// Time per RAW conversion of colors in random order, single vs. batch conversion of arrays
+// of structs and of separate arrays. test/test_color.cpp checks that all give the same colors.
+// The host learns the branches of the single conversion for a few colors converted again
+// and again, many colors do not fit into the RAM of the ESP8266
+void runBatchBenchmark(int count) {
+  Serial.print("batch RAW ");
+  Serial.print(count);
+  Serial.print(": ");
+
+  HSVCT* colors = new HSVCT[count];
+  int* hue = new int[count];
+  int* sat = new int[count];
+  int* val = new int[count];
+  int* ct = new int[count];
+  RGBWCT* out = new RGBWCT[count];
+  if (colors == nullptr || hue == nullptr || sat == nullptr || val == nullptr || ct == nullptr || out == nullptr) {
+    Serial.println("out of memory");
+    delete[] colors;
+    delete[] hue;
+    delete[] sat;
+    delete[] val;
+    delete[] ct;
+    delete[] out;
+    return;
+  }
+
+  uint32_t random = 4711;
+  for (int i = 0; i < count; ++i) {
+    random = random * 1103515245 + 12345;
+    colors[i] = HSVCT(int((random >> 8) % RGBWW_CALC_HUEWHEELMAX), int((random >> 4) % (RGBWW_CALC_MAXVAL + 1)),
+                      int((random >> 12) % (RGBWW_CALC_MAXVAL + 1)), 2700);
+    hue[i] = colors[i].h;
+    sat[i] = colors[i].s;
+    val[i] = colors[i].v;
+    ct[i] = colors[i].ct;
+  }
+
+  RGBWWColorUtils utils;
+  volatile int sum = 0;
+  const int rounds = 25600 / count + 1;
+  uint32_t start = micros();
+  for (int round = 0; round < rounds; ++round) {
+    for (int i = 0; i < count; ++i)
+      utils.HSVtoRGB(colors[i], out[i]);
+    sum += out[round % count].r;
+  }
+  const uint32_t timeSingle = micros() - start;
+  yield();
+
+  start = micros();
+  for (int round = 0; round < rounds; ++round) {
+    utils.HSVtoRGB(colors, out, count);
+    sum += out[round % count].r;
+  }
+  const uint32_t timeStructs = micros() - start;
+  yield();
+
+  start = micros();
+  for (int round = 0; round < rounds; ++round) {
+    utils.HSVtoRGB(hue, sat, val, ct, out, count);
+    sum += out[round % count].r;
+  }
+  const uint32_t timeArrays = micros() - start;
+
+  const uint64_t conversions = uint64_t(rounds) * count;
+  Serial.print("single ");
+  Serial.print(uint32_t((uint64_t(timeSingle) * 1000) / conversions));
+  Serial.print(" ns, structs ");
+  Serial.print(uint32_t((uint64_t(timeStructs) * 1000) / conversions));
+  Serial.print(" ns, arrays ");
+  Serial.print(uint32_t((uint64_t(timeArrays) * 1000) / conversions));
+  Serial.println(" ns");
+
+  delete[] colors;
+  delete[] hue;
+  delete[] sat;
+  delete[] val;
+  delete[] ct;
+  delete[] out;
+}
+
+// Time per parameter, String constructor of AbsOrRelValue vs. AbsOrRelValue::parse().
+// test/test_parse.cpp checks that both give the same values for these parameters
+void runParserBenchmark() {
+  const int count = 8;
+  const int rounds = 500;
+  const String inputs[count] = {"120", "+30", "100", "50.5", "2700", "1023", "+10", "12.25"};
+  const AbsOrRelValue::Type types[count] = {AbsOrRelValue::Type::Hue,     AbsOrRelValue::Type::Hue,
+                                            AbsOrRelValue::Type::Percent, AbsOrRelValue::Type::Percent,
+                                            AbsOrRelValue::Type::Ct,      AbsOrRelValue::Type::Raw,
+                                            AbsOrRelValue::Type::Raw,     AbsOrRelValue::Type::Percent};
+
+  // volatile keeps the compiler from dropping the loops
+  volatile int sum = 0;
+  uint32_t start = micros();
+  for (int r = 0; r < rounds; ++r) {
+    for (int i = 0; i < count; ++i) {
+      AbsOrRelValue v(inputs[i], types[i]);
+      sum += v.getValue();
+    }
+  }
+  const uint32_t timeString = micros() - start;
+
+  start = micros();
+  for (int r = 0; r < rounds; ++r) {
+    for (int i = 0; i < count; ++i) {
+      AbsOrRelValue v;
+      AbsOrRelValue::parse(inputs[i].c_str(), inputs[i].length(), types[i], v);
+      sum += v.getValue();
+    }
+  }
+  const uint32_t timeParse = micros() - start;
+
+  Serial.print("AbsOrRelValue: String ");
+  Serial.print(uint32_t((uint64_t(timeString) * 1000) / (rounds * count)));
+  Serial.print(" ns, parse ");
+  Serial.print(uint32_t((uint64_t(timeParse) * 1000) / (rounds * count)));
+  Serial.println(" ns");
+}
+
+// Color commands per second, String assignment with splitString() as before HSVCT::parse() vs. HSVCT::parse()
+// and ChannelOutput::parse(). test/test_parse.cpp checks that both give the same colors for these commands
+void runColorParserBenchmark() {
+  const int rounds = 2000;
+  const char hsv[] = "120.5,100,75,2700";
+  const char raw[] = "1023,512,0,100,800";
+
+  volatile int sum = 0;
+  String hsvStr(hsv);
+  uint32_t start = micros();
+  for (int r = 0; r < rounds; ++r) {
+    Vector<String> tokens;
+    splitString(hsvStr, ',', tokens);
+    HSVCT c(tokens[0].toFloat(), tokens[1].toFloat(), tokens[2].toFloat(), int(tokens[3].toInt()));
+    sum += c.h;
+  }
+  const uint32_t timeSplit = micros() - start;
+
+  start = micros();
+  for (int r = 0; r < rounds; ++r) {
+    HSVCT c;
+    c.parse(hsv, sizeof(hsv) - 1);
+    sum += c.h;
+  }
+  const uint32_t timeHsv = micros() - start;
+
+  start = micros();
+  for (int r = 0; r < rounds; ++r) {
+    ChannelOutput o;
+    o.parse(raw, sizeof(raw) - 1);
+    sum += o.r;
+  }
+  const uint32_t timeRaw = micros() - start;
+
+  Serial.print("color commands per second: HSVCT splitString ");
+  Serial.print(uint32_t((uint64_t(rounds) * 1000000) / max(timeSplit, uint32_t(1))));
+  Serial.print(", HSVCT ");
+  Serial.print(uint32_t((uint64_t(rounds) * 1000000) / max(timeHsv, uint32_t(1))));
+  Serial.print(", ChannelOutput ");
+  Serial.println(uint32_t((uint64_t(rounds) * 1000000) / max(timeRaw, uint32_t(1))));
+}
+
+// Time to save and restore a snapshot in the middle of a fade.
+// test/test_snapshot.cpp checks that the restored controller continues the same way
+void runSnapshotBenchmark(const char* name, SetupFunc setupFunc) {
+  const int rounds = 100;
+  rgbled.clearAnimationQueue();
+  rgbled.skipAnimation();
+  rgbled.show();
+  setupFunc(rgbled);
+  // in the middle of the first fade
+  for (int i = 0; i < 100; ++i)
+    rgbled.show();
+
+  const size_t size = rgbled.getSnapshotSize();
+  uint8_t* buffer = new uint8_t[size];
+  uint32_t start = micros();
+  for (int r = 0; r < rounds; ++r)
+    rgbled.saveSnapshot(buffer, size);
+  const uint32_t timeSave = micros() - start;
+
+  RGBWWLed restored;
+  restored.init(REDPIN, GREENPIN, BLUEPIN, WWPIN, CWPIN);
+  start = micros();
+  for (int r = 0; r < rounds; ++r)
+    restored.restoreSnapshot(buffer, size);
+  const uint32_t timeRestore = micros() - start;
+  delete[] buffer;
+
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(size);
+  Serial.print(" bytes, save ");
+  Serial.print(timeSave / rounds);
+  Serial.print(" us, restore ");
+  Serial.print(timeRestore / rounds);
+  Serial.println(" us");
+}
+
+// Discards the output of the renderer, counts the bytes only
+class CountingPrint : public Print {
+public:
+  virtual size_t write(uint8_t c) override {
+    ++bytes;
+    return 1;
+  }
+
+  virtual size_t write(const uint8_t* buffer, size_t size) override {
+    bytes += size;
+    return size;
+  }
+
+  uint32_t bytes = 0;
+};
+
+// Offline rendering of one hour of the fades of setupFadeHSV (requeued) at 50 Hz
+void runRenderBenchmark(bool csv) {
+  RGBWWLed* led = new RGBWWLed();
+  for (int i = 0; i < 10; ++i) {
+    HSVCT c((i * RGBWW_CALC_HUEWHEELMAX) / 10, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL, 2700 + i * 300);
+    led->fadeHSV(RequestHSVCT(c), RampTimeOrSpeed(4000), 0, HueTransitionDirection::dir_short, QueuePolicy::Back,
+                 true);
+  }
+
+  CountingPrint out;
+  RGBWWLedCsvSink csvSink(out);
+  RGBWWLedBinarySink binarySink(out);
+  RGBWWLedRenderSink& sink = csv ? static_cast<RGBWWLedRenderSink&>(csvSink) : binarySink;
+  RGBWWLedRenderer renderer(*led);
+
+  uint32_t frames = 0;
+  uint32_t busy = 0;
+  for (int minute = 0; minute < 60; ++minute) {
+    const uint32_t start = micros();
+    frames += renderer.render(sink, 60000);
+    busy += micros() - start;
+    yield();
+  }
+
+  Serial.print(csv ? "render 1 h, CSV: " : "render 1 h, binary: ");
+  Serial.print(frames);
+  Serial.print(" frames, ");
+  Serial.print(busy / 1000);
+  Serial.print(" ms, ");
+  Serial.print(out.bytes);
+  Serial.println(" bytes");
+  delete led;
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println(F("RGBWWLed benchmark"));
+
+  // the queues of the benchmarks and the animations left by the previous one exceed the default pool
+  RGBWWLedAnimation::initPool(128, RGBWW_ANIMATIONPOOLLARGE);
+  rgbled.init(REDPIN, GREENPIN, BLUEPIN, WWPIN, CWPIN);
+  if (!compileScene())
+    Serial.println("scene: compile error");
+
+  runBenchmark("idle", setupIdle);
+  runBenchmark("fadeHSV", setupFadeHSV);
+  runBenchmark("fadeHSV eased", setupFadeHSVEased);
+  runBenchmark("fadeHSV joint", setupFadeHSVJoint);
+  runBenchmark("timeline", setupTimeline);
+  runBenchmark("scene", setupScene);
+  runBenchmark("fadeRAW", setupFadeRAW);
+  runBenchmark("blink", setupBlink);
+
+  const AnimationPoolStats& pool = RGBWWLed::getAnimationPoolStats();
+  Serial.print("animation pool: ");
+  Serial.print(pool.used);
+  Serial.print("/");
+  Serial.print(pool.capacity);
+  Serial.print(" used, high water ");
+  Serial.print(pool.highWater);
+  Serial.print(", heap ");
+  Serial.print(pool.heap);
+  Serial.print(", failed ");
+  Serial.println(pool.failed);
+
+  runFootprint();
+#ifdef RGBWW_ENABLE_PROFILING
+  runProfile("fadeHSV", setupFadeHSV);
+  runProfile("fadeRAW", setupFadeRAW);
+#endif
+  runDayProfile(false);
+  runDayProfile(true);
+
+  runGroupBenchmark(1);
+  runGroupBenchmark(10);
+  runGroupBenchmark(100);
+  runGroupBenchmark(1000);
+  runGroupBenchmark(4000);
+
+  runConversionBenchmark(RAW);
+  runConversionBenchmark(SPEKTRUM);
+  runConversionBenchmark(RAINBOW);
+  runBatchBenchmark(128);
+  runBatchBenchmark(4096);
+  runParserBenchmark();
+  runColorParserBenchmark();
+
+  runSnapshotBenchmark("snapshot fadeHSV", setupFadeHSV);
+  runSnapshotBenchmark("snapshot timeline", setupTimeline);
+  runSnapshotBenchmark("snapshot scene", setupScene);
+  runSnapshotBenchmark("snapshot fadeRAW", setupFadeRAW);
+  runRenderBenchmark(true);
+  runRenderBenchmark(false);
+}
+
+void loop() {
+}
@@ -0,0 +1,20 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include "host.h"
+#include "../examples/benchmark/benchmark.ino"
+// clang-format on
+
+/**
+ * examples/benchmark on the host. The timings are those of the host CPU, only
+ * the relative cost of the variants carries over to the ESP8266
+ */
+int main() {
+    setup();
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include <chrono>
+#include <new>
+#include <x86intrin.h>
+#include "host.h"
+// clang-format on
+
+HostSerial Serial;
+
+static HostAllocStats allocStats;
+static const uint32_t hostHeapSize = 80000;
+
+// the library is linked with --wrap=malloc,--wrap=free, see Makefile
+extern "C" {
+void* __real_malloc(size_t size);
+void __real_free(void* ptr);
+}
+
+// size in front of every block, for the heap of system_get_free_heap_size()
+static const size_t headerSize = 16;
+
+static void* countedMalloc(size_t size) {
+    uint8_t* block = static_cast<uint8_t*>(__real_malloc(size + headerSize));
+    if (block == nullptr)
+        return nullptr;
+    *reinterpret_cast<size_t*>(block) = size;
+    ++allocStats.allocs;
+    allocStats.bytes += size;
+    return block + headerSize;
+}
+
+static void countedFree(void* ptr) {
+    if (ptr == nullptr)
+        return;
+    uint8_t* block = static_cast<uint8_t*>(ptr) - headerSize;
+    ++allocStats.frees;
+    allocStats.bytes -= *reinterpret_cast<size_t*>(block);
+    __real_free(block);
+}
+
+extern "C" {
+void* __wrap_malloc(size_t size) {
+    return countedMalloc(size);
+}
+
+void __wrap_free(void* ptr) {
+    countedFree(ptr);
+}
+}
+
+void* operator new(size_t size) {
+    void* ptr = countedMalloc(size);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedMalloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedMalloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    countedFree(ptr);
+}
+
+const HostAllocStats& hostAllocStats() {
+    return allocStats;
+}
+
+uint32_t system_get_free_heap_size() {
+    return (allocStats.bytes < hostHeapSize) ? hostHeapSize - allocStats.bytes : 0;
+}
+
+static const auto startTime = std::chrono::steady_clock::now();
+static bool fixedTime = false;
+static uint32_t fixedMs = 0;
+
+void hostSetTime(uint32_t ms) {
+    fixedTime = true;
+    fixedMs = ms;
+}
+
+void hostUseRealTime() {
+    fixedTime = false;
+}
+
+uint32_t millis() {
+    if (fixedTime)
+        return fixedMs;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+uint32_t micros() {
+    if (fixedTime)
+        return fixedMs * 1000;
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+uint32_t esp_get_ccount() {
+    return uint32_t(__rdtsc());
+}
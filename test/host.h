@@ -0,0 +1,35 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite LEDs via PWM
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+#pragma once
+// clang-format off
+#include <SmingCore.h>
+// clang-format on
+
+/**
+ * Allocations of the host build: operator new and malloc (i.e. the fallback of
+ * RGBWWLedAnimation::operator new), counted since the start of the program
+ */
+struct HostAllocStats {
+    uint32_t allocs = 0;
+    uint32_t frees = 0;
+    uint32_t bytes = 0; // currently allocated
+};
+
+const HostAllocStats& hostAllocStats();
+
+/**
+ * Replace the clock of millis() and micros() by a fixed time, i.e. for deterministic tests
+ *
+ * @param ms    time returned by millis()
+ */
+void hostSetTime(uint32_t ms);
+
+/**
+ * Back to the real clock of the host
+ */
+void hostUseRealTime();
@@ -0,0 +1,59 @@
+#pragma once
+// clang-format off
+#include <fcntl.h>
+#include <unistd.h>
+#include "SmingCore.h"
+// clang-format on
+
+/**
+ * Sming file API on top of the POSIX file functions of the host
+ */
+
+typedef int file_t;
+
+enum FileOpenFlags {
+    eFO_ReadOnly = 1,
+    eFO_WriteOnly = 2,
+    eFO_ReadWrite = 3,
+    eFO_CreateIfNotExist = 4,
+    eFO_Truncate = 8,
+};
+
+inline FileOpenFlags operator|(FileOpenFlags a, FileOpenFlags b) {
+    return FileOpenFlags(int(a) | int(b));
+}
+
+enum SeekOriginFlags {
+    eSO_FileStart = SEEK_SET,
+    eSO_CurrentPos = SEEK_CUR,
+    eSO_FileEnd = SEEK_END,
+};
+
+inline file_t fileOpen(const String& name, FileOpenFlags flags) {
+    int mode = ((flags & 3) == eFO_ReadOnly) ? O_RDONLY : ((flags & 3) == eFO_WriteOnly) ? O_WRONLY : O_RDWR;
+    if (flags & eFO_CreateIfNotExist)
+        mode |= O_CREAT;
+    if (flags & eFO_Truncate)
+        mode |= O_TRUNC;
+    return ::open(name.c_str(), mode, 0644);
+}
+
+inline int fileSeek(file_t file, int offset, SeekOriginFlags origin) {
+    return ::lseek(file, offset, origin);
+}
+
+inline int fileRead(file_t file, void* data, size_t size) {
+    return ::read(file, data, size);
+}
+
+inline int fileWrite(file_t file, const void* data, size_t size) {
+    return ::write(file, data, size);
+}
+
+inline void fileClose(file_t file) {
+    ::close(file);
+}
+
+inline int fileDelete(const String& name) {
+    return ::unlink(name.c_str());
+}
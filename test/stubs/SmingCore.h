@@ -0,0 +1,300 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite LEDs via PWM
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+#pragma once
+// clang-format off
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+// clang-format on
+
+/**
+ * Stand-ins for the parts of the Sming framework used by the library, for the host tests
+ * and the host build of the benchmark. Only as much as the library needs
+ */
+
+#define SMING_VERSION "4.0"
+
+typedef uint32_t uint32;
+typedef uint16_t uint16;
+typedef uint8_t uint8;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+using std::abs;
+using std::max;
+using std::min;
+
+#define debug_d(fmt, ...)                                                                                              \
+    do {                                                                                                               \
+    } while (0)
+#define debug_i(fmt, ...) debug_d(fmt)
+#define debug_w(fmt, ...) debug_d(fmt)
+#define debug_e(fmt, ...) debug_d(fmt)
+
+#define F(str) str
+
+class String {
+  public:
+    String() {}
+    String(const char* str) : _s(str != nullptr ? str : "") {}
+    String(const char* str, size_t length) : _s(str, length) {}
+    String(int value) : _s(std::to_string(value)) {}
+
+    const char* c_str() const {
+        return _s.c_str();
+    }
+    unsigned length() const {
+        return _s.size();
+    }
+    bool startsWith(const String& prefix) const {
+        return _s.compare(0, prefix._s.size(), prefix._s) == 0;
+    }
+    String substring(unsigned from) const {
+        return (from >= _s.size()) ? String() : String(_s.c_str() + from);
+    }
+    String substring(unsigned from, unsigned to) const {
+        return String(_s.c_str() + from, to - from);
+    }
+    float toFloat() const {
+        return atof(_s.c_str());
+    }
+    long toInt() const {
+        return atol(_s.c_str());
+    }
+    bool operator==(const String& other) const {
+        return _s == other._s;
+    }
+    bool operator==(const char* other) const {
+        return _s == other;
+    }
+    bool operator!=(const String& other) const {
+        return _s != other._s;
+    }
+    bool equals(const String& other) const {
+        return _s == other._s;
+    }
+    char operator[](unsigned i) const {
+        return _s[i];
+    }
+    char charAt(unsigned i) const {
+        return _s[i];
+    }
+    int indexOf(char c, unsigned from = 0) const {
+        const size_t pos = _s.find(c, from);
+        return (pos == std::string::npos) ? -1 : int(pos);
+    }
+    String& operator+=(const String& other) {
+        _s += other._s;
+        return *this;
+    }
+    String& operator+=(const char* other) {
+        _s += other;
+        return *this;
+    }
+    String& operator+=(char c) {
+        _s += c;
+        return *this;
+    }
+    String& operator+=(int value) {
+        _s += std::to_string(value);
+        return *this;
+    }
+    friend String operator+(const String& a, const String& b) {
+        String result(a);
+        result += b;
+        return result;
+    }
+    void trim() {}
+    bool reserve(unsigned size) {
+        _s.reserve(size);
+        return true;
+    }
+    void toLowerCase() {}
+
+  private:
+    std::string _s;
+};
+
+template <typename T> class Vector {
+  public:
+    unsigned size() const {
+        return _v.size();
+    }
+    unsigned count() const {
+        return _v.size();
+    }
+    bool contains(const T& value) const {
+        return std::find(_v.begin(), _v.end(), value) != _v.end();
+    }
+    bool add(const T& value) {
+        _v.push_back(value);
+        return true;
+    }
+    void addElement(const T& value) {
+        _v.push_back(value);
+    }
+    const T& operator[](unsigned i) const {
+        return _v[i];
+    }
+    T& operator[](unsigned i) {
+        return _v[i];
+    }
+    const T& elementAt(unsigned i) const {
+        return _v[i];
+    }
+    void removeAllElements() {
+        _v.clear();
+    }
+    void clear() {
+        _v.clear();
+    }
+
+  private:
+    std::vector<T> _v;
+};
+
+template <typename K, typename V> class HashMap {
+  public:
+    V& operator[](const K& key) {
+        for (unsigned i = 0; i < _keys.size(); ++i) {
+            if (_keys[i] == key)
+                return _values[i];
+        }
+        _keys.push_back(key);
+        _values.push_back(V());
+        return _values.back();
+    }
+    unsigned count() const {
+        return _keys.size();
+    }
+    const K& keyAt(unsigned i) const {
+        return _keys[i];
+    }
+    V& valueAt(unsigned i) const {
+        return const_cast<V&>(_values[i]);
+    }
+    bool contains(const K& key) const {
+        return std::find(_keys.begin(), _keys.end(), key) != _keys.end();
+    }
+
+  private:
+    std::vector<K> _keys;
+    std::vector<V> _values;
+};
+
+inline int splitString(String& what, char delim, Vector<String>& splits) {
+    unsigned start = 0;
+    for (unsigned i = 0; i <= what.length(); ++i) {
+        if (i == what.length() || what[i] == delim) {
+            splits.add(what.substring(start, i));
+            start = i + 1;
+        }
+    }
+    return splits.size();
+}
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size-- > 0)
+            n += write(*buffer++);
+        return n;
+    }
+    size_t print(const char* str) {
+        return write(reinterpret_cast<const uint8_t*>(str), strlen(str));
+    }
+};
+
+/**
+ * Serial console, prints to stdout
+ */
+class HostSerial {
+  public:
+    void begin(int baud) {}
+    template <typename T> void print(const T& value) {
+        std::cout << value;
+    }
+    void print(const String& value) {
+        std::cout << value.c_str();
+    }
+    template <typename T> void println(const T& value) {
+        std::cout << value << "\n";
+    }
+    void println(const String& value) {
+        std::cout << value.c_str() << "\n";
+    }
+    void println() {
+        std::cout << "\n";
+    }
+};
+
+extern HostSerial Serial;
+
+// Sming uses period * 1000 / 45 as maximum duty of the ESP8266 hardware PWM
+class HardwarePWM {
+  public:
+    HardwarePWM(uint8_t* pins, uint8_t count) : _count(count) {
+        for (uint8_t i = 0; i < count && i < 8; ++i) {
+            _pins[i] = pins[i];
+            pinDuty()[pins[i]] = 0;
+        }
+    }
+
+    void setPeriod(uint32_t period) {
+        _period = period;
+    }
+    uint32_t getPeriod() {
+        return _period;
+    }
+    uint32_t getMaxDuty() {
+        return _period * 1000 / 45;
+    }
+    uint32_t getDutyChan(uint8_t chan) {
+        return _duty[chan];
+    }
+    bool setDutyChan(uint8_t chan, uint32_t duty, bool update = true) {
+        _duty[chan] = duty;
+        pinDuty()[_pins[chan]] = duty;
+        return true;
+    }
+    void update() {}
+
+    // last duty set on a pin by any instance, for the host tests
+    static uint32_t getPinDuty(uint8_t pin) {
+        return pinDuty()[pin];
+    }
+
+  private:
+    static uint32_t* pinDuty() {
+        static uint32_t duties[256] = {};
+        return duties;
+    }
+
+    uint8_t _pins[8] = {};
+    uint32_t _duty[8] = {};
+    uint32_t _period = 5000;
+    uint8_t _count;
+};
+
+// clock of the host, see hostSetTime()
+uint32_t millis();
+uint32_t micros();
+uint32_t esp_get_ccount();
+
+// total heap minus the bytes currently allocated
+uint32_t system_get_free_heap_size();
+
+inline void yield() {}
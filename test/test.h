@@ -0,0 +1,70 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite LEDs via PWM
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+#pragma once
+// clang-format off
+#include "host.h"
+// clang-format on
+
+/**
+ * Minimal test registry of the host tests
+ *
+ *   TEST_CASE(fadeFinishes) {
+ *       CHECK(...);
+ *       CHECK_EQUAL(expected, actual);
+ *   }
+ */
+class TestCase {
+  public:
+    typedef void (*Function)();
+
+    TestCase(const char* name, Function function);
+
+    /**
+     * Run all test cases, or the ones whose name contains filter
+     *
+     * @return int number of failed checks
+     */
+    static int runAll(const char* filter);
+
+    static void fail(const char* file, int line, const char* expression);
+
+  private:
+    const char* _name;
+    Function _function;
+    TestCase* _next;
+};
+
+#define TEST_CASE(name)                                                                                                \
+    static void name();                                                                                                \
+    static TestCase name##Case(#name, name);                                                                           \
+    static void name()
+
+#define CHECK(expression)                                                                                              \
+    do {                                                                                                               \
+        if (!(expression))                                                                                             \
+            TestCase::fail(__FILE__, __LINE__, #expression);                                                           \
+    } while (0)
+
+#define CHECK_EQUAL(expected, actual)                                                                                  \
+    do {                                                                                                               \
+        const auto expectedValue = (expected);                                                                         \
+        const auto actualValue = (actual);                                                                             \
+        if (!(expectedValue == actualValue)) {                                                                         \
+            std::cout << "  expected " << expectedValue << ", got " << actualValue << "\n";                            \
+            TestCase::fail(__FILE__, __LINE__, #expected " == " #actual);                                              \
+        }                                                                                                              \
+    } while (0)
+
+// stop the test case, i.e. if the following checks would crash
+#define REQUIRE(expression)                                                                                            \
+    do {                                                                                                               \
+        if (!(expression)) {                                                                                           \
+            TestCase::fail(__FILE__, __LINE__, #expression);                                                           \
+            return;                                                                                                    \
+        }                                                                                                              \
+    } while (0)
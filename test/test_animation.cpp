@@ -0,0 +1,374 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include <RGBWWLed.h>
+#include <RGBWWLedScene.h>
+#include <RGBWWLedTimeline.h>
+#include "test.h"
+// clang-format on
+
+typedef void (*SetupFunc)(RGBWWLed& led);
+
+static const int fades = 4;
+
+static HSVCT getFadeColor(int i) {
+    return HSVCT((i * RGBWW_CALC_HUEWHEELMAX) / fades, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL, 2700 + i * 300);
+}
+
+static void setupFadeHSV(RGBWWLed& led) {
+    for (int i = 0; i < fades; ++i)
+        led.fadeHSV(RequestHSVCT(getFadeColor(i)), RampTimeOrSpeed(400), 0, HueTransitionDirection::dir_short,
+                    QueuePolicy::Back);
+}
+
+static void setupFadeHSVEased(RGBWWLed& led) {
+    for (int i = 0; i < fades; ++i)
+        led.fadeHSV(RequestHSVCT(getFadeColor(i)), RampTimeOrSpeed(400, Easing::InOut), 0,
+                    HueTransitionDirection::dir_short, QueuePolicy::Back);
+}
+
+static void setupFadeHSVJoint(RGBWWLed& led) {
+    for (int i = 0; i < fades; ++i)
+        led.fadeHSVJoint(RequestHSVCT(getFadeColor(i)), RampTimeOrSpeed(400), 0, HueTransitionDirection::dir_short,
+                         QueuePolicy::Back);
+}
+
+static void setupTimeline(RGBWWLed& led) {
+    AnimTimeline* timeline = new AnimTimeline(&led, RGBWWLed::ColorMode::Hsv, fades);
+    for (int i = 0; i < fades; ++i)
+        timeline->addKeyframe(RequestHSVCT(getFadeColor(i)), RampTimeOrSpeed(400));
+    led.pushJointAnimation(timeline, QueuePolicy::Back);
+}
+
+static void setupScene(RGBWWLed& led) {
+    static RGBWWLedScene scene;
+    if (scene.getSize() == 0)
+        scene.compile("fade h=0 s=100 v=100 time=400\nfade h=120 time=400\nfade h=240 ct=4000 time=400\n");
+    led.playScene(scene, QueuePolicy::Back);
+}
+
+static void setupFadeRAW(RGBWWLed& led) {
+    for (int i = 0; i < fades; ++i) {
+        const int v = (i % 2) ? RGBWW_CALC_MAXVAL : 0;
+        ChannelOutput o(v, RGBWW_CALC_MAXVAL - v, v, RGBWW_CALC_MAXVAL - v, v);
+        led.fadeRAW(RequestChannelOutput(o), RampTimeOrSpeed(400), 0, QueuePolicy::Back);
+    }
+}
+
+static void setupBlink(RGBWWLed& led) {
+    led.colorDirectHSV(RequestHSVCT(HSVCT(0, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL)));
+    led.blink(RGBWWLed::ChannelList(), 200, QueuePolicy::Back, true);
+}
+
+// show() runs the queued animations without touching the heap, the animations
+// are allocated from the pool when queued and returned to it when finished.
+// Timelines and scenes free their keyframes or code when they finish, the duty
+// tables are built by the first frame
+static void checkNoAllocations(SetupFunc setupFunc, uint32_t heapArrays = 0) {
+    RGBWWLed led;
+    led.init(13, 12, 14, 5, 4);
+    led.show();
+    setupFunc(led);
+
+    const HostAllocStats before = hostAllocStats();
+    int frames = 0;
+    while (frames < 1000 && led.show().nextFrame != 0)
+        ++frames;
+    const HostAllocStats& after = hostAllocStats();
+
+    CHECK(frames > 10);
+    CHECK_EQUAL(before.allocs, after.allocs);
+    CHECK_EQUAL(before.frees + heapArrays, after.frees);
+}
+
+TEST_CASE(showFadeHSVWithoutAllocation) {
+    checkNoAllocations(setupFadeHSV);
+}
+
+TEST_CASE(showFadeHSVEasedWithoutAllocation) {
+    checkNoAllocations(setupFadeHSVEased);
+}
+
+TEST_CASE(showFadeHSVJointWithoutAllocation) {
+    checkNoAllocations(setupFadeHSVJoint);
+}
+
+TEST_CASE(showTimelineWithoutAllocation) {
+    checkNoAllocations(setupTimeline, 1);
+}
+
+TEST_CASE(showSceneWithoutAllocation) {
+    checkNoAllocations(setupScene, 1);
+}
+
+TEST_CASE(showFadeRAWWithoutAllocation) {
+    checkNoAllocations(setupFadeRAW);
+}
+
+TEST_CASE(showBlinkWithoutAllocation) {
+    checkNoAllocations(setupBlink);
+}
+
+TEST_CASE(animationsReturnToPool) {
+    const int usedBefore = RGBWWLed::getAnimationPoolStats().used;
+    {
+        RGBWWLed led;
+        led.init(13, 12, 14, 5, 4);
+        setupFadeHSV(led);
+        CHECK_EQUAL(usedBefore + fades * 4, RGBWWLed::getAnimationPoolStats().used);
+    }
+    CHECK_EQUAL(usedBefore, RGBWWLed::getAnimationPoolStats().used);
+}
+
+static bool queueBudget(RGBWWLed& led) {
+    const ChannelOutput o(RGBWW_CALC_MAXVAL, 0, RGBWW_CALC_MAXVAL, 0, RGBWW_CALC_MAXVAL);
+    bool accepted = true;
+    for (int i = 0; i < RGBWW_ANIMATIONQBUDGET / 5; ++i)
+        accepted &= led.fadeRAW(RequestChannelOutput(o), RampTimeOrSpeed(100), 0, QueuePolicy::Back);
+    return accepted;
+}
+
+static void runUntilIdle(RGBWWLed& led) {
+    for (int i = 0; i < 10000 && led.show().nextFrame != 0; ++i) {
+    }
+}
+
+// the default pool holds the full queue budget of one controller without the heap
+TEST_CASE(poolHoldsQueueBudget) {
+    const AnimationPoolStats& stats = RGBWWLed::getAnimationPoolStats();
+    REQUIRE(stats.capacity - stats.used >= RGBWW_ANIMATIONQBUDGET);
+    const int heapBefore = stats.heap;
+
+    RGBWWLed led;
+    led.init(13, 12, 14, 5, 4);
+    CHECK(queueBudget(led));
+    CHECK_EQUAL(heapBefore, stats.heap);
+    runUntilIdle(led);
+}
+
+// requests beyond the capacity of the animation pool fill the large slots first, then
+// they are queued as a whole from the heap
+TEST_CASE(poolOverflowUsesHeap) {
+    const AnimationPoolStats& stats = RGBWWLed::getAnimationPoolStats();
+    const int usedBefore = stats.used;
+    const int heapBefore = stats.heap;
+    const int failedBefore = stats.failed;
+
+    RGBWWLed led;
+    led.init(13, 12, 14, 5, 4);
+    RGBWWLed other;
+    other.init(13, 12, 14, 5, 4);
+    CHECK(queueBudget(led));
+    CHECK(queueBudget(other));
+    CHECK_EQUAL(stats.capacity, stats.used);
+    CHECK_EQUAL(heapBefore + usedBefore + 2 * RGBWW_ANIMATIONQBUDGET - stats.capacity, stats.heap);
+    CHECK_EQUAL(failedBefore, stats.failed);
+
+    runUntilIdle(led);
+    runUntilIdle(other);
+    CHECK_EQUAL(usedBefore, stats.used);
+}
+
+// the single channel animations take the small slots, the joint ones the large slots
+TEST_CASE(poolSizeClasses) {
+    const RGBWWLedAnimationPool& pool = RGBWWLedAnimation::getPool();
+    const size_t slotSize = pool.getSlotSize(RGBWWLedAnimationPool::Small);
+    const size_t largeSlotSize = pool.getSlotSize(RGBWWLedAnimationPool::Large);
+    CHECK(sizeof(AnimTransition) <= slotSize);
+    CHECK(sizeof(AnimTransitionCircularHue) <= slotSize);
+    CHECK(sizeof(AnimBlink) <= slotSize);
+    CHECK(sizeof(AnimTimeline) <= largeSlotSize);
+    CHECK(sizeof(AnimJointTransition) <= largeSlotSize);
+    CHECK(sizeof(AnimScene) <= largeSlotSize);
+    CHECK(slotSize < largeSlotSize);
+
+    CHECK_EQUAL(RGBWW_ANIMATIONPOOLSIZE, pool.getSlots(RGBWWLedAnimationPool::Small));
+    CHECK_EQUAL(RGBWW_ANIMATIONPOOLLARGE, pool.getSlots(RGBWWLedAnimationPool::Large));
+    CHECK_EQUAL(RGBWW_ANIMATIONPOOLSIZE * slotSize + RGBWW_ANIMATIONPOOLLARGE * largeSlotSize,
+                pool.getStats().bytes);
+}
+
+// an eased fade over the whole color temperature range, the distance times the eased
+// position does not fit into an int
+static void checkEasedCtRange(bool joint) {
+    RGBWWLed led;
+    led.init(13, 12, 14, 5, 4);
+    led.colorDirectHSV(RequestHSVCT(HSVCT(0, 0, RGBWW_CALC_MAXVAL, 0)));
+    led.show();
+    const RequestHSVCT color(HSVCT(0, 0, RGBWW_CALC_MAXVAL, 65535));
+    const RampTimeOrSpeed ramp(2000, Easing::InOut);
+    if (joint)
+        led.fadeHSVJoint(color, ramp, 0, HueTransitionDirection::dir_short, QueuePolicy::Single);
+    else
+        led.fadeHSV(color, ramp, 0, HueTransitionDirection::dir_short, QueuePolicy::Single);
+
+    int previous = 0;
+    int decreasing = 0;
+    int halfway = 0;
+    for (int frame = 1; frame <= 2000 / RGBWW_MINTIMEDIFF; ++frame) {
+        led.show();
+        const int ct = led.getCurrentColor().ct;
+        if (ct < previous)
+            ++decreasing;
+        if (frame == 1000 / RGBWW_MINTIMEDIFF)
+            halfway = ct;
+        previous = ct;
+    }
+    CHECK_EQUAL(0, decreasing);
+    CHECK(abs(halfway - 65535 / 2) < 65535 / 20);
+    CHECK_EQUAL(65535, previous);
+}
+
+TEST_CASE(easedFadeFullCtRange) {
+    checkEasedCtRange(false);
+}
+
+TEST_CASE(easedJointFadeFullCtRange) {
+    checkEasedCtRange(true);
+}
+
+// short and long fades, fades with more value changes than steps, speeds, stays and blinks
+static void setupMixed(RGBWWLed& led) {
+    RequestHSVCT color(HSVCT(RGBWW_CALC_HUEWHEELMAX - 1, 0, RGBWW_CALC_MAXVAL, 6000));
+    led.fadeHSV(color, RampTimeOrSpeed(7), 0, HueTransitionDirection::dir_short, QueuePolicy::Back);
+    color = RequestHSVCT(HSVCT(100, RGBWW_CALC_MAXVAL, 10, 2700));
+    led.fadeHSV(color, RampTimeOrSpeed(35), 55, HueTransitionDirection::dir_long, QueuePolicy::Back);
+    color = RequestHSVCT(HSVCT(3000, 300, 700, 3100));
+    led.fadeHSV(color, RampTimeOrSpeed(2345, Easing::Out), 15, HueTransitionDirection::dir_short, QueuePolicy::Back);
+    color = RequestHSVCT(HSVCT(10, 1000, 3, 5000));
+    led.fadeHSV(color, RampTimeOrSpeed(2500, RampTimeOrSpeed::Type::Speed), 0, HueTransitionDirection::dir_long,
+                QueuePolicy::Back);
+    led.blink(RGBWWLed::ChannelList(), 65, QueuePolicy::Back);
+    color = RequestHSVCT(HSVCT(777, 1, 1023, 4444));
+    led.fadeHSV(color, RampTimeOrSpeed(4321), 0, HueTransitionDirection::dir_short, QueuePolicy::Back);
+    setupFadeHSVJoint(led);
+}
+
+static void setupMixedRAW(RGBWWLed& led) {
+    led.fadeRAW(RequestChannelOutput(ChannelOutput(1023, 0, 512, 1, 1000)), RampTimeOrSpeed(40), 0, QueuePolicy::Back);
+    led.fadeRAW(RequestChannelOutput(ChannelOutput(0, 1023, 3, 1022, 0)), RampTimeOrSpeed(9000), 25,
+                QueuePolicy::Back);
+    led.fadeRAW(RequestChannelOutput(ChannelOutput(600, 9, 700, 5, 900)), RampTimeOrSpeed(1200, Easing::InOut), 0,
+                QueuePolicy::Back);
+    setupScene(led);
+    setupTimeline(led);
+}
+
+// a frame of several steps ends with the same values as one frame per step
+static void checkFrameSizes(SetupFunc setupFunc) {
+    const int intervals[] = {10, 15, 20, 35, 100, 1000};
+    for (int interval : intervals) {
+        RGBWWLed perStep;
+        RGBWWLed perFrame;
+        perStep.init(13, 12, 14, 5, 4);
+        perFrame.init(13, 12, 14, 5, 4);
+        REQUIRE(perStep.setFrameInterval(RGBWW_STEPTIME));
+        REQUIRE(perFrame.setFrameInterval(interval));
+        setupFunc(perStep);
+        setupFunc(perFrame);
+
+        int mismatches = 0;
+        for (int time = 0; time < 20000; time += interval) {
+            perFrame.show();
+            for (int step = 0; step < interval / RGBWW_STEPTIME; ++step)
+                perStep.show();
+            if (!(perStep.getCurrentOutput() == perFrame.getCurrentOutput()) ||
+                !(perStep.getCurrentColor() == perFrame.getCurrentColor()))
+                ++mismatches;
+        }
+        CHECK_EQUAL(0, mismatches);
+        CHECK_EQUAL(0, perFrame.show().nextFrame);
+    }
+}
+
+TEST_CASE(frameSizeFadeHSV) {
+    checkFrameSizes(setupFadeHSV);
+}
+
+TEST_CASE(frameSizeFadeHSVEased) {
+    checkFrameSizes(setupFadeHSVEased);
+}
+
+TEST_CASE(frameSizeMixed) {
+    checkFrameSizes(setupMixed);
+}
+
+TEST_CASE(frameSizeMixedRAW) {
+    checkFrameSizes(setupMixedRAW);
+}
+
+TEST_CASE(frameIntervalMultipleOfStepTime) {
+    RGBWWLed led;
+    CHECK_EQUAL(RGBWW_MINTIMEDIFF, led.getFrameInterval());
+    CHECK(!led.setFrameInterval(33));
+    CHECK(!led.setFrameInterval(0));
+    CHECK(!led.setFrameInterval(-RGBWW_STEPTIME));
+    CHECK_EQUAL(RGBWW_MINTIMEDIFF, led.getFrameInterval());
+    CHECK(led.setFrameInterval(35));
+    CHECK_EQUAL(35, led.getFrameInterval());
+}
+
+// a joint animation takes one pool slot for all channels, a fade one per channel
+static int getPoolSlots(SetupFunc setupFunc) {
+    RGBWWLed led;
+    led.init(13, 12, 14, 5, 4);
+    const int usedBefore = RGBWWLed::getAnimationPoolStats().used;
+    setupFunc(led);
+    return RGBWWLed::getAnimationPoolStats().used - usedBefore;
+}
+
+TEST_CASE(jointAnimationsUseOneSlot) {
+    CHECK_EQUAL(fades * 4, getPoolSlots(setupFadeHSV));
+    CHECK_EQUAL(fades, getPoolSlots(setupFadeHSVJoint));
+    CHECK_EQUAL(1, getPoolSlots(setupTimeline));
+    CHECK_EQUAL(1, getPoolSlots(setupScene));
+}
+
+class EventCounter : public RGBWWLed {
+  public:
+    int animations = 0;
+    int requests = 0;
+    uint16_t lastRequestId = 0;
+
+    virtual void onAnimationFinished(const String& name, bool requeued) override {
+        ++animations;
+    }
+
+    virtual void onRequestFinished(uint16_t requestId, uint16_t channels, const String& name, bool requeued) override {
+        ++requests;
+        lastRequestId = requestId;
+    }
+};
+
+// onAnimationFinished() fires per channel, onRequestFinished() once per fadeHSV()
+TEST_CASE(finishedEventsPerRequest) {
+    EventCounter led;
+    led.init(13, 12, 14, 5, 4);
+    for (int i = 0; i < 10; ++i) {
+        HSVCT c((i * RGBWW_CALC_HUEWHEELMAX) / 10, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL, 2700 + i * 100);
+        led.fadeHSV(RequestHSVCT(c), RampTimeOrSpeed(100), i * 10, HueTransitionDirection::dir_short,
+                    QueuePolicy::Back);
+    }
+    const uint16_t lastRequestId = led.getLastRequestId();
+    for (int frame = 0; frame < 1000 && led.show().nextFrame != 0; ++frame) {
+    }
+
+    CHECK_EQUAL(40, led.animations);
+    CHECK_EQUAL(10, led.requests);
+    CHECK_EQUAL(lastRequestId, led.lastRequestId);
+}
+
+// destroyed after the end of main(), deletes its animations then
+static RGBWWLed staticLed;
+
+TEST_CASE(staticControllerOutlivesMain) {
+    staticLed.init(13, 12, 14, 5, 4);
+    setupFadeHSV(staticLed);
+    setupFadeHSVJoint(staticLed);
+    CHECK(staticLed.show().nextFrame != 0);
+}
@@ -0,0 +1,215 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include <RGBWWLed.h>
+#include "test.h"
+// clang-format on
+
+namespace {
+
+bool sameRGBW(const RGBWCT& a, const RGBWCT& b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.w == b.w;
+}
+
+/**
+ * The conversions depend on saturation and value only through chroma = sat * val / RGBWW_CALC_MAXVAL
+ * and the white part val - chroma. Every hue with every chroma (sat = RGBWW_CALC_MAXVAL, val = chroma)
+ * and every saturation with every value at the boundaries of the sectors cover the whole
+ * hue/sat/val range
+ */
+int countLutMismatches(RGBWWColorUtils& lut, RGBWWColorUtils& calc) {
+    int mismatches = 0;
+    RGBWCT a, b;
+    for (int hue = 0; hue < RGBWW_CALC_HUEWHEELMAX; ++hue) {
+        for (int chroma = 0; chroma <= RGBWW_CALC_MAXVAL; ++chroma) {
+            const HSVCT color(hue, RGBWW_CALC_MAXVAL, chroma);
+            lut.HSVtoRGB(color, a);
+            calc.HSVtoRGB(color, b);
+            if (!sameRGBW(a, b))
+                ++mismatches;
+        }
+    }
+
+    const int hues[] = {0, 1, RGBWW_CALC_MAXVAL, 2 * RGBWW_CALC_MAXVAL + 1, RGBWW_CALC_HUEWHEELMAX / 2,
+                        RGBWW_CALC_HUEWHEELMAX - 1};
+    for (int hue : hues) {
+        for (int sat = 0; sat <= RGBWW_CALC_MAXVAL; ++sat) {
+            for (int val = 0; val <= RGBWW_CALC_MAXVAL; ++val) {
+                const HSVCT color(hue, sat, val);
+                lut.HSVtoRGB(color, a);
+                calc.HSVtoRGB(color, b);
+                if (!sameRGBW(a, b))
+                    ++mismatches;
+            }
+        }
+    }
+    return mismatches;
+}
+
+// the table is enabled before the settings change, so every change has to rebuild it
+void checkLut(RGBWW_HSVMODEL model) {
+    RGBWWColorUtils lut;
+    RGBWWColorUtils calc;
+    lut.setHSVlut(true);
+    CHECK(lut.getHSVlut());
+
+    lut.setHSVmodel(model);
+    calc.setHSVmodel(model);
+    CHECK_EQUAL(0, countLutMismatches(lut, calc));
+
+    const float corrections[][6] = {{10, -10, 20, -20, 30, -30}, {-30, 30, -15, 15, -5, 5}};
+    for (const float* c : corrections) {
+        lut.setHSVcorrection(c[0], c[1], c[2], c[3], c[4], c[5]);
+        calc.setHSVcorrection(c[0], c[1], c[2], c[3], c[4], c[5]);
+        CHECK_EQUAL(0, countLutMismatches(lut, calc));
+    }
+}
+
+// batch conversion of one hue with the given saturations and values, compared to HSVtoRGBraw()
+int countBatchMismatches(const RGBWWColorUtils& utils, int hue, const int* sat, const int* val, int count) {
+    static int hues[RGBWW_CALC_MAXVAL + 1];
+    static int cts[RGBWW_CALC_MAXVAL + 1];
+    static RGBWCT batch[RGBWW_CALC_MAXVAL + 1];
+    for (int i = 0; i < count; ++i) {
+        hues[i] = hue;
+        cts[i] = 2700 + i;
+    }
+    utils.HSVtoRGB(hues, sat, val, cts, batch, count);
+
+    int mismatches = 0;
+    RGBWCT single;
+    for (int i = 0; i < count; ++i) {
+        utils.HSVtoRGBraw(HSVCT(hue, sat[i], val[i], cts[i]), single);
+        if (!sameRGBW(batch[i], single) || batch[i].ct != single.ct)
+            ++mismatches;
+    }
+    return mismatches;
+}
+
+/**
+ * Every hue the kernel accepts (within one sector width around the hue wheel) with
+ * every chroma, every saturation with every value at the boundaries of the sectors,
+ * see countLutMismatches()
+ */
+int countBatchMismatches(const RGBWWColorUtils& utils) {
+    int full[RGBWW_CALC_MAXVAL + 1];
+    int ramp[RGBWW_CALC_MAXVAL + 1];
+    for (int i = 0; i <= RGBWW_CALC_MAXVAL; ++i) {
+        full[i] = RGBWW_CALC_MAXVAL;
+        ramp[i] = i;
+    }
+
+    int mismatches = 0;
+    for (int hue = -RGBWW_CALC_MAXVAL - 2; hue < RGBWW_CALC_HUEWHEELMAX + RGBWW_CALC_MAXVAL + 2; ++hue)
+        mismatches += countBatchMismatches(utils, hue, full, ramp, RGBWW_CALC_MAXVAL + 1);
+
+    const int hues[] = {0, 1, RGBWW_CALC_MAXVAL, 2 * RGBWW_CALC_MAXVAL + 1, RGBWW_CALC_HUEWHEELMAX / 2,
+                        RGBWW_CALC_HUEWHEELMAX - 1};
+    int sat[RGBWW_CALC_MAXVAL + 1];
+    for (int hue : hues) {
+        for (int s = 0; s <= RGBWW_CALC_MAXVAL; ++s) {
+            for (int i = 0; i <= RGBWW_CALC_MAXVAL; ++i)
+                sat[i] = s;
+            mismatches += countBatchMismatches(utils, hue, sat, ramp, RGBWW_CALC_MAXVAL + 1);
+        }
+    }
+    return mismatches;
+}
+
+} // namespace
+
+TEST_CASE(hueLutMatchesRaw) {
+    checkLut(RAW);
+}
+
+TEST_CASE(hueLutMatchesSpektrum) {
+    checkLut(SPEKTRUM);
+}
+
+TEST_CASE(hueLutMatchesRainbow) {
+    checkLut(RAINBOW);
+}
+
+// the table of one model is not used for the other conversions, values outside of the channel range are calculated
+TEST_CASE(hueLutOtherModelsAndRanges) {
+    RGBWWColorUtils lut;
+    RGBWWColorUtils calc;
+    lut.setHSVlut(true);
+    lut.setHSVmodel(RAINBOW);
+
+    RGBWCT a, b;
+    int mismatches = 0;
+    for (int hue = -10; hue < RGBWW_CALC_HUEWHEELMAX + 10; ++hue) {
+        const HSVCT colors[] = {HSVCT(hue, 700, 900), HSVCT(hue, RGBWW_CALC_MAXVAL + 5, 900),
+                                HSVCT(hue, 700, RGBWW_CALC_MAXVAL + 5)};
+        for (const HSVCT& color : colors) {
+            for (RGBWW_HSVMODEL model : {RAW, SPEKTRUM, RAINBOW}) {
+                lut.HSVtoRGB(color, a, model);
+                calc.HSVtoRGB(color, b, model);
+                if (!sameRGBW(a, b))
+                    ++mismatches;
+            }
+        }
+    }
+    CHECK_EQUAL(0, mismatches);
+
+    lut.setHSVlut(false);
+    CHECK(!lut.getHSVlut());
+}
+
+// the SSE2 kernel of the RAW model converts bit by bit like HSVtoRGBraw()
+TEST_CASE(batchMatchesRaw) {
+    RGBWWColorUtils utils;
+    CHECK_EQUAL(0, countBatchMismatches(utils));
+
+    const float corrections[][6] = {{10, -10, 20, -20, 30, -30}, {-30, 30, -15, 15, -5, 5},
+                                    {30, 30, 30, 30, 30, 30}, {-30, -30, -30, -30, -30, -30}};
+    for (const float* c : corrections) {
+        utils.setHSVcorrection(c[0], c[1], c[2], c[3], c[4], c[5]);
+        CHECK_EQUAL(0, countBatchMismatches(utils));
+    }
+}
+
+// values outside of the channel ranges, counts which are no multiple of four, arrays of structs
+// and the other models give the same colors as the single conversion
+TEST_CASE(batchOtherRangesAndModels) {
+    const int count = 103;
+    HSVCT colors[count];
+    int hue[count], sat[count], val[count], ct[count];
+    for (int i = 0; i < count; ++i) {
+        colors[i] = HSVCT((i * 997) % (4 * RGBWW_CALC_HUEWHEELMAX) - 2 * RGBWW_CALC_HUEWHEELMAX,
+                          (i * 389) % (RGBWW_CALC_MAXVAL + 20) - 10, (i * 211) % (RGBWW_CALC_MAXVAL + 20) - 10,
+                          2700 + i);
+        hue[i] = colors[i].h;
+        sat[i] = colors[i].s;
+        val[i] = colors[i].v;
+        ct[i] = colors[i].ct;
+    }
+
+    int mismatches = 0;
+    for (RGBWW_HSVMODEL model : {RAW, SPEKTRUM, RAINBOW}) {
+        RGBWWColorUtils utils;
+        utils.setHSVmodel(model);
+        for (int n : {0, 1, 3, 4, 5, count}) {
+            RGBWCT soa[count], aos[count], single;
+            ChannelOutput output[count], singleOutput;
+            utils.HSVtoRGB(hue, sat, val, ct, soa, n);
+            utils.HSVtoRGB(colors, aos, n);
+            utils.HSVtoOutput(colors, output, n);
+            for (int i = 0; i < n; ++i) {
+                utils.HSVtoRGB(colors[i], single);
+                utils.whiteBalance(single, singleOutput);
+                utils.correctBrightness(singleOutput);
+                if (!sameRGBW(soa[i], single) || !sameRGBW(aos[i], single) || soa[i].ct != single.ct ||
+                    aos[i].ct != single.ct || !(output[i] == singleOutput))
+                    ++mismatches;
+            }
+        }
+    }
+    CHECK_EQUAL(0, mismatches);
+}
@@ -0,0 +1,143 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include <RGBWWLed.h>
+#include <RGBWWLedGroup.h>
+#include "test.h"
+// clang-format on
+
+namespace {
+
+const HSVCT startColor(100, 200, 300, 3000);
+
+struct Fade {
+    HSVCT color;
+    RampTimeOrSpeed ramp;
+    int stay;
+    HueTransitionDirection direction;
+};
+
+const Fade fadeList[] = {
+    {HSVCT(5000, 1023, 0, 6000), RampTimeOrSpeed(1000), 0, HueTransitionDirection::dir_short},
+    {HSVCT(200, 0, 1023, 2700), RampTimeOrSpeed(35), 40, HueTransitionDirection::dir_long},
+    {HSVCT(6000, 512, 511, 2701), RampTimeOrSpeed(20000), 0, HueTransitionDirection::dir_short},
+    {HSVCT(1, 1, 1, 6500), RampTimeOrSpeed(3000, RampTimeOrSpeed::Type::Speed), 100,
+     HueTransitionDirection::dir_long},
+};
+
+// counts the fixtures whose output differs from the single conversion of their color
+class OutputChecker : public RGBWWLedGroup {
+  public:
+    int changed = 0;
+    int mismatches = 0;
+
+    virtual void onOutputChanged(int fixture, const ChannelOutput& output) override {
+        ++changed;
+        RGBWCT rgbwk;
+        ChannelOutput expected;
+        colorutils.HSVtoRGB(getCurrentColor(fixture), rgbwk);
+        colorutils.whiteBalance(rgbwk, expected);
+        colorutils.correctBrightness(expected);
+        if (!(expected == output))
+            ++mismatches;
+    }
+};
+
+} // namespace
+
+// the fixtures of a group fade like the channels of a controller, for any frame interval
+TEST_CASE(groupMatchesController) {
+    const int intervals[] = {RGBWW_STEPTIME, 20, 35, 1000};
+    for (int interval : intervals) {
+        for (const Fade& fade : fadeList) {
+            RGBWWLed led;
+            led.init(13, 12, 14, 5, 4);
+            REQUIRE(led.setFrameInterval(interval));
+            led.colorDirectHSV(RequestHSVCT(startColor));
+            led.show();
+
+            RGBWWLedGroup group;
+            REQUIRE(group.init(1));
+            REQUIRE(group.setFrameInterval(interval));
+            group.colorDirectHSV(0, RequestHSVCT(startColor));
+            group.show();
+
+            led.fadeHSV(RequestHSVCT(fade.color), fade.ramp, fade.stay, fade.direction, QueuePolicy::Single);
+            REQUIRE(group.fadeHSV(0, RequestHSVCT(fade.color), fade.ramp, fade.stay, fade.direction));
+
+            int mismatches = 0;
+            int frames = 0;
+            while (group.isAnimationActive(0) && frames < 100000) {
+                led.show();
+                group.show();
+                ++frames;
+                if (!(led.getCurrentColor() == group.getCurrentColor(0)))
+                    ++mismatches;
+            }
+            CHECK_EQUAL(0, mismatches);
+            CHECK_EQUAL(0, led.show().nextFrame);
+            CHECK(fade.color == group.getCurrentColor(0));
+        }
+    }
+}
+
+TEST_CASE(groupFadeFinishesOnTime) {
+    RGBWWLedGroup group;
+    REQUIRE(group.init(2));
+    REQUIRE(group.setFrameInterval(20));
+    REQUIRE(group.fadeHSV(0, RequestHSVCT(HSVCT(3000, 1023, 1023, 4000)), RampTimeOrSpeed(1000), 500));
+    REQUIRE(group.fadeHSV(1, RequestHSVCT(HSVCT(3000, 1023, 1023, 4000)), RampTimeOrSpeed(990), 0));
+
+    int finished[2] = {0, 0};
+    for (int frame = 1; frame <= 100; ++frame) {
+        group.show();
+        for (int i = 0; i < 2; ++i) {
+            if (finished[i] == 0 && !group.isAnimationActive(i))
+                finished[i] = frame;
+        }
+    }
+    // 1500 ms and 990 ms in frames of 20 ms
+    CHECK_EQUAL(75, finished[0]);
+    CHECK_EQUAL(50, finished[1]);
+}
+
+TEST_CASE(groupFrameIntervalMultipleOfStepTime) {
+    RGBWWLedGroup group;
+    CHECK_EQUAL(RGBWW_MINTIMEDIFF, group.getFrameInterval());
+    CHECK(!group.setFrameInterval(33));
+    CHECK(!group.setFrameInterval(0));
+    CHECK_EQUAL(RGBWW_MINTIMEDIFF, group.getFrameInterval());
+    CHECK(group.setFrameInterval(RGBWW_STEPTIME));
+    CHECK_EQUAL(RGBWW_STEPTIME, group.getFrameInterval());
+}
+
+// the changed fixtures are converted in batches, with the same output as the single conversion
+TEST_CASE(groupBatchOutputMatchesSingle) {
+    const int fixtures = 101;
+    OutputChecker group;
+    REQUIRE(group.init(fixtures));
+    group.show();
+    CHECK_EQUAL(fixtures, group.changed);
+
+    // every third fixture fades, so the changed fixtures are spread over the group
+    for (int i = 0; i < fixtures; i += 3) {
+        HSVCT c((i * 397) % RGBWW_CALC_HUEWHEELMAX, (i * 131) % (RGBWW_CALC_MAXVAL + 1), RGBWW_CALC_MAXVAL,
+                2700 + i * 30);
+        REQUIRE(group.fadeHSV(i, RequestHSVCT(c), RampTimeOrSpeed(500 + i * 10)));
+    }
+    for (int frame = 0; frame < 100; ++frame)
+        group.show();
+    CHECK(group.changed > fixtures + 34 * 10);
+
+    // changed settings convert every fixture
+    group.changed = 0;
+    group.colorutils.setHSVcorrection(10, -10, 20, -20, 30, -30);
+    group.show();
+    CHECK_EQUAL(fixtures, group.changed);
+    CHECK_EQUAL(0, group.mismatches);
+}
@@ -0,0 +1,49 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include <RGBWWLed.h>
+#include "test.h"
+// clang-format on
+
+static TestCase* firstCase = nullptr;
+static TestCase* lastCase = nullptr;
+static int failures = 0;
+
+TestCase::TestCase(const char* name, Function function) : _name(name), _function(function), _next(nullptr) {
+    // keep the order of the definitions within a file
+    if (lastCase != nullptr)
+        lastCase->_next = this;
+    else
+        firstCase = this;
+    lastCase = this;
+}
+
+void TestCase::fail(const char* file, int line, const char* expression) {
+    std::cout << "  " << file << ":" << line << ": check failed: " << expression << "\n";
+    ++failures;
+}
+
+int TestCase::runAll(const char* filter) {
+    int cases = 0;
+    for (TestCase* test = firstCase; test != nullptr; test = test->_next) {
+        if (filter != nullptr && strstr(test->_name, filter) == nullptr)
+            continue;
+
+        const int before = failures;
+        test->_function();
+        std::cout << ((failures == before) ? "pass " : "FAIL ") << test->_name << "\n";
+        ++cases;
+    }
+    std::cout << cases << " test cases, " << failures << " failed checks\n";
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    // the animation pool is initialized by the first controller and shared by all test cases
+    return (TestCase::runAll((argc > 1) ? argv[1] : nullptr) == 0) ? 0 : 1;
+}
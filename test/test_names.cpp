@@ -0,0 +1,112 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include <RGBWWLed.h>
+#include <string>
+#include <vector>
+#include "host.h"
+#include "test.h"
+// clang-format on
+
+namespace {
+
+class NamedLed : public RGBWWLed {
+  public:
+    std::vector<std::string> finished;
+
+    virtual void onAnimationFinished(const String& name, bool requeued) override {
+        finished.push_back(name.c_str());
+    }
+};
+
+String nameOf(int i) {
+    return String("fade") + String(i);
+}
+
+void runAll(NamedLed& led) {
+    for (int frame = 0; frame < 1000; ++frame)
+        led.show();
+}
+
+} // namespace
+
+// a new name is rejected instead of being dropped while all names are in use
+TEST_CASE(namesTableFullRejectsNewName) {
+    NamedLed led;
+    led.init(13, 12, 14, 5, 4);
+    const RGBWWLedAnimationNames& names = RGBWWLed::getAnimationNames();
+
+    // the table is shared by all controllers, other tests may hold names
+    const int free = RGBWW_ANIMATIONNAMES - names.getUsed();
+    REQUIRE(free > 0);
+    for (int i = 0; i < free; ++i) {
+        REQUIRE(led.fadeHSV(RequestHSVCT(HSVCT(i * 100, 1023, 1023)), RampTimeOrSpeed(20), 0,
+                            HueTransitionDirection::dir_short, QueuePolicy::Back, false, nameOf(i)));
+    }
+    CHECK_EQUAL(RGBWW_ANIMATIONNAMES, names.getUsed());
+    CHECK(!names.isAvailable("new"));
+
+    CHECK(!led.fadeHSV(RequestHSVCT(HSVCT(0, 0, 0)), RampTimeOrSpeed(20), 0, HueTransitionDirection::dir_short,
+                       QueuePolicy::Back, false, "new"));
+    CHECK(!led.fadeRAW(RequestChannelOutput(ChannelOutput(1, 2, 3, 4, 5)), RampTimeOrSpeed(20), 0,
+                       QueuePolicy::Back, false, "new"));
+    CHECK(!led.fadeHSVJoint(RequestHSVCT(HSVCT(0, 0, 0)), RampTimeOrSpeed(20), 0, HueTransitionDirection::dir_short,
+                            QueuePolicy::Back, false, "new"));
+    CHECK(!led.blink(RGBWWLed::ChannelList(), 100, QueuePolicy::Back, false, "new"));
+
+    // names in use and the empty name still work
+    CHECK(led.fadeHSV(RequestHSVCT(HSVCT(0, 0, 0)), RampTimeOrSpeed(20), 0, HueTransitionDirection::dir_short,
+                      QueuePolicy::Back, false, nameOf(0)));
+    CHECK(led.fadeHSV(RequestHSVCT(HSVCT(0, 0, 0)), RampTimeOrSpeed(20), 0, HueTransitionDirection::dir_short,
+                      QueuePolicy::Back));
+
+    runAll(led);
+    for (const std::string& name : led.finished)
+        CHECK(name != "new");
+    CHECK(led.finished.size() == size_t(4 * (free + 2)));
+
+    // finished animations release their names
+    CHECK(names.isAvailable("new"));
+    led.finished.clear();
+    CHECK(led.fadeHSV(RequestHSVCT(HSVCT(0, 0, 0)), RampTimeOrSpeed(20), 0, HueTransitionDirection::dir_short,
+                      QueuePolicy::Back, false, "new"));
+    runAll(led);
+    CHECK(led.finished.size() == 4);
+    CHECK(led.finished[0] == "new");
+}
+
+// a queue of named animations takes one entry of the name table, the animations hold
+// its index instead of a copy of the name
+TEST_CASE(namedQueueWithoutHeap) {
+    NamedLed led;
+    led.init(13, 12, 14, 5, 4);
+    const RGBWWLedAnimationNames& names = RGBWWLed::getAnimationNames();
+    const int usedBefore = names.getUsed();
+    // as many fades as fit into the pool, other tests may hold animations
+    const AnimationPoolStats& pool = RGBWWLed::getAnimationPoolStats();
+    const int poolBefore = pool.used;
+    const int fades = min((pool.capacity - pool.used) / 4, 9);
+    REQUIRE(fades >= 4);
+    const String name = "evening scene living room";
+
+    REQUIRE(led.fadeHSV(RequestHSVCT(HSVCT(0, 1023, 1023)), RampTimeOrSpeed(4000), 0,
+                        HueTransitionDirection::dir_short, QueuePolicy::Back, false, name));
+    const HostAllocStats before = hostAllocStats();
+    for (int i = 1; i < fades; ++i) {
+        CHECK(led.fadeHSV(RequestHSVCT(HSVCT(i * 100, 1023, 1023, 2700 + i * 100)), RampTimeOrSpeed(4000), 0,
+                          HueTransitionDirection::dir_short, QueuePolicy::Back, false, name));
+    }
+    CHECK_EQUAL(before.allocs, hostAllocStats().allocs);
+    CHECK_EQUAL(usedBefore + 1, names.getUsed());
+    CHECK_EQUAL(poolBefore + fades * 4, pool.used);
+
+    led.clearAnimationQueue();
+    led.skipAnimation();
+    led.show();
+    CHECK_EQUAL(usedBefore, names.getUsed());
+}
@@ -0,0 +1,82 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include <RGBWWLed.h>
+#include "host.h"
+#include "test.h"
+// clang-format on
+
+namespace {
+
+const uint8_t pins[RGBWW_CHANNELS::NUM_CHANNELS] = {13, 12, 14, 5, 4};
+
+void initLed(RGBWWLed& led) {
+    led.init(pins[RGBWW_CHANNELS::RED], pins[RGBWW_CHANNELS::GREEN], pins[RGBWW_CHANNELS::BLUE],
+             pins[RGBWW_CHANNELS::WW], pins[RGBWW_CHANNELS::CW]);
+}
+
+// duty of PWMOutput::setOutput() for a value of the dim curve, at the default frequency of 200 Hz
+uint32_t expectedDuty(int value) {
+    const float factor = (5000 * 1000 / 45) / 65535.0f;
+    return uint32_t(int(roundf(RGBWW_dim_curve[value] * factor)));
+}
+
+// every value of every channel through the duty tables, compared with the brightness
+// correction, dim curve and scaling done one after the other
+int countDutyMismatches(RGBWWLed& led) {
+    int mismatches = 0;
+    for (int value = 0; value <= RGBWW_CALC_MAXVAL; ++value) {
+        const ChannelOutput output(value, RGBWW_CALC_MAXVAL - value, value, RGBWW_CALC_MAXVAL - value, value);
+        led.fadeRAW(RequestChannelOutput(output), RampTimeOrSpeed(0), 0);
+        led.show();
+
+        ChannelOutput corrected = output;
+        led.colorutils.correctBrightness(corrected);
+        const int values[RGBWW_CHANNELS::NUM_CHANNELS] = {corrected.r, corrected.g, corrected.b, corrected.ww,
+                                                          corrected.cw};
+        for (int ch = 0; ch < RGBWW_CHANNELS::NUM_CHANNELS; ++ch) {
+            if (HardwarePWM::getPinDuty(pins[ch]) != expectedDuty(values[ch]))
+                ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
+} // namespace
+
+// the ESP8266 hardware PWM has a duty range of 111111 at 200 Hz, beyond 16 bit
+TEST_CASE(dutyTablesCoverDefaultDutyRange) {
+    RGBWWLed led;
+    initLed(led);
+
+    const HostAllocStats before = hostAllocStats();
+    led.show();
+    const HostAllocStats& after = hostAllocStats();
+
+    // all channels share one table with the default brightness correction
+    CHECK_EQUAL(before.allocs + 1, after.allocs);
+    CHECK_EQUAL(before.bytes + (RGBWW_CALC_MAXVAL + 1) * sizeof(uint32_t), after.bytes);
+    CHECK_EQUAL(uint32_t(5000 * 1000 / 45), expectedDuty(RGBWW_CALC_MAXVAL));
+    CHECK_EQUAL(0, countDutyMismatches(led));
+}
+
+TEST_CASE(dutyTablesFollowBrightnessCorrection) {
+    RGBWWLed led;
+    initLed(led);
+    led.show();
+
+    const HostAllocStats before = hostAllocStats();
+    led.colorutils.setBrightnessCorrection(100, 80, 50, 80, 30);
+    led.show();
+    const HostAllocStats& after = hostAllocStats();
+
+    // the table of the default is replaced by one table per distinct correction
+    CHECK_EQUAL(before.allocs + 4, after.allocs);
+    CHECK_EQUAL(before.frees + 1, after.frees);
+    CHECK_EQUAL(0, countDutyMismatches(led));
+}
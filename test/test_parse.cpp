@@ -0,0 +1,288 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include <RGBWWLed.h>
+#include <string>
+#include <vector>
+#include "host.h"
+#include "test.h"
+// clang-format on
+
+namespace {
+
+// HSVCT::operator=(String&) before HSVCT::parse(), with one String per value
+bool assignSplitString(HSVCT& color, const std::string& str) {
+    String colorStr(str.c_str());
+    Vector<String> tokens;
+    splitString(colorStr, ',', tokens);
+
+    if (tokens.size() < 3 || tokens.size() > 4)
+        return false;
+
+    color.h = (constrain(tokens[0].toFloat(), 0.0, 360.0) / 360) * RGBWW_CALC_HUEWHEELMAX;
+    color.s = (constrain(tokens[1].toFloat(), 0.0, 100.0) / 100) * RGBWW_CALC_MAXVAL;
+    color.v = (constrain(tokens[2].toFloat(), 0.0, 100.0) / 100) * RGBWW_CALC_MAXVAL;
+
+    if (tokens.size() > 3)
+        color.colortemp = tokens[3].toInt();
+    return true;
+}
+
+// ChannelOutput::operator=(String&) before ChannelOutput::parse()
+bool assignSplitString(ChannelOutput& output, const std::string& str) {
+    String channelStr(str.c_str());
+    Vector<String> tokens;
+    splitString(channelStr, ',', tokens);
+
+    if (tokens.size() != 5)
+        return false;
+
+    output.r = constrain(tokens[0].toInt(), 0, 1023);
+    output.g = constrain(tokens[1].toInt(), 0, 1023);
+    output.b = constrain(tokens[2].toInt(), 0, 1023);
+    output.ww = constrain(tokens[3].toInt(), 0, 1023);
+    output.cw = constrain(tokens[4].toInt(), 0, 1023);
+    return true;
+}
+
+bool isInRange(const HSVCT& color) {
+    return color.h >= 0 && color.h <= RGBWW_CALC_HUEWHEELMAX && color.s >= 0 && color.s <= RGBWW_CALC_MAXVAL &&
+           color.v >= 0 && color.v <= RGBWW_CALC_MAXVAL;
+}
+
+bool isInRange(const ChannelOutput& output) {
+    const int values[] = {output.r, output.g, output.b, output.ww, output.cw};
+    for (int value : values) {
+        if (value < 0 || value > RGBWW_CALC_MAXVAL)
+            return false;
+    }
+    return true;
+}
+
+struct Random {
+    uint32_t state = 2463534242u;
+
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    int below(int max) {
+        return int(next() % uint32_t(max));
+    }
+};
+
+// a number as sent by clients, sometimes with a sign, spaces or more digits than parse() takes
+std::string randomNumber(Random& random) {
+    std::string number;
+    if (random.below(8) == 0)
+        number += ' ';
+    if (random.below(8) == 0)
+        number += '-';
+    const int digits = 1 + random.below(random.below(4) == 0 ? 10 : 4);
+    for (int i = 0; i < digits; ++i)
+        number += char('0' + random.below(10));
+    if (random.below(2) == 0) {
+        number += '.';
+        const int decimals = random.below(random.below(4) == 0 ? 10 : 4);
+        for (int i = 0; i < decimals; ++i)
+            number += char('0' + random.below(10));
+    }
+    if (random.below(8) == 0)
+        number += ' ';
+    return number;
+}
+
+std::string randomCommand(Random& random, int values) {
+    std::string command;
+    for (int i = 0; i < values; ++i) {
+        if (i > 0)
+            command += ',';
+        command += randomNumber(random);
+    }
+
+    // replace, insert or remove characters
+    static const char alphabet[] = "0123456789.,- +e\t";
+    const int mutations = random.below(4) == 0 ? 1 + random.below(3) : 0;
+    for (int i = 0; i < mutations && !command.empty(); ++i) {
+        const int pos = random.below(command.size());
+        const char c = alphabet[random.below(sizeof(alphabet) - 1)];
+        switch (random.below(3)) {
+        case 0:
+            command[pos] = c;
+            break;
+        case 1:
+            command.insert(command.begin() + pos, c);
+            break;
+        default:
+            command.erase(pos, 1);
+            break;
+        }
+    }
+    return command;
+}
+
+struct FuzzResult {
+    int parsed = 0;
+    int outOfRange = 0;  // parsed values outside of the channel range
+    int changed = 0;     // value changed although not parsed
+    int mismatches = 0;  // parsed, but not the same as the String assignment
+    uint32_t allocs = 0; // allocations of parse()
+};
+
+template <typename Color> void fuzz(const std::string& command, const Color& start, FuzzResult& result) {
+    // the command without terminating zero, exactly sized to catch reads beyond length
+    char* buffer = new char[command.size()];
+    memcpy(buffer, command.data(), command.size());
+
+    Color color = start;
+    const uint32_t allocs = hostAllocStats().allocs;
+    const ParseStatus status = color.parse(buffer, command.size());
+    result.allocs += hostAllocStats().allocs - allocs;
+    delete[] buffer;
+
+    if (status != ParseStatus::Ok) {
+        if (!(color == start))
+            ++result.changed;
+        return;
+    }
+
+    ++result.parsed;
+    if (!isInRange(color))
+        ++result.outOfRange;
+
+    Color expected = start;
+    if (!assignSplitString(expected, command) || !(color == expected))
+        ++result.mismatches;
+}
+
+} // namespace
+
+TEST_CASE(parseHSVCTFuzz) {
+    Random random;
+    FuzzResult result;
+    const HSVCT start(100, 200, 300, 4000);
+    for (int i = 0; i < 200000; ++i)
+        fuzz(randomCommand(random, 2 + random.below(4)), start, result);
+
+    CHECK(result.parsed > 50000);
+    CHECK_EQUAL(0, result.outOfRange);
+    CHECK_EQUAL(0, result.changed);
+    CHECK_EQUAL(0, result.mismatches);
+    CHECK_EQUAL(0u, result.allocs);
+}
+
+TEST_CASE(parseChannelOutputFuzz) {
+    Random random;
+    FuzzResult result;
+    const ChannelOutput start(1, 2, 3, 4, 5);
+    for (int i = 0; i < 200000; ++i)
+        fuzz(randomCommand(random, 4 + random.below(3)), start, result);
+
+    CHECK(result.parsed > 30000);
+    CHECK_EQUAL(0, result.outOfRange);
+    CHECK_EQUAL(0, result.changed);
+    CHECK_EQUAL(0, result.mismatches);
+    CHECK_EQUAL(0u, result.allocs);
+}
+
+// every hue, saturation and value with up to 3 decimals, the float math of the String
+// assignment is not always the exact scaling
+TEST_CASE(parseHSVCTMatchesStringAssignment) {
+    FuzzResult result;
+    char command[64];
+    for (int i = 0; i <= 360000; ++i) {
+        const int sv = i % 100001;
+        snprintf(command, sizeof(command), "%d.%03d,%d.%03d,%d.%03d", i / 1000, i % 1000, sv / 1000, sv % 1000,
+                 (100000 - sv) / 1000, (100000 - sv) % 1000);
+        fuzz(command, HSVCT(), result);
+    }
+    CHECK_EQUAL(360001, result.parsed);
+    CHECK_EQUAL(0, result.mismatches);
+}
+
+// the commands of the color parser benchmark of examples/benchmark
+TEST_CASE(parseBenchmarkCommandsMatchStringAssignment) {
+    FuzzResult result;
+    fuzz("120.5,100,75,2700", HSVCT(), result);
+    fuzz("1023,512,0,100,800", ChannelOutput(), result);
+    CHECK_EQUAL(2, result.parsed);
+    CHECK_EQUAL(0, result.mismatches);
+}
+
+TEST_CASE(parseStatus) {
+    HSVCT color;
+    CHECK(color.parse("", 0) == ParseStatus::Empty);
+    CHECK(color.parse("1,2", 3) == ParseStatus::TokenCount);
+    CHECK(color.parse("1,2,3,4,5", 9) == ParseStatus::TokenCount);
+    CHECK(color.parse("1,x,3", 5) == ParseStatus::Malformed);
+    CHECK(color.parse("1,2,3,", 6) == ParseStatus::Malformed);
+    CHECK(color.parse("1.0000000001,2,3", 16) == ParseStatus::Malformed);
+    CHECK(color.parse("360,100,100,-5", 14) == ParseStatus::Ok);
+    CHECK(HSVCT(RGBWW_CALC_HUEWHEELMAX, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL, -5) == color);
+
+    ChannelOutput output;
+    CHECK(output.parse("1,2,3,4", 7) == ParseStatus::TokenCount);
+    CHECK(output.parse("1,2,3,4,5.9", 11) == ParseStatus::Ok);
+    CHECK(ChannelOutput(1, 2, 3, 4, 5) == output);
+    CHECK(output.parse("-1,2000,3,4,5", 13) == ParseStatus::Ok);
+    CHECK(ChannelOutput(0, 1023, 3, 4, 5) == output);
+}
+
+// the parameters of the AbsOrRelValue benchmark of examples/benchmark
+TEST_CASE(parseAbsOrRelValueMatchesString) {
+    const char* const inputs[] = {"120", "+30", "100", "50.5", "2700", "1023", "+10", "12.25"};
+    const AbsOrRelValue::Type types[] = {AbsOrRelValue::Type::Hue,     AbsOrRelValue::Type::Hue,
+                                         AbsOrRelValue::Type::Percent, AbsOrRelValue::Type::Percent,
+                                         AbsOrRelValue::Type::Ct,      AbsOrRelValue::Type::Raw,
+                                         AbsOrRelValue::Type::Raw,     AbsOrRelValue::Type::Percent};
+    for (unsigned i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i) {
+        AbsOrRelValue value;
+        CHECK(AbsOrRelValue::parse(inputs[i], strlen(inputs[i]), types[i], value));
+        CHECK(value == AbsOrRelValue(String(inputs[i]), types[i]));
+        CHECK(value.getType() == types[i]);
+    }
+}
+
+// absolute and positive relative values with up to 3 decimals for every type, the float math
+// of the String constructor is not always the exact scaling
+TEST_CASE(parseAbsOrRelValueSweepMatchesString) {
+    const AbsOrRelValue::Type types[] = {AbsOrRelValue::Type::Raw, AbsOrRelValue::Type::Hue,
+                                         AbsOrRelValue::Type::Percent, AbsOrRelValue::Type::Ct};
+    int parsed = 0;
+    int mismatches = 0;
+    int asymmetric = 0;
+    char str[32];
+    for (AbsOrRelValue::Type type : types) {
+        for (int i = 0; i <= 1100000; i += 7) {
+            for (const char* sign : {"", "+"}) {
+                const int length = snprintf(str, sizeof(str), "%s%d.%03d", sign, i / 1000, i % 1000);
+                AbsOrRelValue value;
+                if (!AbsOrRelValue::parse(str, length, type, value))
+                    continue;
+                ++parsed;
+                if (!(value == AbsOrRelValue(String(str), type)))
+                    ++mismatches;
+            }
+
+            // negative relative values are rounded symmetrically
+            const int length = snprintf(str, sizeof(str), "-%d.%03d", i / 1000, i % 1000);
+            AbsOrRelValue negative;
+            str[0] = '+';
+            const AbsOrRelValue positive(String(str), type);
+            str[0] = '-';
+            if (!AbsOrRelValue::parse(str, length, type, negative) || negative.getValue() != -positive.getValue())
+                ++asymmetric;
+        }
+    }
+    CHECK_EQUAL(4 * 2 * (1100000 / 7 + 1), parsed);
+    CHECK_EQUAL(0, mismatches);
+    CHECK_EQUAL(0, asymmetric);
+}
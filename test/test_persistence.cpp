@@ -0,0 +1,130 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include <RGBWWLed.h>
+#include <RGBWWLedPersistence.h>
+#include "test.h"
+// clang-format on
+
+namespace {
+
+// slots in RAM, counts the writes per slot a flash would see
+class RamStorage : public RGBWWLedStorage {
+  public:
+    static const int Slots = 4;
+    static const size_t SlotSize = 1024;
+
+    int slotWrites[Slots] = {};
+
+    virtual int getSlotCount() const override {
+        return Slots;
+    }
+
+    virtual size_t getSlotSize() const override {
+        return SlotSize;
+    }
+
+    virtual bool read(int slot, size_t offset, void* data, size_t size) override {
+        memcpy(data, _data[slot] + offset, size);
+        return true;
+    }
+
+    virtual bool write(int slot, size_t offset, const void* data, size_t size) override {
+        memcpy(_data[slot] + offset, data, size);
+        ++slotWrites[slot];
+        return true;
+    }
+
+  private:
+    uint8_t _data[Slots][SlotSize] = {};
+};
+
+class FinishCounter : public RGBWWLed {
+  public:
+    int animations = 0;
+
+    virtual void onAnimationFinished(const String& name, bool requeued) override {
+        ++animations;
+    }
+};
+
+void runFrames(RGBWWLed& led, RGBWWLedPersistence& persistence, uint32_t& now, uint32_t duration) {
+    for (const uint32_t end = now + duration; now < end; now += led.getFrameInterval()) {
+        led.show();
+        persistence.process(now);
+    }
+}
+
+} // namespace
+
+// a burst of 50 commands within one second followed by one command every two minutes
+// is saved once per command that was followed by a quiet period, not on every change
+TEST_CASE(persistenceSavesAfterQuietPeriod) {
+    FinishCounter led;
+    led.init(13, 12, 14, 5, 4);
+    RamStorage storage;
+    RGBWWLedPersistence persistence(led, storage);
+
+    uint32_t now = 0;
+    for (int i = 0; i < 50; ++i) {
+        HSVCT c((i * 389) % RGBWW_CALC_HUEWHEELMAX, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL, 2700);
+        led.fadeHSV(RequestHSVCT(c), RampTimeOrSpeed(500), 0, HueTransitionDirection::dir_short, QueuePolicy::Single);
+        runFrames(led, persistence, now, led.getFrameInterval());
+    }
+    CHECK_EQUAL(0u, persistence.getStats().saves);
+
+    const int commands = 5;
+    for (int i = 0; i < commands; ++i) {
+        HSVCT c(i * 200, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL / 2, 2700);
+        led.fadeHSV(RequestHSVCT(c), RampTimeOrSpeed(2000), 0, HueTransitionDirection::dir_short, QueuePolicy::Single);
+        runFrames(led, persistence, now, 120000);
+        CHECK(!persistence.isDirty());
+    }
+
+    // the burst is saved together with the first command
+    const PersistenceStats& stats = persistence.getStats();
+    CHECK(stats.changes > uint32_t(50 + commands));
+    CHECK_EQUAL(uint32_t(commands), stats.saves);
+    CHECK_EQUAL(0u, stats.unchanged);
+    CHECK_EQUAL(0u, stats.failed);
+    CHECK(int(stats.writes) < led.animations / 10);
+
+    // the saves go round robin through the slots
+    for (int i = 0; i < RamStorage::Slots; ++i)
+        CHECK(storage.slotWrites[i] > 0);
+
+    RGBWWLed restored;
+    restored.init(13, 12, 14, 5, 4);
+    RGBWWLedPersistence restoredPersistence(restored, storage);
+    REQUIRE(restoredPersistence.restore());
+    restored.show();
+    CHECK(restored.getCurrentColor() == led.getCurrentColor());
+    CHECK(restored.getCurrentOutput() == led.getCurrentOutput());
+}
+
+TEST_CASE(persistenceFlushSavesAtOnce) {
+    RGBWWLed led;
+    led.init(13, 12, 14, 5, 4);
+    RamStorage storage;
+    RGBWWLedPersistence persistence(led, storage);
+
+    led.colorDirectHSV(RequestHSVCT(HSVCT(1000, 500, 700, 3000)));
+    led.show();
+    CHECK(!persistence.process(0));
+    CHECK(persistence.isDirty());
+    CHECK(persistence.flush());
+    CHECK(!persistence.isDirty());
+    CHECK_EQUAL(1u, persistence.getStats().saves);
+
+    RGBWWLed restored;
+    restored.init(13, 12, 14, 5, 4);
+    RGBWWLedPersistence restoredPersistence(restored, storage);
+    REQUIRE(restoredPersistence.restore());
+    restored.show();
+    CHECK(restored.getCurrentColor() == led.getCurrentColor());
+}
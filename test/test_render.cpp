@@ -0,0 +1,115 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include <RGBWWLed.h>
+#include <RGBWWLedRenderer.h>
+#include <string>
+#include <vector>
+#include "test.h"
+// clang-format on
+
+namespace {
+
+// counts the bytes and lines, keeps the first bytes
+class CapturePrint : public Print {
+  public:
+    uint32_t bytes = 0;
+    uint32_t lines = 0;
+    std::string head;
+
+    virtual size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    virtual size_t write(const uint8_t* buffer, size_t size) override {
+        bytes += size;
+        for (size_t i = 0; i < size; ++i) {
+            if (buffer[i] == '\n')
+                ++lines;
+            if (head.size() < 256)
+                head += char(buffer[i]);
+        }
+        return size;
+    }
+};
+
+class FrameSink : public RGBWWLedRenderSink {
+  public:
+    std::vector<RenderFrame> frames;
+
+    virtual bool write(const RenderFrame& frame) override {
+        frames.push_back(frame);
+        return true;
+    }
+};
+
+void setupFades(RGBWWLed& led) {
+    for (int i = 0; i < 10; ++i) {
+        HSVCT c((i * RGBWW_CALC_HUEWHEELMAX) / 10, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL, 2700 + i * 300);
+        led.fadeHSV(RequestHSVCT(c), RampTimeOrSpeed(4000), 0, HueTransitionDirection::dir_short, QueuePolicy::Back,
+                    true);
+    }
+}
+
+uint32_t renderHour(RGBWWLedRenderSink& sink) {
+    RGBWWLed led;
+    setupFades(led);
+    RGBWWLedRenderer renderer(led);
+
+    uint32_t frames = 0;
+    for (int minute = 0; minute < 60; ++minute)
+        frames += renderer.render(sink, 60000);
+    CHECK_EQUAL(uint32_t(3600000), renderer.getTime());
+    return frames;
+}
+
+} // namespace
+
+// one hour of requeued fades at 50 Hz, rendered in steps of a minute
+TEST_CASE(renderHourBinary) {
+    CapturePrint out;
+    RGBWWLedBinarySink sink(out);
+    const uint32_t frames = renderHour(sink);
+
+    CHECK_EQUAL(uint32_t(3600000 / RGBWW_MINTIMEDIFF), frames);
+    CHECK_EQUAL(7 + frames * RGBWWLedBinarySink::RecordSize, out.bytes);
+    CHECK(out.head.compare(0, 5, std::string("RGBR\x01", 5)) == 0);
+    CHECK_EQUAL(RGBWW_MINTIMEDIFF, uint8_t(out.head[5]) | (uint8_t(out.head[6]) << 8));
+}
+
+TEST_CASE(renderHourCsv) {
+    CapturePrint out;
+    RGBWWLedCsvSink sink(out);
+    const uint32_t frames = renderHour(sink);
+
+    CHECK_EQUAL(uint32_t(3600000 / RGBWW_MINTIMEDIFF), frames);
+    // header and one line per frame
+    CHECK_EQUAL(frames + 1, out.lines);
+    CHECK(out.head.compare(0, 5, "time,") == 0);
+}
+
+// the renderer calculates the same frames as show(now) of a controller driving the PWM output
+TEST_CASE(renderMatchesShow) {
+    RGBWWLed preview;
+    setupFades(preview);
+    RGBWWLedRenderer renderer(preview);
+    FrameSink sink;
+    CHECK_EQUAL(uint32_t(500), renderer.render(sink, 10000));
+
+    RGBWWLed led;
+    led.init(13, 12, 14, 5, 4);
+    setupFades(led);
+    int mismatches = 0;
+    for (const RenderFrame& frame : sink.frames) {
+        led.show(frame.time);
+        if (!(frame.color == led.getCurrentColor()) || !(frame.output == led.getCurrentOutput()))
+            ++mismatches;
+    }
+    CHECK_EQUAL(0, mismatches);
+    CHECK(!(sink.frames.front().output == sink.frames.back().output));
+}
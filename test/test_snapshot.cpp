@@ -0,0 +1,276 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include <FileSystem.h>
+#include <RGBWWLed.h>
+#include <RGBWWLedScene.h>
+#include <RGBWWLedSnapshot.h>
+#include <RGBWWLedTimeline.h>
+#include "test.h"
+// clang-format on
+
+namespace {
+
+const char* const snapshotFile = "snapshot_test.bin";
+const size_t bufferSize = 4096;
+
+RequestHSVCT hsvRequest(int h, int s, const char* v) {
+    RequestHSVCT request;
+    request.h = AbsOrRelValue(h, AbsOrRelValue::Type::Hue);
+    request.s = AbsOrRelValue(s);
+    request.v = AbsOrRelValue(String(v));
+    return request;
+}
+
+RequestChannelOutput rawRequest(int r, int g, int b, int cw, int ww) {
+    RequestChannelOutput request;
+    request.r = AbsOrRelValue(r, AbsOrRelValue::Type::Raw);
+    request.g = AbsOrRelValue(g, AbsOrRelValue::Type::Raw);
+    request.b = AbsOrRelValue(b, AbsOrRelValue::Type::Raw);
+    request.cw = AbsOrRelValue(cw, AbsOrRelValue::Type::Raw);
+    request.ww = AbsOrRelValue(ww, AbsOrRelValue::Type::Raw);
+    return request;
+}
+
+// fades, an eased and a requeued fade and a blink in the middle of a fade
+void setupHsv(RGBWWLed& led) {
+    led.fadeHSV(hsvRequest(300, 80, "70"), RampTimeOrSpeed(3000), 200,
+                HueTransitionDirection::dir_long, QueuePolicy::Single, false, "one");
+    led.fadeHSV(hsvRequest(20, 100, "+10"), RampTimeOrSpeed(900, Easing::InOut), 0,
+                QueuePolicy::Back, true, "two");
+    for (int i = 0; i < 77; ++i)
+        led.show();
+    RGBWWLed::ChannelList channels;
+    channels.add(CtrlChannel::Sat);
+    led.blink(channels, 400);
+    for (int i = 0; i < 3; ++i)
+        led.show();
+}
+
+// joint animations: a scene with loop and blink, a timeline and a joint fade
+void setupRaw(RGBWWLed& led) {
+    static RGBWWLedScene scene;
+    if (scene.getSize() == 0)
+        scene.compile("a: fade r=1023 ww=+100 time=500 ease=sine\nblink 100\nfade r=0 g=500 time=300\nloop a 2\n"
+                      "stay 100");
+    led.fadeRAW(rawRequest(100, 200, 300, 400, 500), RampTimeOrSpeed(100), 0);
+    led.playScene(scene, QueuePolicy::Back, true, "scene");
+
+    AnimTimeline* timeline = new AnimTimeline(&led, RGBWWLed::ColorMode::Raw, 2, false, "timeline");
+    timeline->addKeyframe(rawRequest(1, 2, 3, 4, 5), RampTimeOrSpeed(400), 100);
+    timeline->addKeyframe(rawRequest(900, 0, 3, 4, 5), RampTimeOrSpeed(600, Easing::Out), 0);
+    led.pushJointAnimation(timeline, QueuePolicy::Back);
+    led.fadeRAWJoint(rawRequest(50, 60, 70, 80, 90), RampTimeOrSpeed(500), 0, QueuePolicy::Back);
+    for (int i = 0; i < 90; ++i)
+        led.show();
+}
+
+// requests from HSVCT values: hue and ct are channel values without their type
+void setupHsvctValues(RGBWWLed& led) {
+    for (int i = 0; i < 3; ++i) {
+        const HSVCT color((i + 7) * RGBWW_CALC_HUEWHEELMAX / 10, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL, 2700 + i * 300);
+        led.fadeHSV(RequestHSVCT(color), RampTimeOrSpeed(1000), 0, HueTransitionDirection::dir_short,
+                    QueuePolicy::Back);
+    }
+    AnimTimeline* timeline = new AnimTimeline(&led, RGBWWLed::ColorMode::Hsv, 2);
+    timeline->addKeyframe(RequestHSVCT(HSVCT(5000, 500, 800, 4000)), RampTimeOrSpeed(400));
+    timeline->addKeyframe(RequestHSVCT(HSVCT(100, 900, 200, 6000)), RampTimeOrSpeed(400));
+    led.pushJointAnimation(timeline, QueuePolicy::Back);
+    led.fadeHSVJoint(RequestHSVCT(HSVCT(4500, 1000, 1000, 3500)), RampTimeOrSpeed(500), 0,
+                     HueTransitionDirection::dir_long, QueuePolicy::Back);
+    for (int i = 0; i < 30; ++i)
+        led.show();
+}
+
+bool sameOutput(RGBWWLed& a, RGBWWLed& b) {
+    return a.getCurrentOutput() == b.getCurrentOutput() && a.getCurrentColor() == b.getCurrentColor();
+}
+
+bool isInRange(RGBWWLed& led) {
+    const ChannelOutput& o = led.getCurrentOutput();
+    const HSVCT& c = led.getCurrentColor();
+    const int values[] = {o.r, o.g, o.b, o.ww, o.cw, c.s, c.v};
+    for (int value : values) {
+        if (value < 0 || value > RGBWW_CALC_MAXVAL)
+            return false;
+    }
+    return c.h >= 0 && c.h < RGBWW_CALC_HUEWHEELMAX;
+}
+
+// header of a snapshot for a changed payload
+void seal(uint8_t* snapshot, size_t size) {
+    RGBWWLedSnapshotWriter header(snapshot, RGBWWLedSnapshot::HeaderSize);
+    header.putBytes("RGBS", 4);
+    header.putByte(RGBWWLedSnapshot::Version);
+    header.putUint32(size - RGBWWLedSnapshot::HeaderSize);
+    header.putUint32(RGBWWLedSnapshot::checksum(snapshot + RGBWWLedSnapshot::HeaderSize,
+                                                size - RGBWWLedSnapshot::HeaderSize));
+}
+
+// saves the snapshot to a file and restores it from there, both continue the same way
+void checkRoundTrip(void (*setupFunc)(RGBWWLed& led), int frames) {
+    RGBWWLed led;
+    RGBWWLed restored;
+    led.init(13, 12, 14, 5, 4);
+    restored.init(13, 12, 14, 5, 4);
+    setupFunc(led);
+
+    uint8_t buffer[bufferSize];
+    const size_t size = led.saveSnapshot(buffer, sizeof(buffer));
+    REQUIRE(size > 0);
+    CHECK_EQUAL(led.getSnapshotSize(), size);
+    CHECK_EQUAL(size_t(0), led.saveSnapshot(buffer, size - 1));
+
+    file_t file = fileOpen(snapshotFile, eFO_WriteOnly | eFO_CreateIfNotExist | eFO_Truncate);
+    REQUIRE(file >= 0);
+    CHECK_EQUAL(int(size), fileWrite(file, buffer, size));
+    fileClose(file);
+
+    uint8_t read[bufferSize];
+    file = fileOpen(snapshotFile, eFO_ReadOnly);
+    REQUIRE(file >= 0);
+    const int readSize = fileRead(file, read, sizeof(read));
+    fileClose(file);
+    fileDelete(snapshotFile);
+    REQUIRE(readSize == int(size));
+
+    // a changed byte fails the checksum
+    read[RGBWWLedSnapshot::HeaderSize + 3] ^= 1;
+    CHECK(!restored.restoreSnapshot(read, size));
+    read[RGBWWLedSnapshot::HeaderSize + 3] ^= 1;
+    REQUIRE(restored.restoreSnapshot(read, size));
+
+    int mismatches = 0;
+    for (int i = 0; i < frames; ++i) {
+        led.show();
+        restored.show();
+        if (!sameOutput(led, restored))
+            ++mismatches;
+    }
+    CHECK_EQUAL(0, mismatches);
+}
+
+} // namespace
+
+TEST_CASE(snapshotRoundTripHsv) {
+    checkRoundTrip(setupHsv, 600);
+}
+
+TEST_CASE(snapshotRoundTripRaw) {
+    checkRoundTrip(setupRaw, 800);
+}
+
+TEST_CASE(snapshotRoundTripHsvctValues) {
+    checkRoundTrip(setupHsvctValues, 400);
+}
+
+TEST_CASE(snapshotRejectsInvalidHeader) {
+    RGBWWLed led;
+    led.init(13, 12, 14, 5, 4);
+    CHECK(!led.restoreSnapshot(nullptr, 0));
+    CHECK(!led.restoreSnapshot(reinterpret_cast<const uint8_t*>("RGBS"), 4));
+}
+
+// a snapshot with a valid checksum and a channel value out of range
+TEST_CASE(snapshotRejectsChannelOutOfRange) {
+    RGBWWLed led;
+    led.init(13, 12, 14, 5, 4);
+    led.colorDirectHSV(hsvRequest(100, 50, "50"));
+    led.show();
+
+    uint8_t buffer[bufferSize];
+    const size_t size = led.saveSnapshot(buffer, sizeof(buffer));
+    REQUIRE(size > 0);
+
+    // replace the hue behind the color mode by -1
+    RGBWWLedSnapshotReader reader(buffer + RGBWWLedSnapshot::HeaderSize, size - RGBWWLedSnapshot::HeaderSize);
+    const int mode = reader.getInt();
+    reader.getInt();
+    const size_t rest = reader.getRemaining();
+
+    uint8_t changed[bufferSize];
+    RGBWWLedSnapshotWriter payload(changed + RGBWWLedSnapshot::HeaderSize,
+                                   sizeof(changed) - RGBWWLedSnapshot::HeaderSize);
+    payload.putInt(mode);
+    payload.putInt(-1);
+    payload.putBytes(buffer + size - rest, rest);
+    const size_t changedSize = RGBWWLedSnapshot::HeaderSize + payload.getSize();
+    seal(changed, changedSize);
+
+    CHECK(!led.restoreSnapshot(changed, changedSize));
+    CHECK(led.restoreSnapshot(buffer, size));
+}
+
+// every changed byte with a valid checksum is either rejected or gives a state which
+// keeps the output in range. Run with SANITIZE=1 to catch out of bounds accesses
+TEST_CASE(snapshotCorruptionKeepsOutputInRange) {
+    void (*const setups[])(RGBWWLed & led) = {setupHsv, setupRaw, setupHsvctValues};
+    const uint8_t patterns[] = {0x01, 0x02, 0x10, 0x40, 0x7f, 0x80, 0xff};
+
+    const int used = RGBWWLed::getAnimationPoolStats().used;
+    for (auto setupFunc : setups) {
+        RGBWWLed led;
+        led.init(13, 12, 14, 5, 4);
+        setupFunc(led);
+        uint8_t buffer[bufferSize];
+        const size_t size = led.saveSnapshot(buffer, sizeof(buffer));
+        REQUIRE(size > 0);
+
+        RGBWWLed restored;
+        restored.init(13, 12, 14, 5, 4);
+        int accepted = 0;
+        int outOfRange = 0;
+        for (size_t pos = RGBWWLedSnapshot::HeaderSize; pos < size; ++pos) {
+            for (uint8_t pattern : patterns) {
+                uint8_t changed[bufferSize];
+                memcpy(changed, buffer, size);
+                changed[pos] ^= pattern;
+                seal(changed, size);
+                if (!restored.restoreSnapshot(changed, size))
+                    continue;
+
+                ++accepted;
+                for (int frame = 0; frame < 50; ++frame) {
+                    restored.show();
+                    if (!isInRange(restored))
+                        ++outOfRange;
+                }
+            }
+        }
+        CHECK(accepted > 0);
+        CHECK_EQUAL(0, outOfRange);
+    }
+    CHECK_EQUAL(used, RGBWWLed::getAnimationPoolStats().used);
+}
+
+TEST_CASE(sceneVerify) {
+    RGBWWLedScene scene;
+    REQUIRE(scene.compile("a: fade h=120 s=100 time=500\nb: stay 100\nloop a 2\njump b"));
+    const int size = scene.getSize();
+    int32_t code[64];
+    REQUIRE(size <= 64);
+    memcpy(code, scene.getCode(), size * sizeof(int32_t));
+    CHECK(RGBWWLedScene::verify(code, size, scene.getCounters(), RGBWWLed::ColorMode::Hsv));
+    CHECK(!RGBWWLedScene::verify(code, size, 0, RGBWWLed::ColorMode::Hsv));
+    CHECK(!RGBWWLedScene::verify(code, size - 1, scene.getCounters(), RGBWWLed::ColorMode::Hsv));
+    CHECK(RGBWWLedScene::isInstruction(code, size, 0));
+    CHECK(!RGBWWLedScene::isInstruction(code, size, 1));
+
+    // fade (5 words), stay (2 words), loop (3 words), jump: target into the middle of the fade
+    CHECK_EQUAL(int(RGBWWLedScene::Op::Jump), int(RGBWWLedScene::getOp(code[10])));
+    code[11] = 1;
+    CHECK(!RGBWWLedScene::verify(code, size, scene.getCounters(), RGBWWLed::ColorMode::Hsv));
+    code[11] = size;
+    CHECK(!RGBWWLedScene::verify(code, size, scene.getCounters(), RGBWWLed::ColorMode::Hsv));
+    code[11] = 5;
+    CHECK(RGBWWLedScene::verify(code, size, scene.getCounters(), RGBWWLed::ColorMode::Hsv));
+
+    // absolute saturation out of range
+    code[4] = RGBWW_CALC_MAXVAL + 1;
+    CHECK(!RGBWWLedScene::verify(code, size, scene.getCounters(), RGBWWLed::ColorMode::Hsv));
+}
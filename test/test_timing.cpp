@@ -0,0 +1,235 @@
+/**
+ * RGBWWLed - simple Library for controlling RGB WarmWhite ColdWhite strips
+ * @file
+ * @author  Patrick Jahns http://github.com/patrickjahns
+ *
+ * All files of this project are provided under the LGPL v3 license.
+ */
+// clang-format off
+#include <RGBWWLed.h>
+#include "test.h"
+// clang-format on
+
+namespace {
+
+// simulated clock of the time based mode
+uint32_t simClock = 0;
+
+uint32_t getSimClock() {
+    return simClock;
+}
+
+struct Random {
+    uint32_t state;
+
+    Random(uint32_t seed) : state(seed) {}
+
+    uint32_t next() {
+        state = state * 1103515245 + 12345;
+        return state;
+    }
+};
+
+// a 2 s fade with frame intervals between 5 and 100 ms, returns the simulated time it finished after
+uint32_t runJitteredFade(bool timeBased, int rampTime, int& frames) {
+    RGBWWLed led;
+    led.init(13, 12, 14, 5, 4);
+    led.colorDirectHSV(RequestHSVCT(HSVCT(0, RGBWW_CALC_MAXVAL, 0)));
+    led.show();
+    simClock = 1000;
+    led.setTimeBased(timeBased, getSimClock);
+    led.fadeHSV(RequestHSVCT(HSVCT(0, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL)), RampTimeOrSpeed(rampTime), 0,
+                HueTransitionDirection::dir_short, QueuePolicy::Single);
+
+    Random random(12345);
+    const uint32_t start = simClock;
+    uint32_t finished = 0;
+    // the first frame starts the fade at start
+    for (frames = 0; finished == 0 && frames < 10000; ++frames) {
+        if (led.show().animFinished)
+            finished = simClock - start;
+        simClock += 5 + (random.next() >> 16) % 96;
+    }
+    return finished;
+}
+
+class OverrunCounter : public RGBWWLed {
+  public:
+    int overruns = 0;
+    uint32_t maxLateInterval = 0;
+
+    virtual void onFrameOverrun(uint32_t now, uint32_t interval, uint32_t deadline) override {
+        ++overruns;
+        maxLateInterval = max(maxLateInterval, interval);
+    }
+};
+
+// one minute of a 50 Hz timer with +-2 ms jitter and a stall of 50 to 300 ms every 5 s
+void runFrameMonitor(OverrunCounter& led, bool timeBased, int& stalls) {
+    led.init(13, 12, 14, 5, 4);
+    simClock = 0;
+    led.setTimeBased(timeBased, getSimClock);
+    led.setFrameMonitoring(true);
+    for (int i = 0; i < 10; ++i) {
+        HSVCT c((i * RGBWW_CALC_HUEWHEELMAX) / 10, RGBWW_CALC_MAXVAL, RGBWW_CALC_MAXVAL, 2700);
+        led.fadeHSV(RequestHSVCT(c), RampTimeOrSpeed(4000), 0, HueTransitionDirection::dir_short, QueuePolicy::Back,
+                    true);
+    }
+
+    Random random(4711);
+    uint32_t nextStall = 5000;
+    stalls = 0;
+    while (simClock < 60000) {
+        led.show();
+        const uint32_t r = random.next();
+        simClock += RGBWW_MINTIMEDIFF - 2 + (r >> 16) % 5;
+        if (simClock >= nextStall) {
+            simClock += 50 + (r >> 8) % 251;
+            nextStall += 5000;
+            // the frame after the stall is late
+            if (simClock < 60000)
+                ++stalls;
+        }
+    }
+}
+
+void checkFrameMonitor(bool timeBased) {
+    OverrunCounter led;
+    int stalls;
+    runFrameMonitor(led, timeBased, stalls);
+    const RGBWWLed::FrameStats& stats = led.getFrameStats();
+
+    // only the frames after a stall are late, the jitter stays within RGBWW_FRAMELATETOLERANCE
+    CHECK_EQUAL(11, stalls);
+    CHECK_EQUAL(uint32_t(stalls), stats.late);
+    CHECK_EQUAL(stalls, led.overruns);
+    CHECK(stats.dropped >= uint32_t(stalls * 2));
+    CHECK(stats.dropped <= uint32_t(stalls * 16));
+    CHECK(stats.minInterval >= uint32_t(RGBWW_MINTIMEDIFF - 2));
+    CHECK(stats.maxInterval >= uint32_t(RGBWW_MINTIMEDIFF + 50));
+    CHECK(stats.maxInterval <= uint32_t(RGBWW_MINTIMEDIFF + 2 + 300));
+    CHECK_EQUAL(stats.maxInterval, led.maxLateInterval);
+    CHECK(stats.frames > 2800);
+
+    uint32_t bucketed = 0;
+    for (int i = 0; i < RGBWWLed::JitterBuckets; ++i)
+        bucketed += stats.jitter[i];
+    CHECK_EQUAL(stats.frames, bucketed);
+}
+
+// Typical day of a fixture: sunrise, a few quick scenes, a slow evening fade
+const uint32_t dayEventTimes[] = {6 * 3600,  7 * 3600,        7 * 3600 + 1800, 18 * 3600,
+                                  18 * 3600 + 300, 20 * 3600, 21 * 3600,       23 * 3600};
+const int dayEvents = sizeof(dayEventTimes) / sizeof(dayEventTimes[0]);
+const uint32_t dayEnd = 24 * 3600 * 1000UL;
+
+void queueDayEvent(RGBWWLed& led, int event) {
+    const HueTransitionDirection dir = HueTransitionDirection::dir_short;
+    switch (event) {
+    case 0:
+        led.fadeHSV(RequestHSVCT(HSVCT(0, 0, RGBWW_CALC_MAXVAL, 2700)), RampTimeOrSpeed(30 * 60000), 0, dir,
+                    QueuePolicy::Single);
+        break;
+    case 1:
+        led.fadeHSV(RequestHSVCT(HSVCT(0, 0, RGBWW_CALC_MAXVAL, 5000)), RampTimeOrSpeed(5000), 0, dir,
+                    QueuePolicy::Single);
+        break;
+    case 2:
+    case 7:
+        led.fadeHSV(RequestHSVCT(HSVCT(0, 0, 0, 5000)), RampTimeOrSpeed(event == 2 ? 10000 : 20 * 60000), 0, dir,
+                    QueuePolicy::Single);
+        break;
+    case 3:
+        led.fadeHSV(RequestHSVCT(HSVCT(200, 800, RGBWW_CALC_MAXVAL, 4000)), RampTimeOrSpeed(2000), 0, dir,
+                    QueuePolicy::Single);
+        break;
+    case 4:
+        for (int i = 1; i <= 5; ++i) {
+            HSVCT c((i * RGBWW_CALC_HUEWHEELMAX) / 6, 800, RGBWW_CALC_MAXVAL, 4000);
+            led.fadeHSV(RequestHSVCT(c), RampTimeOrSpeed(1000), 0, dir, QueuePolicy::Back);
+        }
+        break;
+    case 5:
+        led.fadeHSV(RequestHSVCT(HSVCT(200, 300, 700, 2700)), RampTimeOrSpeed(2 * 3600000), 0, dir,
+                    QueuePolicy::Single);
+        break;
+    case 6:
+        led.blink(RGBWWLed::ChannelList(), 500, QueuePolicy::Front, false);
+        break;
+    }
+}
+
+/**
+ * Runs the day with fixed 50 Hz frames or adaptive frames (time based, next frame after
+ * FrameResult::nextFrame ms, none while idle). Stores the output just before every event
+ * and at the end of the day, returns the number of frames
+ */
+uint32_t runDay(bool adaptive, ChannelOutput (&outputs)[dayEvents + 1]) {
+    RGBWWLed led;
+    led.init(13, 12, 14, 5, 4);
+    led.colorDirectHSV(RequestHSVCT(HSVCT(0, 0, 0, 2700)));
+    led.show();
+    simClock = 0;
+    led.setTimeBased(adaptive, getSimClock);
+
+    int event = 0;
+    uint32_t frames = 0;
+    while (simClock < dayEnd) {
+        if (event < dayEvents && simClock >= dayEventTimes[event] * 1000) {
+            outputs[event] = led.getCurrentOutput();
+            queueDayEvent(led, event++);
+        }
+
+        const RGBWWLed::FrameResult result = led.show();
+        ++frames;
+
+        uint32_t next = simClock + (adaptive ? result.nextFrame : RGBWW_MINTIMEDIFF);
+        if (adaptive && result.nextFrame == 0) {
+            // idle until the next event
+            next = (event < dayEvents) ? dayEventTimes[event] * 1000 : dayEnd;
+        } else if (event < dayEvents) {
+            next = min(next, dayEventTimes[event] * 1000);
+        }
+        simClock = next;
+    }
+    outputs[dayEvents] = led.getCurrentOutput();
+    return frames;
+}
+
+} // namespace
+
+// frame based a fade takes its steps in frames no matter how late they come,
+// time based it finishes at its nominal time
+TEST_CASE(jitteredFadeFinishesOnTime) {
+    const int rampTime = 2000;
+    int frames;
+    const uint32_t finished = runJitteredFade(true, rampTime, frames);
+    CHECK(finished >= uint32_t(rampTime - RGBWW_STEPTIME));
+    CHECK(finished < uint32_t(rampTime + 100));
+
+    const uint32_t finishedFrameBased = runJitteredFade(false, rampTime, frames);
+    CHECK_EQUAL(rampTime / RGBWW_MINTIMEDIFF, frames);
+    CHECK(finishedFrameBased > uint32_t(2 * rampTime));
+}
+
+TEST_CASE(frameMonitorCountsStalls) {
+    checkFrameMonitor(false);
+}
+
+TEST_CASE(frameMonitorCountsStallsTimeBased) {
+    checkFrameMonitor(true);
+}
+
+// adaptive frames skip the idle hours and the frames without a step of the slow fades,
+// but show the same colors
+TEST_CASE(adaptiveFramesDayProfile) {
+    ChannelOutput fixed[dayEvents + 1];
+    ChannelOutput adaptive[dayEvents + 1];
+    const uint32_t fixedFrames = runDay(false, fixed);
+    const uint32_t adaptiveFrames = runDay(true, adaptive);
+
+    CHECK_EQUAL(dayEnd / RGBWW_MINTIMEDIFF, fixedFrames);
+    CHECK(adaptiveFrames < fixedFrames / 100);
+    for (int i = 0; i <= dayEvents; ++i)
+        CHECK(fixed[i] == adaptive[i]);
+}